@@ -0,0 +1,481 @@
+/********************************
+ * Project: Cidr				*
+ * File: bench.cpp				*
+ * Date: 17.10.2026				*
+ ********************************/
+
+// NOTE: Headless micro benchmarks of every Renderer entry point, no window is needed.
+// Every benchmark renders a fixed, seeded set of primitives into a plain uint32_t buffer
+// and is repeated until it ran for at least --min-time seconds. The results are printed as JSON.
+//
+// usage: cidr_bench [--filter <text>] [--min-time <seconds>] [--sizes <w>x<h>,<w>x<h>...]
+
+#include "renderer.hpp"
+#include "formatRenderer.hpp"
+#include "bitmapPool.hpp"
+#include "commandList.hpp"
+#include "filter.hpp"
+#include "timer.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+	std::string filter;
+	double minTime {0.25};
+	std::vector<std::pair<int, int>> sizes {{256, 256}, {1280, 720}, {1920, 1080}};
+};
+
+struct Result {
+	std::string name;
+	int width;
+	int height;
+	long long iterations;
+	double nsPerIteration;
+	int primitivesPerIteration;
+};
+
+// NOTE: small deterministic generator so every run (and every version of the library) draws the same primitives
+class Random {
+public:
+	explicit Random(uint32_t seed) : state{seed} {}
+	uint32_t Next() {
+		state = state * 1664525u + 1013904223u;
+		return state >> 8;
+	}
+	int Range(int min, int max) {
+		return min + static_cast<int>(Next() % static_cast<uint32_t>(max - min + 1));
+	}
+private:
+	uint32_t state;
+};
+
+struct Scene {
+	int width;
+	int height;
+	std::vector<cdr::Rectangle> rectangles;
+	std::vector<cdr::Point> points;
+	std::vector<int> radii;
+	std::vector<cdr::RGBA> colors;
+};
+
+constexpr int primitiveCount {64};
+
+Scene makeScene(int width, int height) {
+	Scene scene {width, height, {}, {}, {}, {}};
+	Random random {12345};
+	int maxSize {std::max(8, std::min(width, height) / 4)};
+	for (int i = 0; i < primitiveCount; i++) {
+		int w {random.Range(4, maxSize)};
+		int h {random.Range(4, maxSize)};
+		scene.rectangles.push_back(cdr::Rectangle{random.Range(-w / 2, width - w / 2), random.Range(-h / 2, height - h / 2), w, h});
+		scene.radii.push_back(random.Range(2, maxSize / 2));
+		scene.colors.push_back(cdr::RGBA{uint8_t(random.Range(0, 255)), uint8_t(random.Range(0, 255)), uint8_t(random.Range(0, 255)), uint8_t(random.Range(32, 224))});
+	}
+	for (int i = 0; i < primitiveCount * 3; i++) {
+		scene.points.push_back(cdr::Point{random.Range(-16, width + 16), random.Range(-16, height + 16)});
+	}
+	return scene;
+}
+
+cdr::RGBA gradientShader(const cdr::Renderer& renderer, int x, int y) {
+	return cdr::RGBA{uint8_t(x * 255 / renderer.GetWidth()), uint8_t(y * 255 / renderer.GetHeight()), 128, 255};
+}
+
+cdr::Bitmap makeTexture(int size) {
+	cdr::Bitmap texture {size, size};
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			texture.SetRawPixel(uint8_t(x * 255 / size), uint8_t(y * 255 / size), ((x / 8 + y / 8) & 1) ? 255 : 0, 255, x, y);
+		}
+	}
+	return texture;
+}
+// same as makeTexture with an alpha that fades out to the right
+cdr::Bitmap makeSprite(int size) {
+	cdr::Bitmap sprite {makeTexture(size)};
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			sprite.SetRawPixel((sprite.GetRawPixel(x, y) & 0xffffff00) | uint32_t(255 - x * 255 / size), x, y);
+		}
+	}
+	return sprite;
+}
+
+double run(const Options& options, const std::function<void()>& body, long long& iterations) {
+	// NOTE: one untimed run to warm up caches and lazily created state (glyph cache, arenas...)
+	body();
+	iterations = 0;
+	Timer timer;
+	long long batch {1};
+	while (true) {
+		for (long long i = 0; i < batch; i++) {
+			body();
+		}
+		iterations += batch;
+		double elapsed {timer.elapsedSeconds()};
+		if (elapsed >= options.minTime) {
+			return elapsed * 1e9 / iterations;
+		}
+		batch *= 2;
+	}
+}
+
+std::string escape(const std::string& text) {
+	std::string result;
+	for (char c : text) {
+		if (c == '"' || c == '\\') result += '\\';
+		result += c;
+	}
+	return result;
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+	for (int i = 1; i < argc; i++) {
+		std::string argument {argv[i]};
+		bool hasValue {i + 1 < argc};
+		if (argument == "--filter" && hasValue) {
+			options.filter = argv[++i];
+		} else if (argument == "--min-time" && hasValue) {
+			options.minTime = std::atof(argv[++i]);
+		} else if (argument == "--sizes" && hasValue) {
+			options.sizes.clear();
+			std::string sizes {argv[++i]};
+			size_t start {0};
+			while (start < sizes.size()) {
+				size_t end {sizes.find(',', start)};
+				if (end == std::string::npos) end = sizes.size();
+				int width {0};
+				int height {0};
+				if (std::sscanf(sizes.substr(start, end - start).c_str(), "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0) {
+					std::fprintf(stderr, "cidr_bench: invalid size '%s'\n", sizes.substr(start, end - start).c_str());
+					return false;
+				}
+				options.sizes.emplace_back(width, height);
+				start = end + 1;
+			}
+		} else {
+			std::fprintf(stderr, "usage: cidr_bench [--filter <text>] [--min-time <seconds>] [--sizes <w>x<h>,...]\n");
+			return false;
+		}
+	}
+	return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+	Options options;
+	if (!parseOptions(argc, argv, options)) return 1;
+
+	cdr::Bitmap texture {makeTexture(256)};
+	texture.GenerateMipmaps();
+	const cdr::Bitmap sprite {makeSprite(256)};
+	cdr::Bitmap premultipliedSprite {sprite};
+	premultipliedSprite.Premultiply();
+	const cdr::MaskBitmap spriteMask {sprite};
+	const cdr::MonochromeBitmap greyTexture {texture};
+	cdr::BitmapPool bitmapPool;
+	std::vector<Result> results;
+
+	for (auto [width, height] : options.sizes) {
+		std::vector<uint32_t> pixels(width * height);
+		cdr::Renderer renderer {pixels.data(), width, height};
+		const Scene scene {makeScene(width, height)};
+
+		auto bench = [&](const std::string& name, int primitives, const std::function<void()>& body) {
+			if (!options.filter.empty() && name.find(options.filter) == std::string::npos) return;
+			// NOTE: every benchmark starts with the same canvas and default settings
+			renderer.Clear(cdr::RGBA{20, 30, 40, 255});
+			renderer.DisableAlphaBlending();
+			renderer.DisableLinearLight();
+			renderer.DisablePremultipliedAlpha();
+			renderer.ScaleType = cdr::Renderer::ScaleType::Nearest;
+			renderer.OutOfBoundsType = cdr::Renderer::OutOfBoundsType::ClampToEdge;
+			long long iterations {0};
+			double ns {run(options, body, iterations)};
+			results.push_back(Result{name, width, height, iterations, ns, primitives});
+		};
+		auto opaque = [&](int i) {
+			cdr::RGBA color {scene.colors[i]};
+			color.a = 255;
+			return color;
+		};
+		auto point = [&](int i) { return scene.points[i % scene.points.size()]; };
+		auto centre = [&](int i) { return cdr::Point{scene.rectangles[i].x + scene.rectangles[i].width / 2, scene.rectangles[i].y + scene.rectangles[i].height / 2}; };
+
+		bench("Clear", 1, [&] { renderer.Clear(cdr::RGBA{20, 30, 40, 255}); });
+
+		// NOTE: single pixels spread over the whole canvas
+		constexpr int pixelCount {4096};
+		bench("DrawPixel/plain", pixelCount, [&] {
+			for (int i = 0; i < pixelCount; i++) renderer.DrawPixel(scene.colors[i % primitiveCount], (i * 7919) % width, (i * 104729) % height);
+		});
+		bench("DrawPixel/blended", pixelCount, [&] {
+			renderer.EnableAlphaBlending();
+			for (int i = 0; i < pixelCount; i++) renderer.DrawPixel(scene.colors[i % primitiveCount], (i * 7919) % width, (i * 104729) % height);
+		});
+
+		bench("FillRectangle/solid", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) renderer.FillRectangle(opaque(i), scene.rectangles[i]);
+		});
+		bench("FillRectangle/blended", primitiveCount, [&] {
+			renderer.EnableAlphaBlending();
+			for (int i = 0; i < primitiveCount; i++) renderer.FillRectangle(scene.colors[i], scene.rectangles[i]);
+		});
+		bench("FillRectangle/blendedLinear", primitiveCount, [&] {
+			renderer.EnableAlphaBlending();
+			renderer.EnableLinearLight();
+			for (int i = 0; i < primitiveCount; i++) renderer.FillRectangle(scene.colors[i], scene.rectangles[i]);
+		});
+		bench("FillRectangle/blendedPremultiplied", primitiveCount, [&] {
+			renderer.EnableAlphaBlending();
+			renderer.EnablePremultipliedAlpha();
+			for (int i = 0; i < primitiveCount; i++) renderer.FillRectangle(scene.colors[i], scene.rectangles[i]);
+		});
+		bench("FillRectangle/shader", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) renderer.FillRectangle(&gradientShader, scene.rectangles[i]);
+		});
+		bench("FillRectangle/spanShader", primitiveCount, [&] {
+			auto shader = [](const cdr::Renderer&, int x0, int x1, int y, uint32_t* out) {
+				for (int x = x0; x < x1; x++) *out++ = cdr::RGBtoUINT(cdr::RGBA{uint8_t(x), uint8_t(y), 128, 255});
+			};
+			for (int i = 0; i < primitiveCount; i++) renderer.FillRectangle(shader, scene.rectangles[i]);
+		});
+		bench("DrawRectangle", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) renderer.DrawRectangle(opaque(i), scene.rectangles[i]);
+		});
+
+		// NOTE: drawing straight into other pixel formats, ConvertToABGR8888 is the conversion pass it saves
+		cdr::FormatBitmap<cdr::ABGR8888> abgrCanvas {width, height};
+		cdr::FormatRenderer<cdr::ABGR8888> abgrRenderer {abgrCanvas};
+		cdr::FormatBitmap<cdr::RGB565> rgb565Canvas {width, height};
+		cdr::FormatRenderer<cdr::RGB565> rgb565Renderer {rgb565Canvas};
+		cdr::FormatBitmap<cdr::A8> maskCanvas {width, height};
+		cdr::FormatRenderer<cdr::A8> maskRenderer {maskCanvas};
+		bench("ConvertToABGR8888", 1, [&] {
+			cdr::ConvertPixels<cdr::RGBA8888, cdr::ABGR8888>(pixels.data(), abgrCanvas.GetData(), width * height);
+		});
+		bench("FillRectangle/ABGR8888", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) abgrRenderer.FillRectangle(opaque(i), scene.rectangles[i]);
+		});
+		bench("FillRectangle/blendedABGR8888", primitiveCount, [&] {
+			abgrRenderer.EnableAlphaBlending();
+			for (int i = 0; i < primitiveCount; i++) abgrRenderer.FillRectangle(scene.colors[i], scene.rectangles[i]);
+		});
+		bench("FillRectangle/RGB565", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) rgb565Renderer.FillRectangle(opaque(i), scene.rectangles[i]);
+		});
+		bench("FillRectangle/blendedRGB565", primitiveCount, [&] {
+			rgb565Renderer.EnableAlphaBlending();
+			for (int i = 0; i < primitiveCount; i++) rgb565Renderer.FillRectangle(scene.colors[i], scene.rectangles[i]);
+		});
+		bench("FillRectangle/blendedA8", primitiveCount, [&] {
+			maskRenderer.EnableAlphaBlending();
+			for (int i = 0; i < primitiveCount; i++) maskRenderer.FillRectangle(scene.colors[i], scene.rectangles[i]);
+		});
+		bench("FillTriangle/RGB565", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) rgb565Renderer.FillTriangle(opaque(i), point(3 * i), point(3 * i + 1), point(3 * i + 2));
+		});
+
+		bench("DrawLine/plain", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) renderer.DrawLine(opaque(i), point(2 * i), point(2 * i + 1));
+		});
+		bench("DrawLine/AA", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) renderer.DrawLine(opaque(i), point(2 * i), point(2 * i + 1), true);
+		});
+		bench("DrawLine/AA+GC", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) renderer.DrawLine(opaque(i), point(2 * i), point(2 * i + 1), true, true);
+		});
+
+		bench("DrawLine/AA+linear", primitiveCount, [&] {
+			renderer.EnableLinearLight();
+			for (int i = 0; i < primitiveCount; i++) renderer.DrawLine(opaque(i), point(2 * i), point(2 * i + 1), true);
+		});
+
+		bench("DrawCircle/plain", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) renderer.DrawCircle(opaque(i), centre(i), scene.radii[i]);
+		});
+		bench("DrawCircle/AA", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) renderer.DrawCircle(opaque(i), centre(i), scene.radii[i], true);
+		});
+		bench("FillCircle/plain", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) renderer.FillCircle(opaque(i), centre(i), scene.radii[i]);
+		});
+		bench("FillCircle/AA", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) renderer.FillCircle(opaque(i), centre(i), scene.radii[i], true);
+		});
+		bench("FillCircle/shader", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) renderer.FillCircle(&gradientShader, centre(i), scene.radii[i]);
+		});
+		// NOTE: map overlays draw lots of small anti aliased markers, the fixed cost per circle matters more than the rows
+		bench("FillCircle/markersAA", primitiveCount * 16, [&] {
+			for (int i = 0; i < primitiveCount * 16; i++) renderer.FillCircle(scene.colors[i % primitiveCount], point(i), 2 + i % 5, true);
+		});
+		bench("FillEllipse/plain", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) renderer.FillEllipse(opaque(i), centre(i), scene.rectangles[i].width / 2, scene.rectangles[i].height / 2);
+		});
+		bench("FillEllipse/AA", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) renderer.FillEllipse(opaque(i), centre(i), scene.rectangles[i].width / 2, scene.rectangles[i].height / 2, true);
+		});
+		bench("DrawEllipse/AA", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) renderer.DrawEllipse(opaque(i), centre(i), scene.rectangles[i].width / 2, scene.rectangles[i].height / 2, true);
+		});
+
+		bench("FillTriangle/solid", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) renderer.FillTriangle(opaque(i), point(3 * i), point(3 * i + 1), point(3 * i + 2));
+		});
+		bench("FillTriangle/gradient", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) {
+				renderer.FillTriangle(opaque(i), opaque((i + 1) % primitiveCount), opaque((i + 2) % primitiveCount), point(3 * i), point(3 * i + 1), point(3 * i + 2));
+			}
+		});
+		bench("FillTriangle/AA", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) renderer.FillTriangle(opaque(i), point(3 * i), point(3 * i + 1), point(3 * i + 2), true);
+		});
+		// five pointed stars (concave, 10 points) with the size of the circles
+		std::vector<cdr::FPoint> stars;
+		for (int i = 0; i < primitiveCount; i++) {
+			for (int j = 0; j < 10; j++) {
+				float angle {static_cast<float>(j) * 0.6283185f};
+				float radius {static_cast<float>(scene.radii[i]) * (j % 2 == 0 ? 1.0f : 0.4f)};
+				stars.push_back(cdr::FPoint{centre(i).x + radius * std::sin(angle), centre(i).y - radius * std::cos(angle)});
+			}
+		}
+		bench("FillPolygon/plain", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) renderer.FillPolygon(opaque(i), stars.data() + 10 * i, 10);
+		});
+		bench("FillPolygon/AA", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) renderer.FillPolygon(opaque(i), stars.data() + 10 * i, 10, true);
+		});
+		bench("FillRoundedRectangle/plain", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) renderer.FillRoundedRectangle(opaque(i), scene.rectangles[i], 8);
+		});
+		bench("FillRoundedRectangle/AA", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) renderer.FillRoundedRectangle(opaque(i), scene.rectangles[i], 8, true);
+		});
+		bench("FillTriangle/shader", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) renderer.FillTriangle(&gradientShader, point(3 * i), point(3 * i + 1), point(3 * i + 2));
+		});
+		bench("DrawTriangle/textured", primitiveCount, [&] {
+			for (int i = 0; i < primitiveCount; i++) {
+				renderer.DrawTriangle(texture, cdr::FPoint{0, 0}, cdr::FPoint{1, 0}, cdr::FPoint{0, 1}, point(3 * i), point(3 * i + 1), point(3 * i + 2));
+			}
+		});
+
+		struct ScaleCase { const char* name; enum cdr::Renderer::ScaleType type; };
+		struct BoundsCase { const char* name; enum cdr::Renderer::OutOfBoundsType type; };
+		const ScaleCase scaleCases[] {{"nearest", cdr::Renderer::ScaleType::Nearest}, {"linear", cdr::Renderer::ScaleType::Linear}, {"trilinear", cdr::Renderer::ScaleType::Trilinear}};
+		const BoundsCase boundsCases[] {
+			{"Repeat", cdr::Renderer::OutOfBoundsType::Repeat},
+			{"MirroredRepeat", cdr::Renderer::OutOfBoundsType::MirroredRepeat},
+			{"ClampToEdge", cdr::Renderer::OutOfBoundsType::ClampToEdge},
+			{"ClampToBorder", cdr::Renderer::OutOfBoundsType::ClampToBorder},
+		};
+		for (const ScaleCase& scale : scaleCases) {
+			for (const BoundsCase& bounds : boundsCases) {
+				// NOTE: the source rectangle reaches outside of the texture so the out of bounds handling is measured as well
+				bench(std::string("DrawBitmap/") + scale.name + "/" + bounds.name, 1, [&] {
+					renderer.ScaleType = scale.type;
+					renderer.OutOfBoundsType = bounds.type;
+					renderer.DrawBitmap(texture, 0.f, 0.f, width, height, -64.f, -64.f, 384, 384);
+				});
+			}
+		}
+		bench("DrawBitmap/copy", 1, [&] {
+			renderer.DrawBitmap(texture, 10.f, 10.f, texture.GetWidth(), texture.GetHeight(), 0.f, 0.f, texture.GetWidth(), texture.GetHeight());
+		});
+		// NOTE: a quarter of the texture as a sprite of an atlas, drawn through a view without copying it
+		const cdr::BitmapView atlasSprite {cdr::BitmapView{texture}.GetSubView(cdr::Rectangle{64, 64, 128, 128})};
+		bench("DrawBitmap/atlasView", 1, [&] {
+			renderer.ScaleType = cdr::Renderer::ScaleType::Linear;
+			renderer.DrawBitmap(atlasSprite, 10.f, 10.f, 300, 300, 0.f, 0.f, atlasSprite.GetWidth(), atlasSprite.GetHeight());
+		});
+		// NOTE: a sprite scaled over the background, blended straight and premultiplied
+		bench("DrawBitmap/sprite", 1, [&] {
+			renderer.EnableAlphaBlending();
+			renderer.ScaleType = cdr::Renderer::ScaleType::Linear;
+			renderer.DrawBitmap(sprite, 10.f, 10.f, 300, 300, 0.f, 0.f, sprite.GetWidth(), sprite.GetHeight());
+		});
+		// NOTE: the alpha of the sprite as a 1 byte coverage mask, tinted while it's blended
+		bench("DrawBitmap/mask", 1, [&] {
+			renderer.DrawBitmap(spriteMask, cdr::RGBA{255, 200, 40, 255}, 10, 10);
+		});
+		bench("DrawBitmap/grey", 1, [&] {
+			renderer.DrawBitmap(greyTexture, 10, 10);
+		});
+		bench("DrawBitmap/spritePremultiplied", 1, [&] {
+			renderer.EnableAlphaBlending();
+			renderer.EnablePremultipliedAlpha();
+			renderer.ScaleType = cdr::Renderer::ScaleType::Linear;
+			renderer.DrawBitmap(premultipliedSprite, 10.f, 10.f, 300, 300, 0.f, 0.f, sprite.GetWidth(), sprite.GetHeight());
+		});
+
+		const std::string text {"The quick brown fox jumps over the lazy dog.\n\tPACK MY BOX WITH FIVE DOZEN LIQUOR JUGS 0123456789"};
+		bench("DrawText/plain", 1, [&] {
+			renderer.DrawText(text, 4, 4, cdr::TextStyle{cdr::Fonts::Raster8x12, false});
+		});
+		bench("DrawText/kerning", 1, [&] {
+			renderer.DrawText(text, 4, 4, cdr::TextStyle{cdr::Fonts::Raster8x12, true});
+		});
+		bench("DrawText/background+shadow", 1, [&] {
+			renderer.DrawText(text, 4, 4, cdr::TextStyle{cdr::Fonts::Raster8x16, true, cdr::TextAlignment::TL, 2, cdr::RGB::White, cdr::RGBA{0, 0, 80, 255}, cdr::RGB::Black, 1, 1});
+		});
+		
+		// NOTE: the same kind of scene recorded once and executed tile parallel, the recording isn't measured
+		cdr::CommandList commandList {};
+		for (int i = 0; i < primitiveCount; i++) {
+			commandList.FillRectangle(scene.colors[i], scene.rectangles[i]);
+			commandList.FillCircle(opaque(i), centre(i), scene.radii[i], true);
+			commandList.FillTriangle(opaque(i), point(3 * i), point(3 * i + 1), point(3 * i + 2));
+			commandList.DrawLine(opaque(i), point(3 * i), point(3 * i + 1), true);
+		}
+		commandList.DrawText(text, 4, 4, cdr::TextStyle{cdr::Fonts::Raster8x12, true});
+		bench("CommandList/execute", primitiveCount * 4 + 1, [&] {
+			renderer.EnableAlphaBlending();
+			commandList.Execute(renderer);
+		});
+
+		const cdr::Rectangle canvas {0, 0, width, height};
+		bench("Filters/GaussianBlur", 1, [&] {
+			cdr::Filters::GaussianBlur(renderer, canvas, 3.f);
+		});
+		bench("Filters/BoxBlur", 1, [&] {
+			cdr::Filters::BoxBlur(renderer, canvas, 4, 3);
+		});
+		const std::vector<float> sharpen {0.f, -1.f, 0.f, -1.f, 5.f, -1.f, 0.f, -1.f, 0.f};
+		bench("Filters/Convolution", 1, [&] {
+			cdr::Filters::Convolution(renderer, canvas, sharpen, 3, 3);
+		});
+
+		// NOTE: a canvas sized intermediate bitmap that is created, written once and destroyed, with and without a pool
+		bench("Bitmap/temporary", 1, [&] {
+			cdr::Bitmap temporary {width, height};
+			temporary.SetRawPixel(0xffffffff, 0, 0);
+		});
+		bench("Bitmap/temporaryPooled", 1, [&] {
+			cdr::Bitmap temporary {width, height, bitmapPool};
+			temporary.SetRawPixel(0xffffffff, 0, 0);
+		});
+		bench("Bitmap/copy", 1, [&] {
+			cdr::Bitmap copy {texture};
+			copy.SetRawPixel(0xffffffff, 0, 0);
+		});
+	}
+
+	std::printf("{\n  \"library\": \"cidr\",\n  \"minTime\": %g,\n  \"results\": [\n", options.minTime);
+	for (size_t i = 0; i < results.size(); i++) {
+		const Result& result = results[i];
+		std::printf("    {\"name\": \"%s\", \"width\": %d, \"height\": %d, \"iterations\": %lld, \"nsPerIteration\": %.1f, \"nsPerPrimitive\": %.1f}%s\n",
+			escape(result.name).c_str(), result.width, result.height, result.iterations, result.nsPerIteration,
+			result.nsPerIteration / result.primitivesPerIteration, i + 1 < results.size() ? "," : "");
+	}
+	std::printf("  ]\n}\n");
+	return 0;
+}
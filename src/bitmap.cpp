@@ -5,59 +5,101 @@
  ********************************/
 
 #include "bitmap.hpp"
+#include "span.hpp"
+#include "pixelFormat.hpp"
 #include <stb/stb_image.h>
 #include <stb/stb_image_write.h>
 #include <stdexcept>
 #include <cstring>
+#include <fstream>
+#include <climits>
+#include <optional>
+#include <memory>
+#include <mutex>
+#include "bitmapPool.hpp"
+#include "mappedFile.hpp"
+#include "threadPool.hpp"
 
+namespace {
+
+// NOTE: the pixels decoded by stb_image, freed even if converting them throws
+using DecodedImage = std::unique_ptr<uint8_t, decltype(&stbi_image_free)>;
+
+}
 
 /* RGBABitmap *******************************************************************************/
 
 cdr::BaseBitmap::BaseBitmap(int width, int height, int numComponents) : 
-	data{new uint32_t[width * height]}, width{width}, height{height}, components{numComponents} { 
+	width{width}, height{height}, components{numComponents} { 
+	setBuffer(BitmapPool::AllocateUnpooled(size_t(width) * height));
+	memset(data, 0, width * height * sizeof(uint32_t));
+}
+cdr::BaseBitmap::BaseBitmap(int width, int height, BitmapPool& pool, int numComponents) : 
+	width{width}, height{height}, components{numComponents} { 
+	setBuffer(pool.Allocate(size_t(width) * height));
 	memset(data, 0, width * height * sizeof(uint32_t));
 }
 cdr::BaseBitmap::BaseBitmap(uint32_t* source, int sourceWidth, int sourceHeight, int sourceComponents) :
-	data{new uint32_t[sourceWidth * sourceHeight]}, width{sourceWidth}, height{sourceHeight}, components{sourceComponents} {
+	width{sourceWidth}, height{sourceHeight}, components{sourceComponents} {
+	setBuffer(BitmapPool::AllocateUnpooled(size_t(width) * height));
 	memcpy(data, source, width * height * sizeof(uint32_t));
 }
-cdr::BaseBitmap::BaseBitmap(std::string_view file, int reqComponents) {
-	uint8_t* imageData = stbi_load(file.data(), &this->width, &this->height, &this->components, reqComponents);
-	this->components = reqComponents;
-	if(imageData) {
-		data = new uint32_t[width * height];
-		for(int i = 0; i < width; i++) {
-			for (int j = 0; j < height; j++) {
-				// NOTE: this handles the cases where the image is monochrome, rgb or rgba (and maybe other cases, haven't tested)
-				data[i + j * width] = 
-					(imageData[(i + j * width) * components + 0] << 24) + 
-					(imageData[(i + j * width) * components + 1] << 16) + 
-					(imageData[(i + j * width) * components + 2] <<  8) + 
-					((components == 4) ? (imageData[(i + j * width) * components + 3] <<  0) : 0xff);
-			}
-		}
-		stbi_image_free(imageData);
-	} else {
-		throw std::runtime_error("Cidr: Bitmap not found (" + std::string(file) + ")");
+cdr::BaseBitmap::BaseBitmap(std::string_view file, int reqComponents, AlphaMode alphaMode) {
+	std::string path {file};
+	std::optional<MappedFile> mapped;
+	try {
+		mapped.emplace(path);
+	} catch (const std::runtime_error&) {
+		throw std::runtime_error("Cidr: Bitmap not found (" + path + ")");
+	}
+	decode(mapped->GetData(), mapped->GetSize(), reqComponents, alphaMode, path);
+}
+cdr::BaseBitmap::BaseBitmap(const uint8_t* fileData, size_t fileSize, int reqComponents, AlphaMode alphaMode) {
+	decode(fileData, fileSize, reqComponents, alphaMode, "memory");
+}
+void cdr::BaseBitmap::decode(const uint8_t* fileData, size_t fileSize, int reqComponents, AlphaMode alphaMode, std::string_view name) {
+	if (fileSize > static_cast<size_t>(INT_MAX)) {
+		throw std::runtime_error("Cidr: Bitmap is too big (" + std::string(name) + ")");
+	}
+	int fileComponents {0};
+	DecodedImage imageData {stbi_load_from_memory(fileData, static_cast<int>(fileSize), &this->width, &this->height, &fileComponents, reqComponents), &stbi_image_free};
+	if (!imageData) {
+		throw std::runtime_error("Cidr: Could not load bitmap (" + std::string(name) + "): " + stbi_failure_reason());
 	}
+	// NOTE: stbi converts to reqComponents itself, 0 keeps the components of the file
+	this->components = reqComponents != 0 ? reqComponents : fileComponents;
+	setBuffer(BitmapPool::AllocateUnpooled(size_t(width) * height));
+	for (int y = 0; y < height; y++) {
+		PackBytesSpan(data + y * width, imageData.get() + size_t(y) * width * components, width, components);
+	}
+	if (alphaMode == AlphaMode::Premultiplied) Premultiply();
 }
 
+// NOTE: copies share the pixels, see unshare
 cdr::BaseBitmap::BaseBitmap(const BaseBitmap& other) : 
-	data{new uint32_t[other.width * other.height]}, width{other.width}, height{other.height}, components{other.components} { 
-	memcpy(data, other.data, width * height * sizeof(uint32_t));
+	data{other.data}, buffer{other.buffer}, width{other.width}, height{other.height}, components{other.components}, 
+	mipData{other.mipData}, mipOffsets{other.mipOffsets}, alphaMode{other.alphaMode} { 
+	if (!other.shareable) unshare();
 }
 cdr::BaseBitmap& cdr::BaseBitmap::operator=(const BaseBitmap& other) {
-	delete[] data;
+	if(this == &other) return *this;
+	
 	this->width = other.width;
 	this->height = other.height;
 	this->components = other.components;
-	data = new uint32_t[width * height];
-	memcpy(data, other.data, width * height * sizeof(uint32_t));
+	this->mipData = other.mipData;
+	this->mipOffsets = other.mipOffsets;
+	this->alphaMode = other.alphaMode;
+	this->buffer = other.buffer;
+	this->data = other.data;
+	this->shareable = true;
+	if (!other.shareable) unshare();
 	
 	return *this;
 }
 cdr::BaseBitmap::BaseBitmap(BaseBitmap&& other) noexcept : 
-	data{other.data} , width{other.width}, height{other.height}, components{other.components} { 
+	data{other.data}, buffer{std::move(other.buffer)}, shareable{other.shareable}, width{other.width}, height{other.height}, components{other.components}, 
+	mipData{std::move(other.mipData)}, mipOffsets{std::move(other.mipOffsets)}, alphaMode{other.alphaMode} { 
 	other.width = 0;
 	other.height = 0;
 	other.data = nullptr;
@@ -65,10 +107,14 @@ cdr::BaseBitmap::BaseBitmap(BaseBitmap&& other) noexcept :
 cdr::BaseBitmap& cdr::BaseBitmap::operator=(BaseBitmap&& other) noexcept {
 	if(this == &other) return *this;
 	
-	delete[] data;
 	this->width = other.width;
 	this->height = other.height;
 	this->components = other.components;
+	this->mipData = std::move(other.mipData);
+	this->mipOffsets = std::move(other.mipOffsets);
+	this->alphaMode = other.alphaMode;
+	this->buffer = std::move(other.buffer);
+	this->shareable = other.shareable;
 	data = other.data;
 	other.width = 0;
 	other.height = 0;
@@ -78,52 +124,311 @@ cdr::BaseBitmap& cdr::BaseBitmap::operator=(BaseBitmap&& other) noexcept {
 	return *this;
 }
 
-cdr::BaseBitmap::~BaseBitmap() {
-	delete[] data;
+cdr::BaseBitmap::~BaseBitmap() {}
+
+void cdr::BaseBitmap::setBuffer(std::shared_ptr<uint32_t> pixels) {
+	buffer = std::move(pixels);
+	data = buffer.get();
+	shareable = true;
+}
+// NOTE: the new buffer comes from the same pool as the shared one
+void cdr::BaseBitmap::unshare() {
+	std::shared_ptr<uint32_t> pixels {BitmapPool::AllocateLike(buffer, size_t(width) * height)};
+	memcpy(pixels.get(), data, size_t(width) * height * sizeof(uint32_t));
+	setBuffer(std::move(pixels));
 }
 
 // provie filename without extension!
 void cdr::BaseBitmap::SaveAs(const std::string& fileName, Formats format, int quality) {
-	// NOTE: Cidr uses rgba, stbi uses abgr
-	uint32_t* abgrData = new uint32_t[this->width * this->height];
-	for (int i = 0; i < this->width * this->height; i++) {
-		abgrData[i] = UINT_RGBAtoUINT_ABGR(data[i]);
+	SaveRows(fileName, format, quality, width, height, fileComponents(), [this](int y, uint8_t* out) { packRow(y, out); });
+}
+void cdr::BaseBitmap::EncodeTo(const EncodeSink& sink, Formats format, int quality) const {
+	EncodeRows(sink, format, quality, width, height, fileComponents(), [this](int y, uint8_t* out) { packRow(y, out); });
+}
+void cdr::BaseBitmap::EncodeTo(std::ostream& out, Formats format, int quality) const {
+	EncodeRows(out, format, quality, width, height, fileComponents(), [this](int y, uint8_t* out) { packRow(y, out); });
+}
+std::vector<uint8_t> cdr::BaseBitmap::Encode(Formats format, int quality) const {
+	std::vector<uint8_t> encoded;
+	EncodeTo([&](const uint8_t* data, size_t size) {
+		encoded.insert(encoded.end(), data, data + size);
+	}, format, quality);
+	return encoded;
+}
+
+// NOTE: files are straight alpha and store the channels in memory order (R, G, B, A), with 3 components the alpha is dropped
+void cdr::BaseBitmap::packRow(int y, uint8_t* out) const {
+	const int components {fileComponents()};
+	const uint32_t* pixels {data + y * width};
+	for (int i = 0; i < width; i++) {
+		uint32_t pixel {IsPremultiplied() ? UnpremultiplyPixel(pixels[i]) : pixels[i]};
+		out[0] = static_cast<uint8_t>(pixel >> 24);
+		out[1] = static_cast<uint8_t>(pixel >> 16);
+		out[2] = static_cast<uint8_t>(pixel >> 8);
+		if (components == 4) out[3] = static_cast<uint8_t>(pixel);
+		out += components;
+	}
+}
+
+namespace {
+
+void writeLittleEndian(std::vector<uint8_t>& out, uint32_t value, int bytes) {
+	for (int i = 0; i < bytes; i++) {
+		out.push_back(static_cast<uint8_t>(value >> (i * 8)));
 	}
+}
+
+void writeToSink(void* context, void* data, int size) {
+	(*static_cast<const cdr::BaseBitmap::EncodeSink*>(context))(static_cast<const uint8_t*>(data), static_cast<size_t>(size));
+}
+
+}
+
+// NOTE: BMP and TGA are written the same way stb_image_write does (24 bit BMP with the alpha composited
+// on magenta and grey expanded to RGB, run length encoded TGA) so the files don't change, but one row at a time
+void cdr::EncodeRows(const BaseBitmap::EncodeSink& sink, BaseBitmap::Formats format, int quality, int width, int height, int components, const PackRowFunction& packRow) {
+	using Formats = BaseBitmap::Formats;
+	if (components != 1 && components != 3 && components != 4) {
+		throw std::runtime_error("Cidr: Can only encode 1, 3 or 4 components");
+	}
+	std::vector<uint8_t> row(size_t(width) * components);
+	std::vector<uint8_t> out;
 	
-	// NOTE: Extension added depending on format argument 
 	switch(format) {
-		case Formats::PNG:
-			stbi_write_png((fileName + ".png").c_str(), GetWidth(), GetHeight(), this->components, abgrData, this->components * GetWidth());
-			break;
-		case Formats::BMP:
-			stbi_write_bmp((fileName + ".bmp").c_str(), GetWidth(), GetHeight(), this->components, abgrData);
+		case Formats::BMP: {
+			const int padding {(-width * 3) & 3};
+			const uint32_t headerSize {14 + 40};
+			writeLittleEndian(out, 'B', 1);
+			writeLittleEndian(out, 'M', 1);
+			writeLittleEndian(out, headerSize + (width * 3 + padding) * height, 4);
+			writeLittleEndian(out, 0, 4);
+			writeLittleEndian(out, headerSize, 4);
+			writeLittleEndian(out, 40, 4);
+			writeLittleEndian(out, width, 4);
+			writeLittleEndian(out, height, 4);
+			writeLittleEndian(out, 1, 2);
+			writeLittleEndian(out, 24, 2);
+			for (int i = 0; i < 6; i++) writeLittleEndian(out, 0, 4);
+			sink(out.data(), out.size());
+			
+			// bottom row first, BGR
+			for (int y = height - 1; y >= 0; y--) {
+				packRow(y, row.data());
+				out.clear();
+				for (int x = 0; x < width; x++) {
+					const uint8_t* pixel {&row[x * components]};
+					if (components == 4) {
+						const int background[3] {255, 0, 255};
+						for (int k = 2; k >= 0; k--) {
+							out.push_back(static_cast<uint8_t>(background[k] + ((pixel[k] - background[k]) * pixel[3]) / 255));
+						}
+					} else if (components == 3) {
+						out.insert(out.end(), {pixel[2], pixel[1], pixel[0]});
+					} else {
+						out.insert(out.end(), {pixel[0], pixel[0], pixel[0]});
+					}
+				}
+				out.insert(out.end(), padding, 0);
+				sink(out.data(), out.size());
+			}
 			break;
-		case Formats::TGA:
-			stbi_write_tga((fileName + ".tga").c_str(), GetWidth(), GetHeight(), this->components, abgrData);
+		}
+		case Formats::TGA: {
+			const bool hasAlpha {components == 4};
+			writeLittleEndian(out, 0, 1);
+			writeLittleEndian(out, 0, 1);
+			writeLittleEndian(out, components == 1 ? 11 : 10, 1); // run length encoded grey or true color
+			writeLittleEndian(out, 0, 2);
+			writeLittleEndian(out, 0, 2);
+			writeLittleEndian(out, 0, 1);
+			writeLittleEndian(out, 0, 2);
+			writeLittleEndian(out, 0, 2);
+			writeLittleEndian(out, width, 2);
+			writeLittleEndian(out, height, 2);
+			writeLittleEndian(out, components * 8, 1);
+			writeLittleEndian(out, hasAlpha ? 8 : 0, 1);
+			sink(out.data(), out.size());
+			
+			auto writePixel = [&](const uint8_t* pixel) {
+				if (components == 1) {
+					out.push_back(pixel[0]);
+					return;
+				}
+				out.insert(out.end(), {pixel[2], pixel[1], pixel[0]});
+				if (hasAlpha) out.push_back(pixel[3]);
+			};
+			auto same = [&](int a, int b) {
+				return memcmp(&row[a * components], &row[b * components], components) == 0;
+			};
+			// bottom row first, every row is split into packets of up to 128 pixels that either repeat one pixel or are copied as they are
+			for (int y = height - 1; y >= 0; y--) {
+				packRow(y, row.data());
+				out.clear();
+				int length {1};
+				for (int x = 0; x < width; x += length) {
+					bool repeat {false};
+					length = 1;
+					if (x < width - 1) {
+						length++;
+						repeat = same(x, x + 1);
+						if (!repeat) {
+							// NOTE: compares with the pixel two before like stb_image_write, so the packets are the same
+							for (int k = x + 2; k < width && length < 128; k++) {
+								if (same(k - 2, k)) {
+									length--;
+									break;
+								}
+								length++;
+							}
+						} else {
+							for (int k = x + 2; k < width && length < 128 && same(x, k); k++) {
+								length++;
+							}
+						}
+					}
+					if (repeat) {
+						out.push_back(static_cast<uint8_t>(length - 129));
+						writePixel(&row[x * components]);
+					} else {
+						out.push_back(static_cast<uint8_t>(length - 1));
+						for (int k = 0; k < length; k++) {
+							writePixel(&row[(x + k) * components]);
+						}
+					}
+				}
+				sink(out.data(), out.size());
+			}
 			break;
-		case Formats::JPG:
-			stbi_write_jpg((fileName + ".jpg").c_str(), GetWidth(), GetHeight(), this->components, abgrData, quality);
+		}
+		case Formats::PNG:
+		case Formats::JPG: {
+			// NOTE: stb_image_write reads the whole image while encoding, so it's converted once
+			std::vector<uint8_t> image(size_t(width) * height * components);
+			for (int y = 0; y < height; y++) {
+				packRow(y, image.data() + size_t(y) * width * components);
+			}
+			void* context {const_cast<BaseBitmap::EncodeSink*>(&sink)};
+			int result {format == Formats::PNG ?
+				stbi_write_png_to_func(writeToSink, context, width, height, components, image.data(), width * components) :
+				stbi_write_jpg_to_func(writeToSink, context, width, height, components, image.data(), quality)};
+			if (!result) {
+				throw std::runtime_error("Cidr: Could not encode the bitmap");
+			}
 			break;
+		}
 	}
+}
+void cdr::EncodeRows(std::ostream& out, BaseBitmap::Formats format, int quality, int width, int height, int components, const PackRowFunction& packRow) {
+	EncodeRows([&](const uint8_t* data, size_t size) {
+		out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+	}, format, quality, width, height, components, packRow);
+	if (!out) {
+		throw std::runtime_error("Cidr: Could not write the encoded bitmap");
+	}
+}
+void cdr::SaveRows(const std::string& fileName, BaseBitmap::Formats format, int quality, int width, int height, int components, const PackRowFunction& packRow) {
+	using Formats = BaseBitmap::Formats;
+	// NOTE: Extension added depending on format argument 
+	std::string extension;
+	switch(format) {
+		case Formats::PNG: extension = ".png"; break;
+		case Formats::BMP: extension = ".bmp"; break;
+		case Formats::TGA: extension = ".tga"; break;
+		case Formats::JPG: extension = ".jpg"; break;
+	}
+	std::ofstream file {fileName + extension, std::ios::binary};
+	if (!file) {
+		throw std::runtime_error("Cidr: Could not open " + fileName + extension + " for writing");
+	}
+	EncodeRows(file, format, quality, width, height, components, packRow);
+}
+
+void cdr::BaseBitmap::Premultiply() {
+	if (IsPremultiplied()) return;
+	detach();
+	PremultiplySpan(data, data, width * height);
+	if (mipData) {
+		auto levels = std::make_shared<std::vector<uint32_t>>(mipData->size());
+		PremultiplySpan(levels->data(), mipData->data(), static_cast<int>(levels->size()));
+		mipData = levels;
+	}
+	alphaMode = AlphaMode::Premultiplied;
+}
+void cdr::BaseBitmap::Unpremultiply() {
+	if (!IsPremultiplied()) return;
+	detach();
+	UnpremultiplySpan(data, data, width * height);
+	if (mipData) {
+		auto levels = std::make_shared<std::vector<uint32_t>>(mipData->size());
+		UnpremultiplySpan(levels->data(), mipData->data(), static_cast<int>(levels->size()));
+		mipData = levels;
+	}
+	alphaMode = AlphaMode::Straight;
+}
+
+void cdr::BaseBitmap::GenerateMipmaps() {
+	ClearMipmaps();
+	if (width <= 0 || height <= 0) return;
+	
+	int levels = 1;
+	size_t size = 0;
+	mipOffsets.push_back(0);
+	while (GetMipWidth(levels - 1) > 1 || GetMipHeight(levels - 1) > 1) {
+		mipOffsets.push_back(size);
+		size += GetMipWidth(levels) * GetMipHeight(levels);
+		levels++;
+	}
+	auto mips = std::make_shared<std::vector<uint32_t>>(size);
 	
-	delete[] abgrData;
+	for (int level = 1; level < levels; level++) {
+		const uint32_t* src = level == 1 ? data : mips->data() + mipOffsets[level - 1];
+		int srcWidth = GetMipWidth(level - 1);
+		int srcHeight = GetMipHeight(level - 1);
+		uint32_t* dst = mips->data() + mipOffsets[level];
+		int dstWidth = GetMipWidth(level);
+		int dstHeight = GetMipHeight(level);
+		
+		// NOTE: a side of 1 is not halved any more, the same row or column is used twice then
+		for (int y = 0; y < dstHeight; y++) {
+			const uint32_t* row0 = src + std::min(y * 2, srcHeight - 1) * srcWidth;
+			const uint32_t* row1 = src + std::min(y * 2 + 1, srcHeight - 1) * srcWidth;
+			for (int x = 0; x < dstWidth; x++) {
+				int x0 = std::min(x * 2, srcWidth - 1);
+				int x1 = std::min(x * 2 + 1, srcWidth - 1);
+				uint32_t result = 0;
+				for (int shift = 0; shift < 32; shift += 8) {
+					uint32_t sum = ((row0[x0] >> shift) & 0xff) + ((row0[x1] >> shift) & 0xff) + 
+					               ((row1[x0] >> shift) & 0xff) + ((row1[x1] >> shift) & 0xff);
+					result |= ((sum + 2) >> 2) << shift;
+				}
+				dst[x + y * dstWidth] = result;
+			}
+		}
+	}
+	mipData = mips;
+}
+void cdr::BaseBitmap::ClearMipmaps() {
+	mipData.reset();
+	mipOffsets.clear();
 }
 
 
 /* RGBABitmap *******************************************************************************/
 
 cdr::RGBABitmap::RGBABitmap(int width, int height) : BaseBitmap(width, height, 4) {}
+cdr::RGBABitmap::RGBABitmap(int width, int height, BitmapPool& pool) : BaseBitmap(width, height, pool, 4) {}
 cdr::RGBABitmap::RGBABitmap(uint32_t* source, int sourceWidth, int sourceHeight) : BaseBitmap(source, sourceWidth, sourceHeight, 4) {}
-cdr::RGBABitmap::RGBABitmap(std::string_view file) : BaseBitmap(file, 4) {}
+cdr::RGBABitmap::RGBABitmap(std::string_view file, AlphaMode alphaMode) : BaseBitmap(file, 4, alphaMode) {}
+cdr::RGBABitmap::RGBABitmap(const uint8_t* fileData, size_t fileSize, AlphaMode alphaMode) : BaseBitmap(fileData, fileSize, 4, alphaMode) {}
 
 cdr::RGBABitmap::RGBABitmap(const RGBABitmap& other) : BaseBitmap(other) {}
 cdr::RGBABitmap& cdr::RGBABitmap::operator=(const RGBABitmap& other) {
 	BaseBitmap::operator=(other);
 	return *this;
 }
-cdr::RGBABitmap::RGBABitmap(RGBABitmap&& other) noexcept : BaseBitmap(other) {}
+cdr::RGBABitmap::RGBABitmap(RGBABitmap&& other) noexcept : BaseBitmap(std::move(other)) {}
 cdr::RGBABitmap& cdr::RGBABitmap::operator=(RGBABitmap&& other) noexcept {
-	BaseBitmap::operator=(other);
+	BaseBitmap::operator=(std::move(other));
 	return *this;
 }
 cdr::RGBABitmap::~RGBABitmap() {}
@@ -132,92 +437,87 @@ cdr::RGBABitmap::~RGBABitmap() {}
 /* RGBBitmap *******************************************************************************/
 
 cdr::RGBBitmap::RGBBitmap(int width, int height) : BaseBitmap(width, height, 3) {}
+cdr::RGBBitmap::RGBBitmap(int width, int height, BitmapPool& pool) : BaseBitmap(width, height, pool, 3) {}
 cdr::RGBBitmap::RGBBitmap(uint32_t* source, int sourceWidth, int sourceHeight) : BaseBitmap(source, sourceWidth, sourceHeight, 4) {}
 cdr::RGBBitmap::RGBBitmap(std::string_view file) : BaseBitmap(file, 3) {}
+cdr::RGBBitmap::RGBBitmap(const uint8_t* fileData, size_t fileSize) : BaseBitmap(fileData, fileSize, 3) {}
 
 cdr::RGBBitmap::RGBBitmap(const RGBBitmap& other) : BaseBitmap(other) {}
 cdr::RGBBitmap& cdr::RGBBitmap::operator=(const RGBBitmap& other) {
 	BaseBitmap::operator=(other);
 	return *this;
 }
-cdr::RGBBitmap::RGBBitmap(RGBBitmap&& other) noexcept : BaseBitmap(other) {}
+cdr::RGBBitmap::RGBBitmap(RGBBitmap&& other) noexcept : BaseBitmap(std::move(other)) {}
 cdr::RGBBitmap& cdr::RGBBitmap::operator=(RGBBitmap&& other) noexcept {
-	BaseBitmap::operator=(other);
+	BaseBitmap::operator=(std::move(other));
 	return *this;
 }
 cdr::RGBBitmap::~RGBBitmap() {}
 
 
-/* MonochromeBitmap *******************************************************************************/
-
-// cdr::MonochromeBitmap::MonochromeBitmap(int width, int height) : 
-// 	data{new uint8_t[width * height]}, width{width}, height{height} { 
-// 	memset(data, 0, width * height * sizeof(uint8_t));
-// }
-// cdr::MonochromeBitmap::MonochromeBitmap(uint8_t* source, int sourceWidth, int sourceHeight) :
-// 	data{new uint8_t[sourceWidth * sourceHeight]}, width{sourceWidth}, height{sourceHeight} {
-// 	memcpy(data, source, width * height * sizeof(uint8_t));
-// }
-// cdr::MonochromeBitmap::MonochromeBitmap(std::string_view file) {
-// 	int channels;
-// 	uint8_t* imageData = stbi_load(file.c_str(), &this->width, &this->height, &channels, 0);
-// 	if(imageData) {
-// 		data = new uint8_t[width * height];
-// 		for(int i = 0; i < width; i++) {
-// 			for (int j = 0; j < height; j++) {
-// 				// TODO: make monochrome bitmap even if source image is not monochrome.
-// 				// see: https://stackoverflow.com/q/596216/10187214
-// 				if(channels == 1) {
-// 					data[i + j * width] = imageData[i + j * width];
-// 				} else {
-// 					RGB color {
-// 						(uint8_t)((imageData[(i + j * width) * channels + 0] << 24)),
-// 						(uint8_t)((imageData[(i + j * width) * channels + 1] << 16)),
-// 						(uint8_t)((imageData[(i + j * width) * channels + 2] <<  8)),
-// 					};
-// 					uint8_t monochromeColor {
-// 						(uint8_t)(color.r * 0.2126 + color.b * 0.7152 + color.g * 0.0722),
-// 					};
-// 					data[i + j * width] = (uint8_t)monochromeColor;
-// 				}
-// 			}
-// 		}
-// 		stbi_image_free(imageData);
-// 	}
-// }
-
-// cdr::MonochromeBitmap::MonochromeBitmap(const MonochromeBitmap& other)  : 
-// 	data{new uint8_t[other.width * other.height]}, width{other.width}, height{other.height} { 
-// 	memcpy(data, other.data, width * height * sizeof(uint8_t));
-// }
-// cdr::MonochromeBitmap& cdr::MonochromeBitmap::operator=(const MonochromeBitmap& other) {
-// 	delete[] data;
-// 	this->width = other.width;
-// 	this->height = other.height;
-// 	data = new uint8_t[width * height];
-// 	memcpy(data, other.data, width * height * sizeof(uint8_t));
-	
-// 	return *this;
-// }
-// cdr::MonochromeBitmap::MonochromeBitmap(MonochromeBitmap&& other) noexcept : 
-// 	data{other.data} , width{other.width}, height{other.height} { 
-// 	other.width = 0;
-// 	other.height = 0;
-// 	other.data = nullptr;
-// }
-// cdr::MonochromeBitmap& cdr::MonochromeBitmap::operator=(MonochromeBitmap&& other) noexcept {
-// 	if(this == &other) return *this;
-	
-// 	delete[] data;
-// 	this->width = other.width;
-// 	this->height = other.height;
-// 	data = other.data;
-// 	other.width = 0;
-// 	other.height = 0;
-// 	other.data = nullptr;
-	
-// 	return *this;
-// }
-// cdr::MonochromeBitmap::~MonochromeBitmap() {
-// 	delete[] data;
-// }
+/* LoadBitmaps *******************************************************************************/
+
+std::vector<cdr::Bitmap> cdr::LoadBitmaps(const std::vector<std::string>& paths, ThreadPool& pool, BaseBitmap::AlphaMode alphaMode) {
+	std::vector<std::optional<Bitmap>> loaded(paths.size());
+	std::mutex errorMutex;
+	std::exception_ptr error;
+	// NOTE: every file is loaded even if one failed, so the error reported is always the one of the first path
+	size_t firstError {paths.size()};
+	pool.ParallelFor(static_cast<int>(paths.size()), [&](int i) {
+		try {
+			loaded[i].emplace(paths[i], alphaMode);
+		} catch (...) {
+			std::lock_guard<std::mutex> lock {errorMutex};
+			if (static_cast<size_t>(i) < firstError) {
+				firstError = i;
+				error = std::current_exception();
+			}
+		}
+	});
+	if (error) std::rethrow_exception(error);
+
+	std::vector<Bitmap> bitmaps;
+	bitmaps.reserve(paths.size());
+	for (std::optional<Bitmap>& bitmap : loaded) {
+		bitmaps.push_back(std::move(*bitmap));
+	}
+	return bitmaps;
+}
+std::vector<cdr::Bitmap> cdr::LoadBitmaps(const std::vector<std::string>& paths, BaseBitmap::AlphaMode alphaMode) {
+	ThreadPool pool;
+	return LoadBitmaps(paths, pool, alphaMode);
+}
+
+/* DecodePixels *******************************************************************************/
+
+namespace {
+
+void decodePixels(const uint8_t* fileData, size_t fileSize, int components, const cdr::DecodeReceiver& receive, std::string_view name) {
+	if (fileSize > static_cast<size_t>(INT_MAX)) {
+		throw std::runtime_error("Cidr: Bitmap is too big (" + std::string(name) + ")");
+	}
+	int width {0};
+	int height {0};
+	int fileComponents {0};
+	DecodedImage imageData {stbi_load_from_memory(fileData, static_cast<int>(fileSize), &width, &height, &fileComponents, components), &stbi_image_free};
+	if (!imageData) {
+		throw std::runtime_error("Cidr: Could not load bitmap (" + std::string(name) + "): " + stbi_failure_reason());
+	}
+	receive(imageData.get(), width, height);
+}
+
+}
+
+void cdr::DecodePixels(std::string_view file, int components, const DecodeReceiver& receive) {
+	std::string path {file};
+	std::optional<MappedFile> mapped;
+	try {
+		mapped.emplace(path);
+	} catch (const std::runtime_error&) {
+		throw std::runtime_error("Cidr: Bitmap not found (" + path + ")");
+	}
+	decodePixels(mapped->GetData(), mapped->GetSize(), components, receive, path);
+}
+void cdr::DecodePixels(const uint8_t* fileData, size_t fileSize, int components, const DecodeReceiver& receive) {
+	decodePixels(fileData, fileSize, components, receive, "memory");
+}
@@ -9,20 +9,57 @@
 
 #include <cstdint>
 #include "color.hpp"
+#include "rectangle.hpp"
 #include <type_traits>
+#include <algorithm>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace cdr {
 
+class ThreadPool;
+class BitmapPool;
+class BaseBitmap;
+template <typename Format>
+class FormatBitmap;
+namespace Filters {
+void BoxBlur(BaseBitmap& bitmap, int radius, int passes);
+void SeparableConvolution(BaseBitmap& bitmap, const std::vector<float>& kernelX, const std::vector<float>& kernelY);
+void Convolution(BaseBitmap& bitmap, const std::vector<float>& kernel, int kernelWidth, int kernelHeight);
+}
+
+// NOTE: The pixels are 64 byte aligned and copy on write: a copy shares the pixels (and mip levels) of the
+// bitmap it was copied from, until one of them is written to with SetPixel, SetRawPixel, Premultiply...
+// or the writable GetData. Only then the pixels are copied. A bitmap whose writable pointer was handed out
+// (e.g. to a Renderer) can be written at any time, so it isn't shared anymore and its copies copy the pixels
 class BaseBitmap {
+	// NOTE: they write the pixels through writableData, see there
+	template <typename Format>
+	friend class FormatBitmap;
+	friend void Filters::BoxBlur(BaseBitmap& bitmap, int radius, int passes);
+	friend void Filters::SeparableConvolution(BaseBitmap& bitmap, const std::vector<float>& kernelX, const std::vector<float>& kernelY);
+	friend void Filters::Convolution(BaseBitmap& bitmap, const std::vector<float>& kernel, int kernelWidth, int kernelHeight);
+
 protected:
-	/* Individual pixels of the bitmap */
+	/* Individual pixels of the bitmap, points into buffer */
 	uint32_t* data{nullptr};
+	/* Owner of the pixels, shared between copies */
+	std::shared_ptr<uint32_t> buffer;
+	/* False once a writable pointer to the pixels was handed out */
+	bool shareable{true};
 	/* Width of the bitmap */
 	int width{0};
 	/* Height of the bitmap */
 	int height{0};
 	/* Num of components*/
 	int components;
+	/* Mip levels 1 and smaller, stored one after the other (level 0 is data), shared between copies */
+	std::shared_ptr<const std::vector<uint32_t>> mipData;
+	/* Offset into mipData of every level, including level 0 */
+	std::vector<size_t> mipOffsets;
 	
 public:
 	enum class Formats {
@@ -31,10 +68,25 @@ public:
 		TGA,
 		JPG,
 	};
+	// NOTE: premultiplied pixels have their colors already multiplied by their alpha, they blend with one
+	// multiply per channel and filter without dark fringes. Files are always straight, a bitmap is converted when it's loaded and saved
+	enum class AlphaMode {
+		Straight,
+		Premultiplied,
+	};
 	
+protected:
+	AlphaMode alphaMode {AlphaMode::Straight};
+	
+public:
 	BaseBitmap(int width, int height, int numComponents = 4);
+	// the pixels come from the pool and go back to it when the last copy is destroyed
+	BaseBitmap(int width, int height, BitmapPool& pool, int numComponents = 4);
 	BaseBitmap(uint32_t* source, int sourceWidth, int sourceHeight, int sourceComponents);
-	BaseBitmap(std::string_view file, int reqComponents = 0);
+	// NOTE: the file is memory mapped and decoded straight from the mapping
+	BaseBitmap(std::string_view file, int reqComponents = 0, AlphaMode alphaMode = AlphaMode::Straight);
+	// decodes a whole file (PNG, BMP, TGA, JPG, ...) that is already in memory
+	BaseBitmap(const uint8_t* fileData, size_t fileSize, int reqComponents = 0, AlphaMode alphaMode = AlphaMode::Straight);
 	virtual ~BaseBitmap();
 
 	BaseBitmap(const BaseBitmap& other);
@@ -44,12 +96,60 @@ public:
 
 	inline int GetWidth() const { return width; }
 	inline int GetHeight() const { return height; }
-	inline uint32_t* GetData() const { return data; }
+	inline const uint32_t* GetData() const { return data; }
+	// NOTE: the pixels are copied first if they are shared, and the bitmap isn't shared anymore after that
+	inline uint32_t* GetData() { detach(); shareable = false; return data; }
 	inline uint32_t GetRawPixel(int x, int y) const { return data[x + y * width]; }
-	inline void SetRawPixel(uint32_t value, int x, int y) { data[x + y * width] = value; }
-	inline void SetRawPixel(uint8_t r, uint8_t g, uint8_t b, uint8_t a, int x, int y) { data[x + y * width] = (r << 24) + (g << 16) + (b << 8) + a; }
+	inline void SetRawPixel(uint32_t value, int x, int y) { detach(); data[x + y * width] = value; }
+	inline void SetRawPixel(uint8_t r, uint8_t g, uint8_t b, uint8_t a, int x, int y) { detach(); data[x + y * width] = (r << 24) + (g << 16) + (b << 8) + a; }
+	// true while other bitmaps use the same pixels
+	inline bool IsShared() const { return buffer.use_count() > 1; }
+	
+	// NOTE: receives the encoded file in pieces, in order. The pointer is only valid during the call
+	using EncodeSink = std::function<void(const uint8_t* data, size_t size)>;
 	
 	void SaveAs(const std::string& fileName, Formats format, int quality = 100);
+	// NOTE: encodes the bitmap without a file, quality is only used by JPG. BMP and TGA are written
+	// row by row through a single row buffer, PNG and JPG need the whole image in the file's byte order
+	// so they convert it once before encoding. Throws if the encoder fails
+	void EncodeTo(const EncodeSink& sink, Formats format, int quality = 100) const;
+	void EncodeTo(std::ostream& out, Formats format, int quality = 100) const;
+	std::vector<uint8_t> Encode(Formats format, int quality = 100) const;
+	
+	inline AlphaMode GetAlphaMode() const { return alphaMode; }
+	inline bool IsPremultiplied() const { return alphaMode == AlphaMode::Premultiplied; }
+	// NOTE: converts the pixels and the mip levels in place, does nothing if the bitmap already is in that mode
+	void Premultiply();
+	void Unpremultiply();
+	
+	// NOTE: builds the mip chain (every level half the size of the previous one, down to 1x1) with a 2x2 box filter.
+	// It's only built when this is called and is not updated when the pixels change, call it again after that
+	void GenerateMipmaps();
+	void ClearMipmaps();
+	inline bool HasMipmaps() const { return !mipOffsets.empty(); }
+	// number of levels including level 0 (the bitmap itself)
+	inline int GetMipLevelCount() const { return HasMipmaps() ? static_cast<int>(mipOffsets.size()) : 1; }
+	inline int GetMipWidth(int level) const { return std::max(1, width >> level); }
+	inline int GetMipHeight(int level) const { return std::max(1, height >> level); }
+	inline const uint32_t* GetMipData(int level) const { return level == 0 ? data : mipData->data() + mipOffsets[level]; }
+	
+protected:
+	// makes sure no other bitmap uses the pixels before they are written to
+	inline void detach() { if (buffer.use_count() > 1) unshare(); }
+	// NOTE: unlike GetData the bitmap stays shareable, for writes that are done before the call returns
+	// and don't keep the pointer (the filters, FormatBitmap::ToBitmap)
+	inline uint32_t* writableData() { detach(); return data; }
+	
+private:
+	// copies the pixels into a buffer of this bitmap only
+	void unshare();
+	// uses pixels as the buffer of this bitmap
+	void setBuffer(std::shared_ptr<uint32_t> pixels);
+	void decode(const uint8_t* fileData, size_t fileSize, int reqComponents, AlphaMode alphaMode, std::string_view name);
+	// components of the saved files, RGBBitmaps are saved without alpha
+	inline int fileComponents() const { return components == 3 ? 3 : 4; }
+	// row y in the byte order of the file, see EncodeRows
+	void packRow(int y, uint8_t* out) const;
 };
 
 class RGBABitmap : public BaseBitmap {
@@ -57,8 +157,10 @@ class RGBABitmap : public BaseBitmap {
 	
 public:
 	RGBABitmap(int width, int height);
+	RGBABitmap(int width, int height, BitmapPool& pool);
 	RGBABitmap(uint32_t* source, int sourceWidth, int sourceHeight);
-	RGBABitmap(std::string_view file);
+	RGBABitmap(std::string_view file, AlphaMode alphaMode = AlphaMode::Straight);
+	RGBABitmap(const uint8_t* fileData, size_t fileSize, AlphaMode alphaMode = AlphaMode::Straight);
 	~RGBABitmap();
 
 	// copy constructor/assignment
@@ -71,6 +173,7 @@ public:
 		return RGBA{data[x + y * width]};
 	}
 	inline void SetPixel(const RGB& value, int x, int y) {
+		detach();
 		data[x + y * width] = RGBtoUINT(value);
 	}
 };
@@ -80,8 +183,10 @@ class RGBBitmap : public BaseBitmap {
 	
 public:
 	RGBBitmap(int width, int height);
+	RGBBitmap(int width, int height, BitmapPool& pool);
 	RGBBitmap(uint32_t* source, int sourceWidth, int sourceHeight);
 	RGBBitmap(std::string_view file);
+	RGBBitmap(const uint8_t* fileData, size_t fileSize);
 	~RGBBitmap();
 
 	// copy constructor/assignment
@@ -94,50 +199,89 @@ public:
 		return RGB{data[x + y * width]};
 	}
 	inline void SetPixel(const RGB& value, int x, int y) {
+		detach();
 		data[x + y * width] = RGBtoUINT(value);
 	}
 };
 
-// class MonochromeBitmap {
-// private:
-// 	/* Individual pixels of the bitmap */
-// 	uint8_t* data{nullptr};
-// 	/* Width of the bitmap */
-// 	int width{0};
-// 	/* Height of the bitmap */
-// 	int height{0};
-// public:
-// 	MonochromeBitmap(int width, int height);
-// 	MonochromeBitmap(uint8_t* source, int sourceWidth, int sourceHeight);
-// 	MonochromeBitmap(std::string_view file);
-// 	~MonochromeBitmap();
-
-// 	// copy constructor/assignment
-// 	MonochromeBitmap(const MonochromeBitmap& other);
-// 	MonochromeBitmap& operator=(const MonochromeBitmap& other);
-// 	MonochromeBitmap(MonochromeBitmap&& other) noexcept;
-// 	MonochromeBitmap& operator=(MonochromeBitmap&& other) noexcept;
-
-// 	inline int GetWidth() const  {
-// 		return width;
-// 	}
-// 	inline int GetHeight() const {
-// 		return height;
-// 	}
-// 	inline uint8_t* GetData() const {
-// 		return data;
-// 	}
-	
-// 	inline uint8_t GetPixel(int x, int y) {
-// 		return data[x + y * width];
-// 	}
-// 	inline void SetPixel(const uint8_t& value, int x, int y) {
-// 		data[x + y * width] = value;
-// 	}
-// };
+// NOTE: grey, mask and packed RGB bitmaps with 1 and 3 bytes per pixel are MonochromeBitmap, MaskBitmap
+// and RGB24Bitmap in formatBitmap.hpp
 
 using Bitmap = RGBABitmap;
 
+// NOTE: A non-owning view of RGBA pixels: a pointer, a size and a stride (pixels from the start of one row
+// to the start of the next one). It doesn't copy anything, so the pixels have to outlive the view.
+// Renderer::DrawBitmap and the textured triangles take views, a bitmap converts to one implicitly and
+// GetSubView makes a view of a part of it, e.g. a sprite of an atlas, without copying it.
+// Only the view of a whole bitmap has its mip levels, a sub view or a view of raw pixels has none
+class BitmapView {
+public:
+	BitmapView() = default;
+	BitmapView(const BaseBitmap& bitmap)
+		: data{bitmap.GetData()}, width{bitmap.GetWidth()}, height{bitmap.GetHeight()}, stride{bitmap.GetWidth()},
+		alphaMode{bitmap.GetAlphaMode()}, mipmaps{bitmap.HasMipmaps() ? &bitmap : nullptr} {}
+	// stride is in pixels, 0 means the rows are tightly packed (stride == width)
+	BitmapView(const uint32_t* data, int width, int height, int stride = 0, BaseBitmap::AlphaMode alphaMode = BaseBitmap::AlphaMode::Straight)
+		: data{data}, width{width}, height{height}, stride{stride > 0 ? stride : width}, alphaMode{alphaMode} {}
+	
+	// the part of the view inside of the rectangle, it shares the pixels and the stride of this view
+	BitmapView GetSubView(const Rectangle& rectangle) const {
+		int left {std::max(rectangle.x, 0)};
+		int top {std::max(rectangle.y, 0)};
+		int right {std::min(rectangle.x + rectangle.width, width)};
+		int bottom {std::min(rectangle.y + rectangle.height, height)};
+		if (right <= left || bottom <= top) return BitmapView{};
+		return BitmapView{data + left + top * stride, right - left, bottom - top, stride, alphaMode};
+	}
+	
+	inline int GetWidth() const { return width; }
+	inline int GetHeight() const { return height; }
+	inline int GetStride() const { return stride; }
+	inline const uint32_t* GetData() const { return data; }
+	inline const uint32_t* GetRow(int y) const { return data + y * stride; }
+	inline uint32_t GetRawPixel(int x, int y) const { return data[x + y * stride]; }
+	inline RGBA GetPixel(int x, int y) const { return RGBA{data[x + y * stride]}; }
+	inline bool IsEmpty() const { return width <= 0 || height <= 0; }
+	
+	inline BaseBitmap::AlphaMode GetAlphaMode() const { return alphaMode; }
+	inline bool IsPremultiplied() const { return alphaMode == BaseBitmap::AlphaMode::Premultiplied; }
+	
+	// NOTE: same as the ones of BaseBitmap, the levels after 0 are tightly packed (their stride is their width)
+	inline bool HasMipmaps() const { return mipmaps != nullptr; }
+	inline int GetMipLevelCount() const { return HasMipmaps() ? mipmaps->GetMipLevelCount() : 1; }
+	inline int GetMipWidth(int level) const { return std::max(1, width >> level); }
+	inline int GetMipHeight(int level) const { return std::max(1, height >> level); }
+	inline int GetMipStride(int level) const { return level == 0 ? stride : GetMipWidth(level); }
+	inline const uint32_t* GetMipData(int level) const { return level == 0 ? data : mipmaps->GetMipData(level); }
+	
+private:
+	const uint32_t* data {nullptr};
+	int width {0};
+	int height {0};
+	int stride {0};
+	BaseBitmap::AlphaMode alphaMode {BaseBitmap::AlphaMode::Straight};
+	const BaseBitmap* mipmaps {nullptr};
+};
+
+// NOTE: loads every file on the threads of the pool, the bitmaps are in the same order as the paths.
+// If files can't be loaded, the error of the first one of them in paths is thrown after all the others were loaded
+std::vector<Bitmap> LoadBitmaps(const std::vector<std::string>& paths, ThreadPool& pool, BaseBitmap::AlphaMode alphaMode = BaseBitmap::AlphaMode::Straight);
+// same, on a pool with one thread per core that only lives during the call
+std::vector<Bitmap> LoadBitmaps(const std::vector<std::string>& paths, BaseBitmap::AlphaMode alphaMode = BaseBitmap::AlphaMode::Straight);
+
+// NOTE: the encoders behind BaseBitmap::SaveAs and EncodeTo, for pixels that are stored in another way.
+// packRow writes row y in the byte order of the file: components bytes per pixel (1 grey, 3 RGB or 4 RGBA)
+// with straight alpha. SaveRows adds the extension of the format to fileName like SaveAs
+using PackRowFunction = std::function<void(int y, uint8_t* out)>;
+void EncodeRows(const BaseBitmap::EncodeSink& sink, BaseBitmap::Formats format, int quality, int width, int height, int components, const PackRowFunction& packRow);
+void EncodeRows(std::ostream& out, BaseBitmap::Formats format, int quality, int width, int height, int components, const PackRowFunction& packRow);
+void SaveRows(const std::string& fileName, BaseBitmap::Formats format, int quality, int width, int height, int components, const PackRowFunction& packRow);
+// NOTE: decodes a file into components bytes per pixel in the order of the file (stb_image converts the
+// channels if the file has another count). receive gets the pixels once, they are only valid during the call
+using DecodeReceiver = std::function<void(const uint8_t* pixels, int width, int height)>;
+void DecodePixels(std::string_view file, int components, const DecodeReceiver& receive);
+void DecodePixels(const uint8_t* fileData, size_t fileSize, int components, const DecodeReceiver& receive);
+
 }
 
 #endif
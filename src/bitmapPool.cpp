@@ -0,0 +1,122 @@
+/********************************
+ * Project: Cidr				*
+ * File: bitmapPool.cpp			*
+ * Date: 18.10.2026				*
+ ********************************/
+
+#include "bitmapPool.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace {
+
+// NOTE: the size is rounded up to the alignment, std::aligned_alloc needs that and it's the size of the bucket
+size_t bucketSize(size_t count) {
+	size_t bytes {std::max<size_t>(count, 1) * sizeof(uint32_t)};
+	return (bytes + cdr::BitmapPool::Alignment - 1) / cdr::BitmapPool::Alignment * cdr::BitmapPool::Alignment;
+}
+
+void* alignedAllocate(size_t bytes) {
+#ifdef _WIN32
+	void* memory {_aligned_malloc(bytes, cdr::BitmapPool::Alignment)};
+#else
+	void* memory {std::aligned_alloc(cdr::BitmapPool::Alignment, bytes)};
+#endif
+	if (!memory) throw std::bad_alloc();
+	return memory;
+}
+
+void alignedFree(void* memory) {
+#ifdef _WIN32
+	_aligned_free(memory);
+#else
+	std::free(memory);
+#endif
+}
+
+}
+
+struct cdr::BitmapPool::State {
+	std::mutex mutex;
+	std::map<size_t, std::vector<void*>> buckets;
+	size_t cachedBytes {0};
+	int maxBuffersPerSize {0};
+	// NOTE: set when the pool is destroyed, buffers that are still used are freed when they come back
+	bool closed {false};
+
+	void trim() {
+		for (auto& [size, buffers] : buckets) {
+			for (void* buffer : buffers) alignedFree(buffer);
+		}
+		buckets.clear();
+		cachedBytes = 0;
+	}
+};
+
+// deleter of pooled buffers, it keeps the state of the pool alive
+struct cdr::BitmapPool::Returner {
+	std::shared_ptr<State> state;
+	size_t size;
+
+	void operator()(uint32_t* buffer) const {
+		std::lock_guard<std::mutex> lock {state->mutex};
+		std::vector<void*>& bucket {state->buckets[size]};
+		if (state->closed || static_cast<int>(bucket.size()) >= state->maxBuffersPerSize) {
+			alignedFree(buffer);
+			return;
+		}
+		bucket.push_back(buffer);
+		state->cachedBytes += size;
+	}
+};
+
+cdr::BitmapPool::BitmapPool(int maxBuffersPerSize) : state{std::make_shared<State>()} {
+	state->maxBuffersPerSize = maxBuffersPerSize;
+}
+cdr::BitmapPool::~BitmapPool() {
+	std::lock_guard<std::mutex> lock {state->mutex};
+	state->trim();
+	state->closed = true;
+}
+
+std::shared_ptr<uint32_t> cdr::BitmapPool::Allocate(size_t count) {
+	return allocate(state, count);
+}
+std::shared_ptr<uint32_t> cdr::BitmapPool::allocate(const std::shared_ptr<State>& state, size_t count) {
+	const size_t size {bucketSize(count)};
+	void* buffer {nullptr};
+	{
+		std::lock_guard<std::mutex> lock {state->mutex};
+		auto bucket {state->buckets.find(size)};
+		if (bucket != state->buckets.end() && !bucket->second.empty()) {
+			buffer = bucket->second.back();
+			bucket->second.pop_back();
+			state->cachedBytes -= size;
+		}
+	}
+	if (!buffer) buffer = alignedAllocate(size);
+	return std::shared_ptr<uint32_t>(static_cast<uint32_t*>(buffer), Returner{state, size});
+}
+void cdr::BitmapPool::Trim() {
+	std::lock_guard<std::mutex> lock {state->mutex};
+	state->trim();
+}
+
+size_t cdr::BitmapPool::GetCachedBytes() const {
+	std::lock_guard<std::mutex> lock {state->mutex};
+	return state->cachedBytes;
+}
+
+std::shared_ptr<uint32_t> cdr::BitmapPool::AllocateUnpooled(size_t count) {
+	return std::shared_ptr<uint32_t>(static_cast<uint32_t*>(alignedAllocate(bucketSize(count))), [](uint32_t* buffer) { alignedFree(buffer); });
+}
+std::shared_ptr<uint32_t> cdr::BitmapPool::AllocateLike(const std::shared_ptr<uint32_t>& buffer, size_t count) {
+	if (const Returner* returner {std::get_deleter<Returner>(buffer)}) {
+		return allocate(returner->state, count);
+	}
+	return AllocateUnpooled(count);
+}
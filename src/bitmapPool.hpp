@@ -0,0 +1,57 @@
+/********************************
+ * Project: Cidr				*
+ * File: bitmapPool.hpp			*
+ * Date: 18.10.2026				*
+ ********************************/
+
+#ifndef CIDR_BITMAP_POOL_HPP
+#define CIDR_BITMAP_POOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace cdr {
+
+// NOTE: Recycles pixel buffers of bitmaps. When the last bitmap using a buffer of the pool is destroyed the buffer
+// is kept and handed to the next bitmap of the same size, so a pipeline that creates and destroys a lot of frame
+// sized bitmaps stops allocating after the first frames. The buffers are bucketed by their size in bytes, rounded
+// up to Alignment, and at most maxBuffersPerSize buffers of a size are kept.
+// It's thread safe and buffers may outlive the pool, they are freed instead of being returned then
+class BitmapPool {
+public:
+	// every pixel buffer starts at a multiple of this, pooled or not, so SIMD loads of the first pixel are aligned
+	static constexpr size_t Alignment {64};
+
+	/* CONSTRUCTOR - DESTRUCTOR */
+	explicit BitmapPool(int maxBuffersPerSize = 4);
+	~BitmapPool();
+
+	BitmapPool(const BitmapPool& other) = delete;
+	BitmapPool& operator=(const BitmapPool& other) = delete;
+
+	// a buffer of count pixels (not cleared), it goes back to the pool when the last shared_ptr to it is gone
+	std::shared_ptr<uint32_t> Allocate(size_t count);
+	// frees every buffer that waits to be reused
+	void Trim();
+
+	/* GETTERS */
+	// bytes of the buffers that wait to be reused
+	size_t GetCachedBytes() const;
+
+	// an aligned buffer that doesn't belong to a pool
+	static std::shared_ptr<uint32_t> AllocateUnpooled(size_t count);
+	// a buffer from the pool buffer came from (or an unpooled one), used when a copy on write bitmap is copied
+	static std::shared_ptr<uint32_t> AllocateLike(const std::shared_ptr<uint32_t>& buffer, size_t count);
+
+private:
+	struct State;
+	struct Returner;
+	std::shared_ptr<State> state;
+
+	static std::shared_ptr<uint32_t> allocate(const std::shared_ptr<State>& state, size_t count);
+};
+
+}
+
+#endif
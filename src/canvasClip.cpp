@@ -0,0 +1,20 @@
+/********************************
+ * Project: Cidr				*
+ * File: canvasClip.cpp			*
+ * Date: 18.10.2026				*
+ ********************************/
+
+#include "canvasClip.hpp"
+#include <stdexcept>
+
+void cdr::CanvasClip::PushClip(const Rectangle& rectangle) {
+	clipStack.push_back(clip);
+	clip = clipRectangle(rectangle);
+}
+void cdr::CanvasClip::PopClip() {
+	if (clipStack.empty()) {
+		throw std::runtime_error("Cidr: PopClip called without a matching PushClip");
+	}
+	clip = clipStack.back();
+	clipStack.pop_back();
+}
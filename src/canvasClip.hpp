@@ -0,0 +1,86 @@
+/********************************
+ * Project: Cidr				*
+ * File: canvasClip.hpp			*
+ * Date: 18.10.2026				*
+ ********************************/
+
+#ifndef CIDR_CANVAS_CLIP_HPP
+#define CIDR_CANVAS_CLIP_HPP
+
+#include "rectangle.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace cdr {
+
+// NOTE: The clip rectangle stack Renderer and FormatRenderer share, nothing outside of the clip is ever written.
+// It also has the clipping both of them do before writing pixels, so it behaves the same in every pixel format
+class CanvasClip {
+public:
+	CanvasClip(int width, int height) : clip{0, 0, width, height} {}
+
+	// NOTE: nothing outside of the clip rectangle is drawn. PushClip intersects the rectangle with the
+	// current clip (so a pushed clip can only get smaller) and PopClip goes back to the previous one.
+	// Every primitive intersects its bounds with the clip once and then only walks the visible part
+	void PushClip(const Rectangle& rectangle);
+	void PopClip();
+	inline const Rectangle& GetClip() const { return clip; }
+	inline int GetClipDepth() const { return static_cast<int>(clipStack.size()); }
+
+protected:
+	// NOTE: by default the clip covers the whole canvas.
+	// The command list uses it to restrict a copy of the renderer to a single tile
+	Rectangle clip;
+	// the clip rectangles PopClip goes back to
+	std::vector<Rectangle> clipStack;
+
+	inline bool isInClip(int x, int y) const {
+		return x >= clip.x && y >= clip.y && x < clip.x + clip.width && y < clip.y + clip.height;
+	}
+	// returns the part of the rectangle that lies inside of the clip rectangle (width or height are 0 if there is none)
+	inline Rectangle clipRectangle(const Rectangle& rectangle) const {
+		int left = std::max(rectangle.x, clip.x);
+		int top = std::max(rectangle.y, clip.y);
+		int right = std::min(rectangle.x + rectangle.width, clip.x + clip.width);
+		int bottom = std::min(rectangle.y + rectangle.height, clip.y + clip.height);
+		return Rectangle{left, top, std::max(0, right - left), std::max(0, bottom - top)};
+	}
+	// limits the scan line from startX to endX (inclusive) to the clip, false if nothing of it is visible
+	inline bool clipScanLine(int& startX, int& endX, int y) const {
+		if (y < clip.y || y >= clip.y + clip.height) return false;
+		startX = std::max(startX, clip.x);
+		endX = std::min(endX, clip.x + clip.width - 1);
+		return startX <= endX;
+	}
+	// calls scanLine(startX, endX, y) for the top and bottom row (unclipped) and pixel(x, y) for the visible pixels
+	// of the left and right column in between, so every pixel of the outline is drawn once
+	template <typename ScanLineFunction, typename PixelFunction>
+	void rasterizeOutline(const Rectangle& rectangle, ScanLineFunction&& scanLine, PixelFunction&& pixel) const;
+};
+
+template <typename ScanLineFunction, typename PixelFunction>
+void CanvasClip::rasterizeOutline(const Rectangle& rectangle, ScanLineFunction&& scanLine, PixelFunction&& pixel) const {
+	if (rectangle.width <= 0 || rectangle.height <= 0) return;
+	Rectangle visible {clipRectangle(rectangle)};
+	if (visible.width <= 0 || visible.height <= 0) return;
+
+	// NOTE: the top and bottom rows include the corners
+	int right {rectangle.x + rectangle.width - 1};
+	int bottom {rectangle.y + rectangle.height - 1};
+	scanLine(rectangle.x, right, rectangle.y);
+	if (bottom != rectangle.y) {
+		scanLine(rectangle.x, right, bottom);
+	}
+	int top {std::max(rectangle.y + 1, visible.y)};
+	int end {std::min(bottom - 1, visible.y + visible.height - 1)};
+	bool leftVisible {rectangle.x >= visible.x};
+	bool rightVisible {right != rectangle.x && right < visible.x + visible.width};
+	for (int y = top; y <= end; y++) {
+		if (leftVisible) pixel(rectangle.x, y);
+		if (rightVisible) pixel(right, y);
+	}
+}
+
+}
+
+#endif
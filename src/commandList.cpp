@@ -0,0 +1,415 @@
+/********************************
+ * Project: Cidr				*
+ * File: commandList.cpp		*
+ * Date: 17.10.2026				*
+ ********************************/
+
+#include "commandList.hpp"
+#include "rasterizer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <mutex>
+
+cdr::CommandList::CommandList(int threadCount, int tileSize)
+	: tileSize{std::max(8, tileSize)}, workers{threadCount} {
+	threadRenderers.reserve(workers.GetThreadCount());
+	for (int i = 0; i < workers.GetThreadCount(); i++) {
+		threadRenderers.emplace_back(nullptr, 0, 0);
+	}
+}
+
+/* RECORDING */
+
+cdr::CommandList::Command& cdr::CommandList::record(CommandType type, Rectangle bounds) {
+	Command& command = commands.emplace_back();
+	command.type = type;
+	command.bounds = bounds;
+	command.radius = 0;
+	command.radiusY = 0;
+	command.AA = false;
+	command.GC = false;
+	command.bitmap = BitmapView{};
+	command.shader = nullptr;
+	command.textIndex = -1;
+	command.pointIndex = 0;
+	command.pointCount = 0;
+	return command;
+}
+
+void cdr::CommandList::Clear(const RGBA& color) {
+	Command& command = record(CommandType::Clear, Rectangle{INT_MIN / 2, INT_MIN / 2, INT_MAX, INT_MAX});
+	command.colors[0] = color;
+}
+void cdr::CommandList::DrawLine(const RGBA& color, const Point& start, const Point& end, bool AA, bool GC) {
+	Command& command = record(CommandType::DrawLine, boundsOf(std::min(start.x, end.x), std::min(start.y, end.y), std::max(start.x, end.x), std::max(start.y, end.y), 1));
+	command.colors[0] = color;
+	command.points[0] = start;
+	command.points[1] = end;
+	command.AA = AA;
+	command.GC = GC;
+}
+void cdr::CommandList::DrawRectangle(const RGBA& color, Rectangle rectangle) {
+	Command& command = record(CommandType::DrawRectangle, rectangle);
+	command.colors[0] = color;
+	command.points[0] = FPoint(rectangle.x, rectangle.y);
+	command.points[1] = FPoint(rectangle.width, rectangle.height);
+}
+void cdr::CommandList::FillRectangle(const RGBA& color, Rectangle rectangle) {
+	Command& command = record(CommandType::FillRectangle, rectangle);
+	command.colors[0] = color;
+	command.points[0] = FPoint(rectangle.x, rectangle.y);
+	command.points[1] = FPoint(rectangle.width, rectangle.height);
+}
+void cdr::CommandList::FillRectangle(RGBA (*shader)(const Renderer& renderer, int x, int y), Rectangle rectangle) {
+	Command& command = record(CommandType::FillRectangleShader, rectangle);
+	command.shader = shader;
+	command.points[0] = FPoint(rectangle.x, rectangle.y);
+	command.points[1] = FPoint(rectangle.width, rectangle.height);
+}
+void cdr::CommandList::DrawCircle(const RGBA& color, const Point& centreLocation, int radius, bool AA) {
+	Command& command = record(CommandType::DrawCircle, boundsOf(centreLocation.x - radius, centreLocation.y - radius, centreLocation.x + radius, centreLocation.y + radius, 1));
+	command.colors[0] = color;
+	command.points[0] = centreLocation;
+	command.radius = radius;
+	command.AA = AA;
+}
+void cdr::CommandList::FillCircle(const RGBA& color, const Point& centreLocation, int radius, bool AA) {
+	Command& command = record(CommandType::FillCircle, boundsOf(centreLocation.x - radius, centreLocation.y - radius, centreLocation.x + radius, centreLocation.y + radius, 1));
+	command.colors[0] = color;
+	command.points[0] = centreLocation;
+	command.radius = radius;
+	command.AA = AA;
+}
+void cdr::CommandList::FillCircle(RGBA (*shader)(const Renderer& renderer, int x, int y), const Point& centreLocation, int radius, bool AA) {
+	Command& command = record(CommandType::FillCircleShader, boundsOf(centreLocation.x - radius, centreLocation.y - radius, centreLocation.x + radius, centreLocation.y + radius, 1));
+	command.shader = shader;
+	command.points[0] = centreLocation;
+	command.radius = radius;
+	command.AA = AA;
+}
+void cdr::CommandList::DrawEllipse(const RGBA& color, const Point& centreLocation, int radiusX, int radiusY, bool AA) {
+	Command& command = record(CommandType::DrawEllipse, boundsOf(centreLocation.x - radiusX, centreLocation.y - radiusY, centreLocation.x + radiusX, centreLocation.y + radiusY, 1));
+	command.colors[0] = color;
+	command.points[0] = centreLocation;
+	command.radius = radiusX;
+	command.radiusY = radiusY;
+	command.AA = AA;
+}
+void cdr::CommandList::FillEllipse(const RGBA& color, const Point& centreLocation, int radiusX, int radiusY, bool AA) {
+	Command& command = record(CommandType::FillEllipse, boundsOf(centreLocation.x - radiusX, centreLocation.y - radiusY, centreLocation.x + radiusX, centreLocation.y + radiusY, 1));
+	command.colors[0] = color;
+	command.points[0] = centreLocation;
+	command.radius = radiusX;
+	command.radiusY = radiusY;
+	command.AA = AA;
+}
+void cdr::CommandList::DrawTriangle(const RGBA& color, const Point& p1, const Point& p2, const Point& p3, bool AA, bool GC) {
+	Command& command = record(CommandType::DrawTriangle, boundsOf(
+		std::min({p1.x, p2.x, p3.x}), std::min({p1.y, p2.y, p3.y}),
+		std::max({p1.x, p2.x, p3.x}), std::max({p1.y, p2.y, p3.y}), 1));
+	command.colors[0] = color;
+	command.points[0] = p1;
+	command.points[1] = p2;
+	command.points[2] = p3;
+	command.AA = AA;
+	command.GC = GC;
+}
+void cdr::CommandList::FillTriangle(const RGBA& color, Point p1, Point p2, Point p3, bool AA) {
+	Command& command = record(CommandType::FillTriangle, boundsOf(
+		std::min({p1.x, p2.x, p3.x}), std::min({p1.y, p2.y, p3.y}),
+		std::max({p1.x, p2.x, p3.x}), std::max({p1.y, p2.y, p3.y}), 1));
+	command.colors[0] = color;
+	command.points[0] = p1;
+	command.points[1] = p2;
+	command.points[2] = p3;
+	command.AA = AA;
+}
+void cdr::CommandList::FillTriangle(RGBA color1, RGBA color2, RGBA color3, Point p1, Point p2, Point p3) {
+	Command& command = record(CommandType::FillTriangleGradient, boundsOf(
+		std::min({p1.x, p2.x, p3.x}), std::min({p1.y, p2.y, p3.y}),
+		std::max({p1.x, p2.x, p3.x}), std::max({p1.y, p2.y, p3.y}), 1));
+	command.colors[0] = color1;
+	command.colors[1] = color2;
+	command.colors[2] = color3;
+	command.points[0] = p1;
+	command.points[1] = p2;
+	command.points[2] = p3;
+}
+void cdr::CommandList::FillTriangle(RGBA (*shader)(const Renderer& renderer, int x, int y), Point p1, Point p2, Point p3) {
+	Command& command = record(CommandType::FillTriangleShader, boundsOf(
+		std::min({p1.x, p2.x, p3.x}), std::min({p1.y, p2.y, p3.y}),
+		std::max({p1.x, p2.x, p3.x}), std::max({p1.y, p2.y, p3.y}), 1));
+	command.shader = shader;
+	command.points[0] = p1;
+	command.points[1] = p2;
+	command.points[2] = p3;
+}
+void cdr::CommandList::FillPolygon(const RGBA& color, const FPoint* points, int count, bool AA) {
+	if (count < 3) return;
+	float minX = points[0].x;
+	float minY = points[0].y;
+	float maxX = points[0].x;
+	float maxY = points[0].y;
+	for (int i = 0; i < count; i++) {
+		// NOTE: the renderer skips polygons with invalid points, they don't need to be recorded
+		if (!std::isfinite(points[i].x) || !std::isfinite(points[i].y)) return;
+		minX = std::min(minX, points[i].x);
+		minY = std::min(minY, points[i].y);
+		maxX = std::max(maxX, points[i].x);
+		maxY = std::max(maxY, points[i].y);
+	}
+	auto clamp = [](float value) { return std::clamp(value, -CoverageRasterizer::guardBand, CoverageRasterizer::guardBand); };
+	Command& command = record(CommandType::FillPolygon, boundsOf(clamp(minX), clamp(minY), clamp(maxX), clamp(maxY), 1));
+	command.colors[0] = color;
+	command.AA = AA;
+	command.pointIndex = static_cast<int>(polygonPoints.size());
+	command.pointCount = count;
+	polygonPoints.insert(polygonPoints.end(), points, points + count);
+}
+void cdr::CommandList::FillRoundedRectangle(const RGBA& color, Rectangle rectangle, int radius, bool AA) {
+	Command& command = record(CommandType::FillRoundedRectangle, rectangle);
+	command.colors[0] = color;
+	command.points[0] = FPoint(rectangle.x, rectangle.y);
+	command.points[1] = FPoint(rectangle.width, rectangle.height);
+	command.radius = radius;
+	command.AA = AA;
+}
+void cdr::CommandList::DrawBitmap(const BitmapView& bitmap, float destX, float destY, int destWidth, int destHeight, float srcX, float srcY, int srcWidth, int srcHeight) {
+	Command& command = record(CommandType::DrawBitmap, boundsOf(destX, destY, destX + destWidth, destY + destHeight, 1));
+	command.bitmap = bitmap;
+	command.points[0] = FPoint(destX, destY);
+	command.points[1] = FPoint(destWidth, destHeight);
+	command.points[2] = FPoint(srcX, srcY);
+	command.points[3] = FPoint(srcWidth, srcHeight);
+}
+void cdr::CommandList::DrawTriangle(const BitmapView& texture, FPoint tp1, FPoint tp2, FPoint tp3, FPoint p1, FPoint p2, FPoint p3) {
+	Command& command = record(CommandType::DrawTexturedTriangle, boundsOf(
+		std::min({p1.x, p2.x, p3.x}), std::min({p1.y, p2.y, p3.y}),
+		std::max({p1.x, p2.x, p3.x}), std::max({p1.y, p2.y, p3.y}), 1));
+	command.bitmap = texture;
+	command.points[0] = tp1;
+	command.points[1] = tp2;
+	command.points[2] = tp3;
+	command.points[3] = p1;
+	command.points[4] = p2;
+	command.points[5] = p3;
+}
+void cdr::CommandList::DrawText(const std::string_view text, int x, int y, const TextStyle& ts) {
+	// NOTE: the exact size depends on alignment, kerning and tabs, so the bounds are a generous
+	// box: the widest line in each direction (alignment can move the text at most by its size)
+	int lineCount = 1;
+	int lineWidth = 0;
+	int maxLineWidth = 0;
+	for (const auto& letter : text) {
+		if (letter == '\n') {
+			lineCount++;
+			lineWidth = 0;
+		} else if (letter == '\t') {
+			lineWidth += 4 * ts.font->GetFontWidth();
+		} else {
+			lineWidth += ts.font->GetFontWidth();
+		}
+		maxLineWidth = std::max(maxLineWidth, lineWidth);
+	}
+	float extentX = (maxLineWidth + std::abs(ts.shadowOffsetX) + 1) * std::max(1.f, ts.size);
+	float extentY = (lineCount * ts.font->GetFontHeight() + std::abs(ts.shadowOffsetY) + 1) * std::max(1.f, ts.size);
+
+	Command& command = record(CommandType::DrawText, boundsOf(x - extentX, y - extentY, x + extentX, y + extentY, 1));
+	command.points[0] = Point{x, y};
+	command.textIndex = static_cast<int>(texts.size());
+	texts.emplace_back(text);
+	textStyles.push_back(ts);
+}
+
+/* EXECUTION */
+
+void cdr::CommandList::Reset() {
+	commands.clear();
+	texts.clear();
+	textStyles.clear();
+	polygonPoints.clear();
+}
+
+void cdr::CommandList::Execute(Renderer& renderer) {
+	int commandCount = static_cast<int>(commands.size());
+	int begin = 0;
+	while (begin < commandCount) {
+		int end = begin;
+		while (end < commandCount && !isBarrier(commands[end])) {
+			end++;
+		}
+		if (end > begin) {
+			executeTiles(renderer, begin, end);
+		}
+		if (end < commandCount) {
+			// NOTE: barriers run on the whole canvas after everything before them finished
+			replay(renderer, commands[end]);
+			end++;
+		}
+		begin = end;
+	}
+}
+
+/* GETTERS */
+
+size_t cdr::CommandList::GetHeapBlockCount() const {
+	size_t count = 0;
+	for (const Renderer& threadRenderer : threadRenderers) {
+		count += threadRenderer.frameArena.GetHeapBlockCount();
+	}
+	return count;
+}
+size_t cdr::CommandList::GetHeapBytes() const {
+	size_t bytes = 0;
+	for (const Renderer& threadRenderer : threadRenderers) {
+		bytes += threadRenderer.frameArena.GetHeapBytes();
+	}
+	return bytes;
+}
+
+void cdr::CommandList::executeTiles(Renderer& renderer, int begin, int end) {
+	Rectangle canvas {renderer.clip};
+	if (canvas.width <= 0 || canvas.height <= 0) return;
+	int tilesX = (canvas.width + tileSize - 1) / tileSize;
+	int tilesY = (canvas.height + tileSize - 1) / tileSize;
+
+	if (static_cast<int>(tileBins.size()) < tilesX * tilesY) {
+		tileBins.resize(tilesX * tilesY);
+	}
+	for (auto& bin : tileBins) {
+		bin.clear();
+	}
+
+	// bin the commands into every tile their bounds overlap
+	for (int i = begin; i < end; i++) {
+		Rectangle bounds {renderer.clipRectangle(commands[i].bounds)};
+		if (bounds.width <= 0 || bounds.height <= 0) continue;
+		// NOTE: the damage is the bounds of the commands, the tiles don't track any
+		renderer.addDamage(bounds);
+
+		int tx0 = (bounds.x - canvas.x) / tileSize;
+		int ty0 = (bounds.y - canvas.y) / tileSize;
+		int tx1 = (bounds.x + bounds.width - 1 - canvas.x) / tileSize;
+		int ty1 = (bounds.y + bounds.height - 1 - canvas.y) / tileSize;
+		for (int ty = ty0; ty <= ty1; ty++) {
+			for (int tx = tx0; tx <= tx1; tx++) {
+				tileBins[tx + ty * tilesX].push_back(i);
+			}
+		}
+	}
+
+	// NOTE: there is one job per thread, each job takes the next tile until all of them are drawn
+	std::atomic<int> nextTile {0};
+	int tileCount = tilesX * tilesY;
+#ifdef CIDR_STATS
+	// NOTE: every thread counts into its own renderer, they are added up when the thread is done
+	std::mutex statsMutex;
+#endif
+	workers.ParallelFor(static_cast<int>(threadRenderers.size()), [&](int thread) {
+		Renderer& tileRenderer = threadRenderers[thread];
+		tileRenderer.copySettings(renderer);
+		tileRenderer.frameArena.Reset();
+#ifdef CIDR_STATS
+		tileRenderer.stats.Reset();
+#endif
+		for (int tile = nextTile++; tile < tileCount; tile = nextTile++) {
+			const std::vector<int>& bin = tileBins[tile];
+			if (bin.empty()) continue;
+
+			tileRenderer.clip = renderer.clipRectangle(Rectangle{
+				canvas.x + (tile % tilesX) * tileSize,
+				canvas.y + (tile / tilesX) * tileSize,
+				tileSize, tileSize});
+			for (int index : bin) {
+				replay(tileRenderer, commands[index]);
+			}
+		}
+#ifdef CIDR_STATS
+		if (renderer.collectStats) {
+			std::lock_guard<std::mutex> lock {statsMutex};
+			renderer.stats += tileRenderer.stats;
+		}
+#endif
+	});
+}
+
+void cdr::CommandList::replay(Renderer& renderer, const Command& command) const {
+	const FPoint* p = command.points;
+	switch (command.type) {
+		case CommandType::Clear:
+			renderer.Clear(command.colors[0]);
+			break;
+		case CommandType::DrawLine:
+			renderer.DrawLine(command.colors[0], Point(p[0]), Point(p[1]), command.AA, command.GC);
+			break;
+		case CommandType::DrawRectangle:
+			renderer.DrawRectangle(command.colors[0], Rectangle{(int)p[0].x, (int)p[0].y, (int)p[1].x, (int)p[1].y});
+			break;
+		case CommandType::FillRectangle:
+			renderer.FillRectangle(command.colors[0], Rectangle{(int)p[0].x, (int)p[0].y, (int)p[1].x, (int)p[1].y});
+			break;
+		case CommandType::FillRectangleShader:
+			renderer.FillRectangle(command.shader, Rectangle{(int)p[0].x, (int)p[0].y, (int)p[1].x, (int)p[1].y});
+			break;
+		case CommandType::DrawCircle:
+			renderer.DrawCircle(command.colors[0], Point(p[0]), command.radius, command.AA);
+			break;
+		case CommandType::FillCircle:
+			renderer.FillCircle(command.colors[0], Point(p[0]), command.radius, command.AA);
+			break;
+		case CommandType::FillCircleShader:
+			renderer.FillCircle(command.shader, Point(p[0]), command.radius, command.AA);
+			break;
+		case CommandType::DrawEllipse:
+			renderer.DrawEllipse(command.colors[0], Point(p[0]), command.radius, command.radiusY, command.AA);
+			break;
+		case CommandType::FillEllipse:
+			renderer.FillEllipse(command.colors[0], Point(p[0]), command.radius, command.radiusY, command.AA);
+			break;
+		case CommandType::DrawTriangle:
+			renderer.DrawTriangle(command.colors[0], Point(p[0]), Point(p[1]), Point(p[2]), command.AA, command.GC);
+			break;
+		case CommandType::FillTriangle:
+			renderer.FillTriangle(command.colors[0], Point(p[0]), Point(p[1]), Point(p[2]), command.AA);
+			break;
+		case CommandType::FillTriangleGradient:
+			renderer.FillTriangle(command.colors[0], command.colors[1], command.colors[2], Point(p[0]), Point(p[1]), Point(p[2]));
+			break;
+		case CommandType::FillTriangleShader:
+			renderer.FillTriangle(command.shader, Point(p[0]), Point(p[1]), Point(p[2]));
+			break;
+		case CommandType::FillPolygon:
+			renderer.FillPolygon(command.colors[0], polygonPoints.data() + command.pointIndex, command.pointCount, command.AA);
+			break;
+		case CommandType::FillRoundedRectangle:
+			renderer.FillRoundedRectangle(command.colors[0], Rectangle{(int)p[0].x, (int)p[0].y, (int)p[1].x, (int)p[1].y}, command.radius, command.AA);
+			break;
+		case CommandType::DrawBitmap:
+			renderer.DrawBitmap(command.bitmap, p[0].x, p[0].y, (int)p[1].x, (int)p[1].y, p[2].x, p[2].y, (int)p[3].x, (int)p[3].y);
+			break;
+		case CommandType::DrawTexturedTriangle:
+			renderer.DrawTriangle(command.bitmap, p[0], p[1], p[2], p[3], p[4], p[5]);
+			break;
+		case CommandType::DrawText:
+			renderer.DrawText(texts[command.textIndex], (int)p[0].x, (int)p[0].y, textStyles[command.textIndex]);
+			break;
+	}
+}
+
+/* UTILITY FUNCTIONS */
+
+bool cdr::CommandList::isBarrier(const Command& command) {
+	return command.type == CommandType::FillRectangleShader ||
+		command.type == CommandType::FillCircleShader ||
+		command.type == CommandType::FillTriangleShader;
+}
+
+cdr::Rectangle cdr::CommandList::boundsOf(float minX, float minY, float maxX, float maxY, int padding) {
+	int left = static_cast<int>(std::floor(minX)) - padding;
+	int top = static_cast<int>(std::floor(minY)) - padding;
+	int right = static_cast<int>(std::ceil(maxX)) + padding + 1;
+	int bottom = static_cast<int>(std::ceil(maxY)) + padding + 1;
+	return Rectangle{left, top, right - left, bottom - top};
+}
@@ -0,0 +1,153 @@
+/********************************
+ * Project: Cidr				*
+ * File: commandList.hpp		*
+ * Date: 17.10.2026				*
+ ********************************/
+
+#ifndef CIDR_COMMAND_LIST_HPP
+#define CIDR_COMMAND_LIST_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "renderer.hpp"
+#include "threadPool.hpp"
+
+namespace cdr {
+
+// NOTE: Records draw calls instead of rasterizing them right away. On Execute the
+// recorded calls are binned into screen tiles and the tiles are rasterized in
+// parallel, every tile replays its calls in the order they were recorded.
+// Shader calls can read any pixel of the canvas, so they act as a barrier:
+// everything recorded before them is finished first and the shader itself runs
+// on the calling thread.
+// Bitmaps, fonts and shaders are referenced, not copied, and have to stay alive until Execute returns.
+// Renderer settings (alpha blending, ScaleType, OutOfBoundsType...) are taken from the renderer passed to Execute.
+class CommandList {
+public:
+	/* CONSTRUCTOR - DESTRUCTOR */
+	// threadCount <= 0 uses all hardware threads
+	explicit CommandList(int threadCount = 0, int tileSize = 64);
+
+	/* RECORDING */
+	void Clear(const RGBA& color);
+	void DrawLine(const RGBA& color, const Point& start, const Point& end, bool AA = false, bool GC = false);
+	void DrawRectangle(const RGBA& color, Rectangle rectangle);
+	void FillRectangle(const RGBA& color, Rectangle rectangle);
+	void FillRectangle(RGBA (*shader)(const Renderer& renderer, int x, int y), Rectangle rectangle);
+	void DrawCircle(const RGBA& color, const Point& centreLocation, int radius, bool AA = false);
+	void FillCircle(const RGBA& color, const Point& centreLocation, int radius, bool AA = false);
+	void FillCircle(RGBA (*shader)(const Renderer& renderer, int x, int y), const Point& centreLocation, int radius, bool AA = false);
+	void DrawEllipse(const RGBA& color, const Point& centreLocation, int radiusX, int radiusY, bool AA = false);
+	void FillEllipse(const RGBA& color, const Point& centreLocation, int radiusX, int radiusY, bool AA = false);
+	void DrawTriangle(const RGBA& color, const Point& p1, const Point& p2, const Point& p3, bool AA = false, bool GC = false);
+	void FillTriangle(const RGBA& color, Point p1, Point p2, Point p3, bool AA = false);
+	void FillTriangle(RGBA color1, RGBA color2, RGBA color3, Point p1, Point p2, Point p3);
+	void FillTriangle(RGBA (*shader)(const Renderer& renderer, int x, int y), Point p1, Point p2, Point p3);
+	// NOTE: the points are copied
+	void FillPolygon(const RGBA& color, const FPoint* points, int count, bool AA = false);
+	void FillRoundedRectangle(const RGBA& color, Rectangle rectangle, int radius, bool AA = false);
+	void DrawBitmap(const BitmapView& bitmap, float destX, float destY, int destWidth, int destHeight, float srcX, float srcY, int srcWidth, int srcHeight);
+	void DrawTriangle(const BitmapView& texture, FPoint tp1, FPoint tp2, FPoint tp3, FPoint p1, FPoint p2, FPoint p3);
+	void DrawText(const std::string_view text, int x, int y, const TextStyle& ts = DefaultTextStyle);
+
+	/* RECORDING OVERLOADS */
+	inline void Clear(uint32_t color) { Clear(RGBA{color}); }
+	inline void DrawLine(const RGBA& color, int x1, int y1, int x2, int y2, bool AA = false, bool GC = false) { DrawLine(color, Point{x1, y1}, Point{x2, y2}, AA, GC); }
+	inline void DrawRectangle(const RGBA& color, int x, int y, int width, int height) { DrawRectangle(color, Rectangle{x, y, width, height}); }
+	inline void FillRectangle(const RGBA& color, int x, int y, int width, int height) { FillRectangle(color, Rectangle{x, y, width, height}); }
+	inline void FillRectangle(RGBA (*shader)(const Renderer& renderer, int x, int y), int x, int y, int width, int height) { FillRectangle(shader, Rectangle{x, y, width, height}); }
+	inline void DrawCircle(const RGBA& color, int centreX, int centreY, int radius, bool AA = false) { DrawCircle(color, Point{centreX, centreY}, radius, AA); }
+	inline void FillCircle(const RGBA& color, int centreX, int centreY, int radius, bool AA = false) { FillCircle(color, Point{centreX, centreY}, radius, AA); }
+	inline void FillCircle(RGBA (*shader)(const Renderer& renderer, int x, int y), int centreX, int centreY, int radius, bool AA = false) { FillCircle(shader, Point{centreX, centreY}, radius, AA); }
+	inline void DrawEllipse(const RGBA& color, int centreX, int centreY, int radiusX, int radiusY, bool AA = false) { DrawEllipse(color, Point{centreX, centreY}, radiusX, radiusY, AA); }
+	inline void FillEllipse(const RGBA& color, int centreX, int centreY, int radiusX, int radiusY, bool AA = false) { FillEllipse(color, Point{centreX, centreY}, radiusX, radiusY, AA); }
+	inline void DrawTriangle(const RGBA& color, int x1, int y1, int x2, int y2, int x3, int y3, bool AA = false, bool GC = false) { DrawTriangle(color, Point{x1, y1}, Point{x2, y2}, Point{x3, y3}, AA, GC); }
+	inline void FillTriangle(const RGBA& color, int x1, int y1, int x2, int y2, int x3, int y3, bool AA = false) { FillTriangle(color, Point{x1, y1}, Point{x2, y2}, Point{x3, y3}, AA); }
+	inline void FillTriangle(RGBA color1, RGBA color2, RGBA color3, int x1, int y1, int x2, int y2, int x3, int y3) { FillTriangle(color1, color2, color3, Point{x1, y1}, Point{x2, y2}, Point{x3, y3}); }
+	inline void FillTriangle(RGBA (*shader)(const Renderer& renderer, int x, int y), int x1, int y1, int x2, int y2, int x3, int y3) { FillTriangle(shader, Point{x1, y1}, Point{x2, y2}, Point{x3, y3}); }
+	inline void FillPolygon(const RGBA& color, const std::vector<FPoint>& points, bool AA = false) { FillPolygon(color, points.data(), static_cast<int>(points.size()), AA); }
+	inline void FillRoundedRectangle(const RGBA& color, int x, int y, int width, int height, int radius, bool AA = false) { FillRoundedRectangle(color, Rectangle{x, y, width, height}, radius, AA); }
+	inline void DrawBitmap(const BitmapView& bitmap, FRectangle destRect, FRectangle srcRect) { DrawBitmap(bitmap, destRect.x, destRect.y, destRect.width, destRect.height, srcRect.x, srcRect.y, srcRect.width, srcRect.height); }
+
+	/* EXECUTION */
+	// Rasterizes every recorded call into the renderer, the recorded calls are kept
+	void Execute(Renderer& renderer);
+	// Removes all recorded calls (the allocated memory is kept for the next frame)
+	void Reset();
+
+	/* GETTERS */
+	inline int GetCommandCount() const { return static_cast<int>(commands.size()); }
+	inline int GetTileSize() const { return tileSize; }
+	inline int GetThreadCount() const { return workers.GetThreadCount(); }
+	// NOTE: every thread draws its tiles with its own renderer and arena, kept between frames.
+	// These add up the heap blocks and bytes of those arenas (see FrameArena::GetHeapBlockCount)
+	size_t GetHeapBlockCount() const;
+	size_t GetHeapBytes() const;
+
+private:
+	enum class CommandType {
+		Clear,
+		DrawLine,
+		DrawRectangle,
+		FillRectangle,
+		FillRectangleShader,
+		DrawCircle,
+		FillCircle,
+		FillCircleShader,
+		DrawEllipse,
+		FillEllipse,
+		DrawTriangle,
+		FillTriangle,
+		FillTriangleGradient,
+		FillTriangleShader,
+		FillPolygon,
+		FillRoundedRectangle,
+		DrawBitmap,
+		DrawTexturedTriangle,
+		DrawText,
+	};
+
+	struct Command {
+		CommandType type;
+		// NOTE: area of the canvas the command may touch, used for binning
+		Rectangle bounds;
+		RGBA colors[3];
+		FPoint points[6];
+		// NOTE: ellipses keep their radiusX in radius
+		int radius;
+		int radiusY;
+		bool AA;
+		bool GC;
+		BitmapView bitmap;
+		RGBA (*shader)(const Renderer& renderer, int x, int y);
+		int textIndex;
+		// NOTE: polygons keep pointCount points in polygonPoints starting at pointIndex
+		int pointIndex;
+		int pointCount;
+	};
+
+	int tileSize;
+	ThreadPool workers;
+	std::vector<Command> commands;
+	std::vector<std::string> texts;
+	std::vector<TextStyle> textStyles;
+	std::vector<FPoint> polygonPoints;
+	// NOTE: one list of command indices per tile, kept between frames to avoid allocations
+	std::vector<std::vector<int>> tileBins;
+	// NOTE: one renderer per thread, only allowed to write inside of the tile it is drawing
+	std::vector<Renderer> threadRenderers;
+
+private:
+	Command& record(CommandType type, Rectangle bounds);
+	void executeTiles(Renderer& renderer, int begin, int end);
+	void replay(Renderer& renderer, const Command& command) const;
+	static bool isBarrier(const Command& command);
+	static Rectangle boundsOf(float minX, float minY, float maxX, float maxY, int padding);
+};
+
+}
+
+#endif
@@ -0,0 +1,105 @@
+/********************************
+ * Project: Cidr				*
+ * File: damageRegion.cpp		*
+ * Date: 18.10.2026				*
+ ********************************/
+
+#include "damageRegion.hpp"
+#include <algorithm>
+#include <climits>
+
+namespace {
+
+int64_t areaOf(const cdr::Rectangle& rectangle) {
+	return int64_t(rectangle.width) * rectangle.height;
+}
+cdr::Rectangle unionOf(const cdr::Rectangle& a, const cdr::Rectangle& b) {
+	int left {std::min(a.x, b.x)};
+	int top {std::min(a.y, b.y)};
+	int right {std::max(a.x + a.width, b.x + b.width)};
+	int bottom {std::max(a.y + a.height, b.y + b.height)};
+	return cdr::Rectangle{left, top, right - left, bottom - top};
+}
+bool contains(const cdr::Rectangle& outer, const cdr::Rectangle& inner) {
+	return inner.x >= outer.x && inner.y >= outer.y &&
+		inner.x + inner.width <= outer.x + outer.width && inner.y + inner.height <= outer.y + outer.height;
+}
+
+}
+
+void cdr::DamageRegion::Add(const Rectangle& rectangle) {
+	if (rectangle.width <= 0 || rectangle.height <= 0) return;
+	// NOTE: a primitive drawn by another one is usually inside of the last rectangle, so search from the back
+	for (auto it = rectangles.rbegin(); it != rectangles.rend(); ++it) {
+		if (contains(*it, rectangle)) return;
+	}
+
+	Rectangle added {rectangle};
+	bool merged {true};
+	while (merged) {
+		merged = false;
+		for (size_t i = 0; i < rectangles.size(); i++) {
+			Rectangle bounds {unionOf(rectangles[i], added)};
+			if (areaOf(bounds) <= areaOf(rectangles[i]) + areaOf(added)) {
+				// NOTE: the merged rectangle can now touch rectangles it didn't touch before, so start over
+				added = bounds;
+				rectangles.erase(rectangles.begin() + i);
+				merged = true;
+				break;
+			}
+		}
+	}
+	rectangles.erase(std::remove_if(rectangles.begin(), rectangles.end(), [&](const Rectangle& other) {
+		return contains(added, other);
+	}), rectangles.end());
+	rectangles.push_back(added);
+
+	if (static_cast<int>(rectangles.size()) > MaxRectangles) {
+		mergeClosestPair();
+	}
+}
+void cdr::DamageRegion::Add(const DamageRegion& other) {
+	for (const Rectangle& rectangle : other.rectangles) {
+		Add(rectangle);
+	}
+}
+void cdr::DamageRegion::Reset() {
+	rectangles.clear();
+}
+
+cdr::Rectangle cdr::DamageRegion::GetBounds() const {
+	if (rectangles.empty()) return Rectangle{};
+	Rectangle bounds {rectangles[0]};
+	for (const Rectangle& rectangle : rectangles) {
+		bounds = unionOf(bounds, rectangle);
+	}
+	return bounds;
+}
+int64_t cdr::DamageRegion::GetArea() const {
+	int64_t area {0};
+	for (const Rectangle& rectangle : rectangles) {
+		area += areaOf(rectangle);
+	}
+	return area;
+}
+
+void cdr::DamageRegion::mergeClosestPair() {
+	size_t bestA {0};
+	size_t bestB {1};
+	int64_t bestWaste {INT64_MAX};
+	for (size_t a = 0; a < rectangles.size(); a++) {
+		for (size_t b = a + 1; b < rectangles.size(); b++) {
+			int64_t waste {areaOf(unionOf(rectangles[a], rectangles[b])) - areaOf(rectangles[a]) - areaOf(rectangles[b])};
+			if (waste < bestWaste) {
+				bestWaste = waste;
+				bestA = a;
+				bestB = b;
+			}
+		}
+	}
+	Rectangle merged {unionOf(rectangles[bestA], rectangles[bestB])};
+	rectangles.erase(rectangles.begin() + bestB);
+	rectangles.erase(rectangles.begin() + bestA);
+	// NOTE: added again so it can swallow the rectangles inside of it
+	Add(merged);
+}
@@ -0,0 +1,44 @@
+/********************************
+ * Project: Cidr				*
+ * File: damageRegion.hpp		*
+ * Date: 18.10.2026				*
+ ********************************/
+
+#ifndef CIDR_DAMAGE_REGION_HPP
+#define CIDR_DAMAGE_REGION_HPP
+
+#include "rectangle.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace cdr {
+
+// NOTE: The part of a canvas that changed, as a short list of rectangles (see Renderer::EnableDamageTracking).
+// A rectangle is merged with another one when their bounding box isn't bigger than both of them together,
+// so touching or overlapping rectangles become one. If there are more than MaxRectangles, the two
+// rectangles whose bounding box wastes the fewest pixels are merged.
+// The rectangles can overlap each other, but no rectangle lies completely inside of another one
+class DamageRegion {
+public:
+	static constexpr int MaxRectangles {16};
+
+	void Add(const Rectangle& rectangle);
+	void Add(const DamageRegion& other);
+	void Reset();
+
+	inline bool IsEmpty() const { return rectangles.empty(); }
+	inline const std::vector<Rectangle>& GetRectangles() const { return rectangles; }
+	// bounding box of all rectangles (width and height are 0 if empty)
+	Rectangle GetBounds() const;
+	// sum of the areas of all rectangles, pixels where rectangles overlap are counted more than once
+	int64_t GetArea() const;
+
+private:
+	std::vector<Rectangle> rectangles;
+
+	void mergeClosestPair();
+};
+
+}
+
+#endif
@@ -0,0 +1,305 @@
+/********************************
+ * Project: Cidr				*
+ * File: filter.cpp				*
+ * Date: 17.10.2026				*
+ ********************************/
+
+#include "filter.hpp"
+#include "frameArena.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+using cdr::FrameArena;
+
+// a block of pixels somewhere in memory, stride is the distance between two rows in pixels
+struct Image {
+	uint32_t* pixels;
+	int width;
+	int height;
+	int stride;
+};
+
+/* UTILITY FUNCTIONS */
+
+// NOTE: channels are unpacked in memory order (a, b, g, r), the order doesn't matter as long as packing uses the same
+inline void unpack(uint32_t pixel, float* out) {
+	out[0] = static_cast<float>(pixel & 0xff);
+	out[1] = static_cast<float>((pixel >> 8) & 0xff);
+	out[2] = static_cast<float>((pixel >> 16) & 0xff);
+	out[3] = static_cast<float>(pixel >> 24);
+}
+inline uint32_t packChannel(float value) {
+	return static_cast<uint32_t>(std::clamp(value + 0.5f, 0.f, 255.f));
+}
+inline uint32_t pack(const float* in) {
+	return packChannel(in[0]) | (packChannel(in[1]) << 8) | (packChannel(in[2]) << 16) | (packChannel(in[3]) << 24);
+}
+
+// dst[x * dstStride + y] = src[y * srcStride + x], done in small tiles so both sides stay in the cache
+void transpose(const uint32_t* src, int width, int height, int srcStride, uint32_t* dst, int dstStride) {
+	constexpr int tile {16};
+	for (int ty = 0; ty < height; ty += tile) {
+		int endY {std::min(ty + tile, height)};
+		for (int tx = 0; tx < width; tx += tile) {
+			int endX {std::min(tx + tile, width)};
+			for (int y = ty; y < endY; y++) {
+				for (int x = tx; x < endX; x++) {
+					dst[x * dstStride + y] = src[y * srcStride + x];
+				}
+			}
+		}
+	}
+}
+
+void copyRows(const uint32_t* src, int width, int height, int srcStride, uint32_t* dst, int dstStride) {
+	for (int y = 0; y < height; y++) {
+		memcpy(dst + y * dstStride, src + y * srcStride, width * sizeof(uint32_t));
+	}
+}
+
+// fills padded with the unpacked pixels -radius ... count + radius - 1 of the row (clamped to the edges)
+void padRow(const uint32_t* in, int count, int radius, float* padded) {
+	for (int i = -radius; i < count + radius; i++) {
+		unpack(in[std::clamp(i, 0, count - 1)], padded + (i + radius) * 4);
+	}
+}
+
+/* ROW PASSES */
+
+// out = in convolved with a kernel of size 2 * radius + 1, row and accumulator are scratch memory
+void convolveRow(const uint32_t* in, int count, const float* kernel, int radius, uint32_t* out, float* row, float* accumulator) {
+	padRow(in, count, radius, row);
+	std::fill_n(accumulator, count * 4, 0.f);
+	// NOTE: the inner loop runs over all channels of all pixels in a row, so it vectorizes well
+	for (int k = 0; k < 2 * radius + 1; k++) {
+		const float weight {kernel[k]};
+		const float* source {row + k * 4};
+		for (int i = 0; i < count * 4; i++) {
+			accumulator[i] += weight * source[i];
+		}
+	}
+	for (int i = 0; i < count; i++) {
+		out[i] = pack(accumulator + i * 4);
+	}
+}
+
+// out = average of the 2 * radius + 1 pixels around every pixel, uses a running sum so the radius doesn't matter
+void boxRow(const uint32_t* in, int count, int radius, uint32_t* out) {
+	auto add = [](uint32_t* sum, uint32_t pixel, uint32_t times) {
+		sum[0] += (pixel & 0xff) * times;
+		sum[1] += ((pixel >> 8) & 0xff) * times;
+		sum[2] += ((pixel >> 16) & 0xff) * times;
+		sum[3] += (pixel >> 24) * times;
+	};
+
+	// window of the first pixel: -radius ... 0 are all the first pixel, everything past the end is the last pixel
+	uint32_t sum[4] {};
+	add(sum, in[0], radius + 1);
+	int inside {std::min(radius, count - 1)};
+	for (int i = 1; i <= inside; i++) {
+		add(sum, in[i], 1);
+	}
+	add(sum, in[count - 1], radius - inside);
+
+	// NOTE: the average can't be bigger than 255, so no clamping is needed
+	const float scale {1.f / (2 * radius + 1)};
+	auto step = [&](int x, uint32_t entering, uint32_t leaving) {
+		out[x] = static_cast<uint32_t>(sum[0] * scale + 0.5f) |
+			(static_cast<uint32_t>(sum[1] * scale + 0.5f) << 8) |
+			(static_cast<uint32_t>(sum[2] * scale + 0.5f) << 16) |
+			(static_cast<uint32_t>(sum[3] * scale + 0.5f) << 24);
+		sum[0] += (entering & 0xff) - (leaving & 0xff);
+		sum[1] += ((entering >> 8) & 0xff) - ((leaving >> 8) & 0xff);
+		sum[2] += ((entering >> 16) & 0xff) - ((leaving >> 16) & 0xff);
+		sum[3] += (entering >> 24) - (leaving >> 24);
+	};
+	// the edges need clamped indices, the middle part (if there is one) doesn't
+	int middleStart {std::min(radius, count)};
+	int middleEnd {std::max(middleStart, count - radius - 1)};
+	auto at = [&](int i) { return in[std::clamp(i, 0, count - 1)]; };
+	for (int x = 0; x < middleStart; x++) {
+		step(x, at(x + radius + 1), at(x - radius));
+	}
+	for (int x = middleStart; x < middleEnd; x++) {
+		step(x, in[x + radius + 1], in[x - radius]);
+	}
+	for (int x = middleEnd; x < count; x++) {
+		step(x, at(x + radius + 1), at(x - radius));
+	}
+}
+
+/* FILTERS */
+
+// runs rowPass over every row and then over every column of the image.
+// rowPass(in, count, out, isVertical) must not write to in.
+// NOTE: ping-pong between two buffers: image -> A -> (rows) -> B -> (transpose) -> A -> (columns) -> B -> (transpose) -> image
+template <typename RowPass>
+void separablePasses(const Image& image, FrameArena& arena, RowPass rowPass) {
+	int count {image.width * image.height};
+	uint32_t* a {arena.Allocate<uint32_t>(count)};
+	uint32_t* b {arena.Allocate<uint32_t>(count)};
+
+	copyRows(image.pixels, image.width, image.height, image.stride, a, image.width);
+	for (int y = 0; y < image.height; y++) {
+		rowPass(a + y * image.width, image.width, b + y * image.width, false);
+	}
+	transpose(b, image.width, image.height, image.width, a, image.height);
+	for (int x = 0; x < image.width; x++) {
+		rowPass(a + x * image.height, image.height, b + x * image.height, true);
+	}
+	transpose(b, image.height, image.width, image.height, image.pixels, image.stride);
+}
+
+void separableConvolution(const Image& image, const float* kernelX, int radiusX, const float* kernelY, int radiusY, FrameArena& arena) {
+	if (image.width <= 0 || image.height <= 0) return;
+	FrameArena::Scope scratch {arena};
+	int longest {std::max(image.width, image.height)};
+	float* row {arena.Allocate<float>((longest + 2 * std::max(radiusX, radiusY)) * 4)};
+	float* accumulator {arena.Allocate<float>(longest * 4)};
+
+	separablePasses(image, arena, [&](const uint32_t* in, int count, uint32_t* out, bool vertical) {
+		if (vertical) convolveRow(in, count, kernelY, radiusY, out, row, accumulator);
+		else          convolveRow(in, count, kernelX, radiusX, out, row, accumulator);
+	});
+}
+
+void boxBlur(const Image& image, int radius, int passes, FrameArena& arena) {
+	if (image.width <= 0 || image.height <= 0 || radius <= 0 || passes <= 0) return;
+	FrameArena::Scope scratch {arena};
+	uint32_t* temp {arena.Allocate<uint32_t>(std::max(image.width, image.height))};
+
+	// NOTE: box blurs along rows and columns commute, so every pass of one direction can be done back to back
+	separablePasses(image, arena, [&](const uint32_t* in, int count, uint32_t* out, bool) {
+		boxRow(in, count, radius, out);
+		for (int pass = 1; pass < passes; pass++) {
+			memcpy(temp, out, count * sizeof(uint32_t));
+			boxRow(temp, count, radius, out);
+		}
+	});
+}
+
+void convolution(const Image& image, const float* kernel, int kernelWidth, int kernelHeight, FrameArena& arena) {
+	if (image.width <= 0 || image.height <= 0) return;
+	FrameArena::Scope scratch {arena};
+	int radiusX {kernelWidth / 2};
+	int radiusY {kernelHeight / 2};
+	int count {image.width * image.height};
+	uint32_t* source {arena.Allocate<uint32_t>(count)};
+	float* row {arena.Allocate<float>((image.width + 2 * radiusX) * 4)};
+	float* accumulator {arena.Allocate<float>(image.width * 4)};
+
+	copyRows(image.pixels, image.width, image.height, image.stride, source, image.width);
+	for (int y = 0; y < image.height; y++) {
+		std::fill_n(accumulator, image.width * 4, 0.f);
+		for (int ky = 0; ky < kernelHeight; ky++) {
+			int sourceY {std::clamp(y + ky - radiusY, 0, image.height - 1)};
+			padRow(source + sourceY * image.width, image.width, radiusX, row);
+			for (int kx = 0; kx < kernelWidth; kx++) {
+				const float weight {kernel[kx + ky * kernelWidth]};
+				if (weight == 0.f) continue;
+				const float* padded {row + kx * 4};
+				for (int i = 0; i < image.width * 4; i++) {
+					accumulator[i] += weight * padded[i];
+				}
+			}
+		}
+		uint32_t* out {image.pixels + y * image.stride};
+		for (int x = 0; x < image.width; x++) {
+			out[x] = pack(accumulator + x * 4);
+		}
+	}
+}
+
+// NOTE: pixels is the writableData of the bitmap, only the filters themselves can get it
+Image imageOf(const cdr::BaseBitmap& bitmap, uint32_t* pixels) {
+	return Image{pixels, bitmap.GetWidth(), bitmap.GetHeight(), bitmap.GetWidth()};
+}
+// NOTE: like every other write of the renderer the filter only changes the part of the region inside of the clip,
+// which is added to the damage region before it is filtered
+Image imageOf(cdr::Renderer& renderer, const cdr::Rectangle& region) {
+	const cdr::Rectangle& clip {renderer.GetClip()};
+	int left {std::max(region.x, clip.x)};
+	int top {std::max(region.y, clip.y)};
+	int right {std::min(region.x + region.width, clip.x + clip.width)};
+	int bottom {std::min(region.y + region.height, clip.y + clip.height)};
+	if (right <= left || bottom <= top) return Image{nullptr, 0, 0, 0};
+	renderer.AddDamage(cdr::Rectangle{left, top, right - left, bottom - top});
+	return Image{renderer.GetData() + left + top * renderer.GetStride(), right - left, bottom - top, renderer.GetStride()};
+}
+
+void checkKernelSize(int size) {
+	if (size <= 0 || size % 2 == 0) {
+		throw std::runtime_error("Cidr: Filter kernel size has to be odd (" + std::to_string(size) + ")");
+	}
+}
+
+}
+
+std::vector<float> cdr::Filters::GaussianKernel(float sigma) {
+	if (sigma <= 0) return std::vector<float>{1.f};
+	int radius {static_cast<int>(std::ceil(sigma * 3))};
+	std::vector<float> kernel(2 * radius + 1);
+	float total {0};
+	for (int i = -radius; i <= radius; i++) {
+		kernel[i + radius] = std::exp(-(i * i) / (2 * sigma * sigma));
+		total += kernel[i + radius];
+	}
+	for (auto& weight : kernel) {
+		weight /= total;
+	}
+	return kernel;
+}
+
+void cdr::Filters::GaussianBlur(BaseBitmap& bitmap, float sigma) {
+	if (sigma <= 0) return;
+	std::vector<float> kernel {GaussianKernel(sigma)};
+	SeparableConvolution(bitmap, kernel, kernel);
+}
+void cdr::Filters::GaussianBlur(Renderer& renderer, Rectangle region, float sigma) {
+	if (sigma <= 0) return;
+	std::vector<float> kernel {GaussianKernel(sigma)};
+	SeparableConvolution(renderer, region, kernel, kernel);
+}
+
+void cdr::Filters::BoxBlur(BaseBitmap& bitmap, int radius, int passes) {
+	FrameArena arena {};
+	boxBlur(imageOf(bitmap, bitmap.writableData()), radius, passes, arena);
+}
+void cdr::Filters::BoxBlur(Renderer& renderer, Rectangle region, int radius, int passes) {
+	boxBlur(imageOf(renderer, region), radius, passes, renderer.GetFrameArena());
+}
+
+void cdr::Filters::SeparableConvolution(BaseBitmap& bitmap, const std::vector<float>& kernelX, const std::vector<float>& kernelY) {
+	checkKernelSize(static_cast<int>(kernelX.size()));
+	checkKernelSize(static_cast<int>(kernelY.size()));
+	FrameArena arena {};
+	separableConvolution(imageOf(bitmap, bitmap.writableData()), kernelX.data(), kernelX.size() / 2, kernelY.data(), kernelY.size() / 2, arena);
+}
+void cdr::Filters::SeparableConvolution(Renderer& renderer, Rectangle region, const std::vector<float>& kernelX, const std::vector<float>& kernelY) {
+	checkKernelSize(static_cast<int>(kernelX.size()));
+	checkKernelSize(static_cast<int>(kernelY.size()));
+	separableConvolution(imageOf(renderer, region), kernelX.data(), kernelX.size() / 2, kernelY.data(), kernelY.size() / 2, renderer.GetFrameArena());
+}
+
+void cdr::Filters::Convolution(BaseBitmap& bitmap, const std::vector<float>& kernel, int kernelWidth, int kernelHeight) {
+	checkKernelSize(kernelWidth);
+	checkKernelSize(kernelHeight);
+	if (static_cast<int>(kernel.size()) != kernelWidth * kernelHeight) {
+		throw std::runtime_error("Cidr: Filter kernel has the wrong number of weights");
+	}
+	FrameArena arena {};
+	convolution(imageOf(bitmap, bitmap.writableData()), kernel.data(), kernelWidth, kernelHeight, arena);
+}
+void cdr::Filters::Convolution(Renderer& renderer, Rectangle region, const std::vector<float>& kernel, int kernelWidth, int kernelHeight) {
+	checkKernelSize(kernelWidth);
+	checkKernelSize(kernelHeight);
+	if (static_cast<int>(kernel.size()) != kernelWidth * kernelHeight) {
+		throw std::runtime_error("Cidr: Filter kernel has the wrong number of weights");
+	}
+	convolution(imageOf(renderer, region), kernel.data(), kernelWidth, kernelHeight, renderer.GetFrameArena());
+}
@@ -0,0 +1,46 @@
+/********************************
+ * Project: Cidr				*
+ * File: filter.hpp				*
+ * Date: 17.10.2026				*
+ ********************************/
+
+#ifndef CIDR_FILTER_HPP
+#define CIDR_FILTER_HPP
+
+#include <vector>
+#include "bitmap.hpp"
+#include "rectangle.hpp"
+#include "renderer.hpp"
+
+// NOTE: Image filters that work on a whole bitmap or on a region of a renderer.
+// All four channels are filtered and pixels outside of the image (or region) are treated
+// like the nearest edge pixel (clamp to edge). The result never depends on the pixels outside of the region.
+// Separable filters run every pass along rows, the vertical pass works on a transposed copy.
+// Renderer overloads take their scratch memory from the renderer's frame arena.
+namespace cdr {
+namespace Filters {
+
+// normalized gaussian kernel with a radius of ceil(3 * sigma)
+std::vector<float> GaussianKernel(float sigma);
+
+// gaussian blur, sigma <= 0 does nothing
+void GaussianBlur(BaseBitmap& bitmap, float sigma);
+void GaussianBlur(Renderer& renderer, Rectangle region, float sigma);
+
+// box blur with a (2 * radius + 1)^2 window, the cost per pixel doesn't depend on the radius.
+// 3 passes are already very close to a gaussian blur
+void BoxBlur(BaseBitmap& bitmap, int radius, int passes = 1);
+void BoxBlur(Renderer& renderer, Rectangle region, int radius, int passes = 1);
+
+// kernelX is applied to every row and kernelY to every column, both need an odd size (centre in the middle)
+void SeparableConvolution(BaseBitmap& bitmap, const std::vector<float>& kernelX, const std::vector<float>& kernelY);
+void SeparableConvolution(Renderer& renderer, Rectangle region, const std::vector<float>& kernelX, const std::vector<float>& kernelY);
+
+// arbitrary kernel stored row by row, width and height need to be odd (centre in the middle)
+void Convolution(BaseBitmap& bitmap, const std::vector<float>& kernel, int kernelWidth, int kernelHeight);
+void Convolution(Renderer& renderer, Rectangle region, const std::vector<float>& kernel, int kernelWidth, int kernelHeight);
+
+}
+}
+
+#endif
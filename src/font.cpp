@@ -7,119 +7,46 @@
 #include "font.hpp"
 
 cdr::Font::Font(const uint8_t* data, int fontSheetWidth, int fontSheetHeight, int fontWidth, int fontHeight) : 
-	fontSheet{fontSheetWidth, fontSheetHeight}, fontWidth{fontWidth}, fontHeight{fontHeight}, kernX((fontSheetWidth/fontWidth) * (fontSheetHeight/fontHeight)) {
-		
-	auto getCoordX = [](int val, int width) {
-		return val % width;
-	};
-	auto getCoordY = [](int val, int width) {
-		return val / width;
-	};
-	
-	int SIZE = fontSheetWidth*fontSheetHeight;
-	
-	for(int i = 0; i < SIZE/8; i++) {
-		uint8_t color8 = data[i];
-		for(int j = 0; j < 8; j++) {
-			uint8_t c = ((color8 >> j) & 1) * 255;
-			
-			fontSheet.SetPixel(cdr::RGBA{c, c, c, 255}, getCoordX(i*8 + j, fontSheetWidth), getCoordY(i*8 + j, fontSheetWidth));
-		}
-	}
-	
-	for (int cX = 0; cX < fontSheetWidth / fontWidth; cX++) {
-		for (int cY = 0; cY < fontSheetHeight / fontHeight; cY++) {
-			bool kernL = false;
-			bool kernLInit = false;
-			bool kernR = false;
-			bool kernRInit = false;
-			for (int xl = 0, xr = fontWidth - 1; xl < fontWidth; xl++, xr--) {
-				for (int y = cY*fontHeight; y < cY*fontHeight+fontHeight; y++) {
-					
-					kernL |= (fontSheet.GetPixel(xl + cX * fontWidth, y) == cdr::RGB::White);
-					kernR |= (fontSheet.GetPixel(xr + cX * fontWidth, y) == cdr::RGB::White);
-					
-					if (!kernLInit) {
-						kernX[cX + (cY * (fontSheet.GetWidth() / fontWidth))].first = xl - 1;
-					}
-					// if (kernL != kernLInit) {
-					// 	this->fontSheet.SetPixel(cdr::RGBA::Red, kernX[cX + cY * fontSheet.GetWidth() / fontWidth].first + cX * fontWidth, y);
-					// }
-					kernLInit |= kernL;
-					
-					if (!kernRInit) {
-						kernX[cX + cY * fontSheet.GetWidth() / fontWidth].second = xr + 1;
-					}
-					// if (kernR != kernRInit) {
-					// 	this->fontSheet.SetPixel(cdr::RGBA::Green, kernX[cX + cY * fontSheet.GetWidth() / fontWidth].second + cX * fontWidth, y);
-					// }
-					kernRInit |= kernR;
-					
-					if (kernR && kernL) {
-						goto next;
-					}
-				}
-			}
-			next:;
-		}
-	}
-	
-	// for (int cX = 0; cX < fontSheetWidth / fontWidth - 1; cX++) {
-	// 	for (int cY = 0; cY < fontSheetHeight / fontHeight; cY++) {
-	// 		for (int y = cY*fontHeight; y < cY*fontHeight+fontHeight; y++) {
-	// 			fontSheet.SetPixel(cdr::RGB::Red,   cX * fontWidth + kernX[cX + cY * fontSheetWidth / fontWidth].first,  y);
-	// 			fontSheet.SetPixel(cdr::RGB::Green, cX * fontWidth + kernX[cX + cY * fontSheetWidth / fontWidth].second, y);
-	// 		}
-	// 	}
-	// }
+	bits{data}, fontSheetWidth{fontSheetWidth}, fontSheetHeight{fontSheetHeight}, fontWidth{fontWidth}, fontHeight{fontHeight}, kerning{nullptr} {
+	computeKerning();
 }
 cdr::Font::Font(const Bitmap& fontSheet, int fontWidth, int fontHeight) : 
-	fontSheet{fontSheet}, fontWidth{fontWidth}, fontHeight{fontHeight}, kernX((fontSheet.GetWidth()/fontWidth) * (fontSheet.GetHeight()/fontHeight)) {
-	for (int cX = 0; cX < fontSheet.GetWidth() / fontWidth; cX++) {
-		for (int cY = 0; cY < fontSheet.GetHeight() / fontHeight; cY++) {
-			bool kernL = false;
-			bool kernLInit = false;
-			bool kernR = false;
-			bool kernRInit = false;
-			for (int xl = 0, xr = fontWidth - 1; xl < fontWidth; xl++, xr--) {
-				for (int y = cY*fontHeight; y < cY*fontHeight+fontHeight; y++) {
-					
-					kernL |= (fontSheet.GetPixel(xl + cX * fontWidth, y) == cdr::RGB::White);
-					kernR |= (fontSheet.GetPixel(xr + cX * fontWidth, y) == cdr::RGB::White);
-					
-					if (!kernLInit) {
-						kernX[cX + (cY * (fontSheet.GetWidth() / fontWidth))].first = xl - 1;
-					}
-					// if (kernL != kernLInit) {
-					// 	this->fontSheet.SetPixel(cdr::RGBA::Red, kernX[cX + cY * fontSheet.GetWidth() / fontWidth].first + cX * fontWidth, y);
-					// }
-					kernLInit |= kernL;
-					
-					if (!kernRInit) {
-						kernX[cX + cY * fontSheet.GetWidth() / fontWidth].second = xr + 1;
-					}
-					// if (kernR != kernRInit) {
-					// 	this->fontSheet.SetPixel(cdr::RGBA::Green, kernX[cX + cY * fontSheet.GetWidth() / fontWidth].second + cX * fontWidth, y);
-					// }
-					kernRInit |= kernR;
-					
-					if (kernR && kernL) {
-						goto next;
-					}
-				}
+	bits{nullptr}, fontSheetWidth{fontSheet.GetWidth()}, fontSheetHeight{fontSheet.GetHeight()}, fontWidth{fontWidth}, fontHeight{fontHeight}, kerning{nullptr} {
+	auto packed = std::make_shared<std::vector<uint8_t>>((fontSheetWidth * fontSheetHeight + 7) / 8);
+	for (int y = 0; y < fontSheetHeight; y++) {
+		for (int x = 0; x < fontSheetWidth; x++) {
+			int index = x + y * fontSheetWidth;
+			if (fontSheet.GetPixel(x, y) == cdr::RGB::White) {
+				(*packed)[index >> 3] |= 1 << (index & 7);
 			}
-			next:;
 		}
 	}
-	
-	// for (int cX = 0; cX < fontSheet.GetWidth() / fontWidth - 1; cX++) {
-	// 	for (int cY = 0; cY < fontSheet.GetHeight() / fontHeight; cY++) {
-	// 		for (int y = cY*fontHeight; y < cY*fontHeight+fontHeight; y++) {
-	// 			this->fontSheet.SetPixel(cdr::RGB::Red,   cX * fontWidth + kernX[cX + cY * fontSheet.GetWidth() / fontWidth].first,  y);
-	// 			this->fontSheet.SetPixel(cdr::RGB::Green, cX * fontWidth + kernX[cX + cY * fontSheet.GetHeight() / fontWidth].second, y);
-	// 		}
-	// 	}
-	// }
+	ownedBits = packed;
+	bits = packed->data();
+	computeKerning();
+}
+
+uint32_t cdr::Font::GetGlyphRow(int characterX, int characterY, int row) const {
+	// NOTE: a glyph row is at most 32 bits wide, so it is spread over at most 5 bytes
+	int first = characterX * fontWidth + (characterY * fontHeight + row) * fontSheetWidth;
+	int shift = first & 7;
+	int byteCount = (shift + fontWidth + 7) / 8;
+	const uint8_t* bytes = bits + (first >> 3);
+	uint64_t value = 0;
+	for (int i = 0; i < byteCount; i++) {
+		value |= static_cast<uint64_t>(bytes[i]) << (i * 8);
+	}
+	return static_cast<uint32_t>((value >> shift) & ((uint64_t{1} << fontWidth) - 1));
+}
+
+void cdr::Font::computeKerning() {
+	if (fontWidth > 32) {
+		throw std::runtime_error("Cidr: font glyphs can't be wider than 32 pixels");
+	}
+	auto computed = std::make_shared<std::vector<KernPair>>((fontSheetWidth / fontWidth) * (fontSheetHeight / fontHeight));
+	ComputeKerning(bits, fontSheetWidth, fontSheetHeight, fontWidth, fontHeight, computed->data());
+	ownedKerning = computed;
+	kerning = computed->data();
 }
 
 cdr::Font::Font(std::string_view fontPath, int fontWidth, int fontHeight) : Font(Bitmap(fontPath), fontWidth, fontHeight) {}
@@ -669,13 +596,19 @@ static constexpr uint8_t Raster8x12Data[]/* = new uint8_t[3072]*/ {
 	0x00, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,0x00, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 };
 
-const cdr::Font cdr::Fonts::Raster8x16 { Raster8x16Data, 128, 256, 8, 16};
+static constexpr auto Raster8x16Kerning {cdr::ComputeKerning<128, 256, 8, 16>(Raster8x16Data)};
+static constexpr auto Raster8x8Kerning {cdr::ComputeKerning<128, 128, 8, 8>(Raster8x8Data)};
+static constexpr auto Raster10x10Kerning {cdr::ComputeKerning<160, 160, 10, 10>(Raster10x10Data)};
+static constexpr auto Raster10x12Kerning {cdr::ComputeKerning<160, 192, 10, 12>(Raster10x12Data)};
+static constexpr auto Raster8x12Kerning {cdr::ComputeKerning<128, 192, 8, 12>(Raster8x12Data)};
+
+const cdr::Font cdr::Fonts::Raster8x16 { Raster8x16Data, Raster8x16Kerning.data(), 128, 256, 8, 16};
 
-const cdr::Font cdr::Fonts::Raster8x8 { Raster8x8Data, 128, 128, 8, 8};
+const cdr::Font cdr::Fonts::Raster8x8 { Raster8x8Data, Raster8x8Kerning.data(), 128, 128, 8, 8};
 
-const cdr::Font cdr::Fonts::Raster10x10 { Raster10x10Data, 160, 160, 10, 10};
+const cdr::Font cdr::Fonts::Raster10x10 { Raster10x10Data, Raster10x10Kerning.data(), 160, 160, 10, 10};
 
-const cdr::Font cdr::Fonts::Raster10x12 { Raster10x12Data, 160, 192, 10, 12};
+const cdr::Font cdr::Fonts::Raster10x12 { Raster10x12Data, Raster10x12Kerning.data(), 160, 192, 10, 12};
 
-const cdr::Font cdr::Fonts::Raster8x12 { Raster8x12Data, 128, 192, 8, 12};
+const cdr::Font cdr::Fonts::Raster8x12 { Raster8x12Data, Raster8x12Kerning.data(), 128, 192, 8, 12};
 #pragma endregion fonts
\ No newline at end of file
@@ -8,33 +8,119 @@
 #define CIDR_FONT_HPP
 
 #include "bitmap.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
 #include <utility>
 #include <vector>
 #include <string_view>
 
 namespace cdr {
 	
+// the first column left of and right of the white pixels of a glyph
+struct KernPair {
+	int left;
+	int right;
+};
+
+// NOTE: reads one pixel of a packed font sheet (see Font)
+constexpr bool IsFontPixelSet(const uint8_t* bits, int fontSheetWidth, int x, int y) {
+	int index = x + y * fontSheetWidth;
+	return (bits[index >> 3] >> (index & 7)) & 1;
+}
+
+// NOTE: computes the kerning of every glyph of a packed font sheet, stored row by row.
+// It's constexpr so the built-in fonts get their kerning at compile time
+constexpr void ComputeKerning(const uint8_t* bits, int fontSheetWidth, int fontSheetHeight, int fontWidth, int fontHeight, KernPair* kerning) {
+	int charsPerRow = fontSheetWidth / fontWidth;
+	for (int cX = 0; cX < fontSheetWidth / fontWidth; cX++) {
+		for (int cY = 0; cY < fontSheetHeight / fontHeight; cY++) {
+			KernPair& kern = kerning[cX + cY * charsPerRow];
+			bool kernL = false;
+			bool kernLInit = false;
+			bool kernR = false;
+			bool kernRInit = false;
+			for (int xl = 0, xr = fontWidth - 1; xl < fontWidth && !(kernL && kernR); xl++, xr--) {
+				for (int y = cY*fontHeight; y < cY*fontHeight+fontHeight; y++) {
+					kernL |= IsFontPixelSet(bits, fontSheetWidth, xl + cX * fontWidth, y);
+					kernR |= IsFontPixelSet(bits, fontSheetWidth, xr + cX * fontWidth, y);
+					
+					if (!kernLInit) {
+						kern.left = xl - 1;
+					}
+					kernLInit |= kernL;
+					
+					if (!kernRInit) {
+						kern.right = xr + 1;
+					}
+					kernRInit |= kernR;
+					
+					if (kernR && kernL) {
+						break;
+					}
+				}
+			}
+		}
+	}
+}
+template <int FontSheetWidth, int FontSheetHeight, int FontWidth, int FontHeight>
+constexpr std::array<KernPair, (FontSheetWidth / FontWidth) * (FontSheetHeight / FontHeight)> ComputeKerning(const uint8_t* bits) {
+	std::array<KernPair, (FontSheetWidth / FontWidth) * (FontSheetHeight / FontHeight)> kerning {};
+	ComputeKerning(bits, FontSheetWidth, FontSheetHeight, FontWidth, FontHeight, kerning.data());
+	return kerning;
+}
+
+// NOTE: The font sheet is kept as one bit per pixel (white or black), row by row with the lowest bit
+// of a byte being the leftmost pixel. That's the format the built-in fonts are embedded in,
+// so they don't need to be expanded and one glyph row is only a few bytes.
+// The built-in fonts are constant initialized, they don't run any code at startup.
 class Font {
 private:
-	Bitmap fontSheet;
+	const uint8_t* bits;
+	// NOTE: only used by fonts that were created from a bitmap, copies share the bits
+	std::shared_ptr<const std::vector<uint8_t>> ownedBits;
+	int fontSheetWidth;
+	int fontSheetHeight;
 	int fontWidth;
 	int fontHeight;
-	std::vector<std::pair<int, int>> kernX;
+	const KernPair* kerning;
+	// NOTE: only used by fonts that computed their kerning at runtime, copies share it
+	std::shared_ptr<const std::vector<KernPair>> ownedKerning;
 	
 public: 
+	// NOTE: the data and kerning are not copied, they have to outlive the font (the built-in fonts use static data).
+	// The kerning can be computed with ComputeKerning
+	constexpr Font(const uint8_t data[], const KernPair kerning[], int fontSheetWidth, int fontSheetHeight, int fontWidth, int fontHeight)
+		: bits{data}, ownedBits{}, fontSheetWidth{fontSheetWidth}, fontSheetHeight{fontSheetHeight}, fontWidth{fontWidth}, fontHeight{fontHeight},
+		kerning{kerning}, ownedKerning{} {
+		if (fontWidth > 32) {
+			throw std::runtime_error("Cidr: font glyphs can't be wider than 32 pixels");
+		}
+	}
+	// NOTE: the data is not copied, it has to outlive the font
 	Font(const uint8_t data[], int fontSheetWidth, int fontSheetHeight, int fontWidth, int fontHeight);
 	Font(std::string_view fontPath, int fontWidth, int fontHeight);
+	// NOTE: white pixels are the foreground, every other pixel is the background
 	Font(const Bitmap& fontSheet, int fontWidth, int fontHeight);
 	
+	inline bool IsPixelSet(int x, int y) const {
+		return IsFontPixelSet(bits, fontSheetWidth, x, y);
+	}
 	inline const RGBA GetPixel(int x, int y) const {
-		return fontSheet.GetPixel(x, y);
-	}	
+		return IsPixelSet(x, y) ? RGBA{255, 255, 255, 255} : RGBA{0, 0, 0, 255};
+	}
+	// returns one row of a glyph, bit i is set if the pixel in column i is white
+	uint32_t GetGlyphRow(int characterX, int characterY, int row) const;
 	inline int GetFontWidth() const { return fontWidth; }
 	inline int GetFontHeight() const { return fontHeight; }
-	inline int GetFontSheetWidth() const { return fontSheet.GetWidth(); }
-	inline int GetFontSheetHeight() const { return fontSheet.GetHeight(); }
-	inline int GetLeftKernel(int characterX, int characterY) const { return kernX[characterX + characterY * fontSheet.GetWidth() / fontWidth].first; }
-	inline int GetRightKernel(int characterX, int characterY) const { return kernX[characterX + characterY * fontSheet.GetWidth() / fontWidth].second; }
+	inline int GetFontSheetWidth() const { return fontSheetWidth; }
+	inline int GetFontSheetHeight() const { return fontSheetHeight; }
+	inline int GetLeftKernel(int characterX, int characterY) const { return kerning[characterX + characterY * fontSheetWidth / fontWidth].left; }
+	inline int GetRightKernel(int characterX, int characterY) const { return kerning[characterX + characterY * fontSheetWidth / fontWidth].right; }
+
+private:
+	void computeKerning();
 };
 
 // NOTE: 
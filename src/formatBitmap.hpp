@@ -0,0 +1,141 @@
+/********************************
+ * Project: Cidr				*
+ * File: formatBitmap.hpp		*
+ * Date: 18.10.2026				*
+ ********************************/
+
+#ifndef CIDR_FORMAT_BITMAP_HPP
+#define CIDR_FORMAT_BITMAP_HPP
+
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "bitmap.hpp"
+#include "color.hpp"
+#include "pixelFormat.hpp"
+
+namespace cdr {
+
+// NOTE: A bitmap that stores its pixels in Format (see pixelFormat.hpp) instead of RGBA, e.g. a
+// FormatBitmap<RGB565> for a 16 bit panel or a FormatBitmap<A8> mask. It is the target of a
+// FormatRenderer<Format>, and the 1 and 3 byte formats can be drawn with Renderer::DrawBitmap.
+// Files are loaded and saved with the components of the format: 1 (grey) for formats without color,
+// 3 for formats without alpha and 4 for the others. A8 masks are loaded from and saved as grey files
+template <typename Format>
+class FormatBitmap {
+public:
+	using Pixel = typename Format::Pixel;
+	static constexpr int FileComponents {!Format::HasColor ? 1 : Format::HasAlpha ? 4 : 3};
+
+	FormatBitmap(int width, int height) : width{width}, height{height}, pixels(size_t(width) * height) {}
+	// converts every pixel of the bitmap, premultiplied bitmaps are converted back to straight alpha
+	explicit FormatBitmap(const BitmapView& bitmap) : FormatBitmap(bitmap.GetWidth(), bitmap.GetHeight()) {
+		for (int y = 0; y < height; y++) {
+			const uint32_t* source {bitmap.GetRow(y)};
+			Pixel* row {pixels.data() + size_t(y) * width};
+			if (!bitmap.IsPremultiplied()) {
+				ConvertPixels<RGBA8888, Format>(source, row, width);
+			} else {
+				for (int x = 0; x < width; x++) {
+					row[x] = Format::Pack(UnpremultiplyPixel(source[x]));
+				}
+			}
+		}
+	}
+	// decodes the file straight into the format, a grey file loaded into a FormatBitmap<Grey8> takes one byte per pixel the whole time
+	explicit FormatBitmap(std::string_view file) {
+		DecodePixels(file, FileComponents, [this](const uint8_t* data, int w, int h) { unpackFile(data, w, h); });
+	}
+	FormatBitmap(const uint8_t* fileData, size_t fileSize) {
+		DecodePixels(fileData, fileSize, FileComponents, [this](const uint8_t* data, int w, int h) { unpackFile(data, w, h); });
+	}
+
+	inline int GetWidth() const { return width; }
+	inline int GetHeight() const { return height; }
+	inline Pixel* GetData() { return pixels.data(); }
+	inline const Pixel* GetData() const { return pixels.data(); }
+	inline Pixel GetRawPixel(int x, int y) const { return pixels[x + y * width]; }
+	inline void SetRawPixel(Pixel value, int x, int y) { pixels[x + y * width] = value; }
+	inline RGBA GetPixel(int x, int y) const { return RGBA{Format::Unpack(pixels[x + y * width])}; }
+	inline void SetPixel(const RGBA& value, int x, int y) { pixels[x + y * width] = Format::Pack(RGBtoUINT(value)); }
+
+	// the pixels converted to RGBA, e.g. to draw them scaled
+	Bitmap ToBitmap() const {
+		Bitmap bitmap {width, height};
+		ConvertPixels<Format, RGBA8888>(pixels.data(), bitmap.writableData(), static_cast<int>(pixels.size()));
+		return bitmap;
+	}
+
+	// NOTE: same as the ones of BaseBitmap, the rows are written with FileComponents components
+	void SaveAs(const std::string& fileName, BaseBitmap::Formats format, int quality = 100) const {
+		SaveRows(fileName, format, quality, width, height, FileComponents, [this](int y, uint8_t* out) { packRow(y, out); });
+	}
+	void EncodeTo(const BaseBitmap::EncodeSink& sink, BaseBitmap::Formats format, int quality = 100) const {
+		EncodeRows(sink, format, quality, width, height, FileComponents, [this](int y, uint8_t* out) { packRow(y, out); });
+	}
+	void EncodeTo(std::ostream& out, BaseBitmap::Formats format, int quality = 100) const {
+		EncodeRows(out, format, quality, width, height, FileComponents, [this](int y, uint8_t* out) { packRow(y, out); });
+	}
+	std::vector<uint8_t> Encode(BaseBitmap::Formats format, int quality = 100) const {
+		std::vector<uint8_t> encoded;
+		EncodeTo([&](const uint8_t* data, size_t size) { encoded.insert(encoded.end(), data, data + size); }, format, quality);
+		return encoded;
+	}
+
+private:
+	int width {0};
+	int height {0};
+	std::vector<Pixel> pixels;
+
+	// NOTE: the 1 and 3 byte formats are stored exactly like the rows of their files
+	static constexpr bool isFileLayout {std::is_same_v<Pixel, uint8_t> || std::is_same_v<Format, RGB24>};
+
+	void packRow(int y, uint8_t* out) const {
+		const Pixel* row {pixels.data() + size_t(y) * width};
+		if constexpr (isFileLayout) {
+			memcpy(out, row, size_t(width) * sizeof(Pixel));
+		} else {
+			for (int x = 0; x < width; x++) {
+				uint32_t color {Format::Unpack(row[x])};
+				if (FileComponents == 1) {
+					*out++ = static_cast<uint8_t>(Format::HasAlpha ? color : color >> 24);
+					continue;
+				}
+				*out++ = static_cast<uint8_t>(color >> 24);
+				*out++ = static_cast<uint8_t>(color >> 16);
+				*out++ = static_cast<uint8_t>(color >> 8);
+				if (FileComponents == 4) *out++ = static_cast<uint8_t>(color);
+			}
+		}
+	}
+	void unpackFile(const uint8_t* data, int w, int h) {
+		width = w;
+		height = h;
+		pixels.resize(size_t(width) * height);
+		if constexpr (isFileLayout) {
+			memcpy(pixels.data(), data, pixels.size() * sizeof(Pixel));
+		} else {
+			for (Pixel& pixel : pixels) {
+				uint32_t color {};
+				if (FileComponents == 1) {
+					color = Format::HasAlpha ? 0xffffff00 | data[0] : uint32_t(data[0]) * 0x01010100 | 0xff;
+				} else {
+					color = uint32_t(data[0]) << 24 | uint32_t(data[1]) << 16 | uint32_t(data[2]) << 8 | (FileComponents == 4 ? data[3] : 0xff);
+				}
+				pixel = Format::Pack(color);
+				data += FileComponents;
+			}
+		}
+	}
+};
+
+// 1 byte grey, 1 byte coverage masks and 3 byte RGB, a quarter and three quarters of the memory of a Bitmap
+using MonochromeBitmap = FormatBitmap<Grey8>;
+using MaskBitmap = FormatBitmap<A8>;
+using RGB24Bitmap = FormatBitmap<RGB24>;
+
+}
+
+#endif
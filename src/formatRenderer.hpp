@@ -0,0 +1,173 @@
+/********************************
+ * Project: Cidr				*
+ * File: formatRenderer.hpp		*
+ * Date: 18.10.2026				*
+ ********************************/
+
+#ifndef CIDR_FORMAT_RENDERER_HPP
+#define CIDR_FORMAT_RENDERER_HPP
+
+#include <algorithm>
+#include "color.hpp"
+#include "point.hpp"
+#include "rectangle.hpp"
+#include "bitmap.hpp"
+#include "pixelFormat.hpp"
+#include "formatBitmap.hpp"
+#include "rasterizer.hpp"
+#include "canvasClip.hpp"
+
+namespace cdr {
+
+// NOTE: Renderer for canvases in another pixel format than RGBA (see pixelFormat.hpp), it draws straight
+// into the native format of the target so there is no conversion pass afterwards, e.g. into an ABGR8888
+// texture, a RGB565 panel or an A8 mask. Packing, unpacking and blending are compiled for the format.
+// It has the solid color primitives and unscaled bitmaps, they cover exactly the same pixels as the
+// ones of Renderer (same rasterizers), FormatRenderer<RGBA8888> draws the same image as a Renderer.
+// Shaders, textures, text and the linear light and premultiplied modes are only available in Renderer.
+// The clip stack (PushClip, PopClip) is the one of Renderer
+template <typename Format>
+class FormatRenderer : public CanvasClip {
+public:
+	using Pixel = typename Format::Pixel;
+
+	/* CONSTRUCTOR */
+	// NOTE: stride is in pixels like the one of Renderer, 0 means the rows are tightly packed
+	FormatRenderer(Pixel* pixels, int width, int height, int stride = 0)
+		: CanvasClip(width, height), pixels{pixels}, width{width}, height{height}, stride{stride > 0 ? stride : width} {}
+	explicit FormatRenderer(FormatBitmap<Format>& target) : FormatRenderer(target.GetData(), target.GetWidth(), target.GetHeight()) {}
+
+	/* CLEAR FUNCTIONS */
+	void Clear() { Clear(RGBA{0u}); }
+	void Clear(const RGBA& color) {
+		const Pixel value {Format::Pack(RGBtoUINT(color))};
+		for (int y = clip.y; y < clip.y + clip.height; y++) {
+			Format::FillSpan(pixels + getIndex(clip.x, y), clip.width, value);
+		}
+	}
+
+	/* CORE DRAWING FUNCTIONS */
+	void DrawPixel(const RGBA& color, int x, int y) {
+		if (!isInClip(x, y)) return;
+		drawPixelUnclipped(RGBtoUINT(color), x, y);
+	}
+	void DrawLine(const RGBA& color, const Point& start, const Point& end, bool AA = false) {
+		LineRasterizer line {start, end};
+		const uint32_t colorUINT {RGBtoUINT(color)};
+		if (!AA) {
+			line.Rasterize(clip, [&](int x, int y) {
+				drawPixelUnclipped(colorUINT, x, y);
+			});
+		} else {
+			line.RasterizeAA(clip, [&](int x, int y, int coverage) {
+				Pixel& dst {pixels[getIndex(x, y)]};
+				dst = Format::Blend(dst, (colorUINT & 0xffffff00) | div255(coverage * color.a));
+			});
+		}
+	}
+	void DrawRectangle(const RGBA& color, Rectangle rectangle) {
+		const uint32_t colorUINT {RGBtoUINT(color)};
+		rasterizeOutline(rectangle,
+			[&](int startX, int endX, int y) { drawScanLine(colorUINT, startX, endX, y); },
+			[&](int x, int y) { drawPixelUnclipped(colorUINT, x, y); });
+	}
+	void FillRectangle(const RGBA& color, Rectangle rectangle) {
+		Rectangle visible {clipRectangle(rectangle)};
+		const uint32_t colorUINT {RGBtoUINT(color)};
+		for (int y = visible.y; y < visible.y + visible.height; y++) {
+			if (!useAlphaBlending) {
+				Format::FillSpan(pixels + getIndex(visible.x, y), visible.width, Format::Pack(colorUINT));
+			} else {
+				Format::BlendSpan(pixels + getIndex(visible.x, y), visible.width, colorUINT);
+			}
+		}
+	}
+	void FillCircle(const RGBA& color, const Point& centreLocation, int radius) {
+		FillEllipse(color, centreLocation, radius, radius);
+	}
+	// NOTE: the same rows as Renderer::FillEllipse without anti aliasing
+	void FillEllipse(const RGBA& color, const Point& centreLocation, int radiusX, int radiusY) {
+		const uint32_t colorUINT {RGBtoUINT(color)};
+		EllipseRasterizer{centreLocation, radiusX, radiusY}.Rasterize(clip, [&](int x, int y, int count) {
+			drawScanLine(colorUINT, x, x + count - 1, y);
+		});
+	}
+	void FillTriangle(const RGBA& color, Point p1, Point p2, Point p3) {
+		const uint32_t colorUINT {RGBtoUINT(color)};
+		TriangleRasterizer{p1, p2, p3}.Rasterize(clip, [&](int x, int y, int count) {
+			drawScanLine(colorUINT, x, x + count - 1, y);
+		});
+	}
+	// copies the bitmap unscaled with its top left corner at x, y (converted to the format, not blended, like Renderer::DrawBitmap)
+	void DrawBitmap(const BitmapView& bitmap, int x, int y) {
+		Rectangle visible {clipRectangle(Rectangle{x, y, bitmap.GetWidth(), bitmap.GetHeight()})};
+		for (int row = visible.y; row < visible.y + visible.height; row++) {
+			const uint32_t* source {bitmap.GetRow(row - y) + (visible.x - x)};
+			Pixel* dst {pixels + getIndex(visible.x, row)};
+			if (!bitmap.IsPremultiplied()) {
+				ConvertPixels<RGBA8888, Format>(source, dst, visible.width);
+			} else {
+				for (int i = 0; i < visible.width; i++) {
+					dst[i] = Format::Pack(UnpremultiplyPixel(source[i]));
+				}
+			}
+		}
+	}
+
+	/* DRAWING FUNCTION OVERLOADS */
+	inline void DrawPixel(const RGBA& color, const Point& p) { DrawPixel(color, p.x, p.y); }
+	inline void DrawLine(const RGBA& color, int x1, int y1, int x2, int y2, bool AA = false) { DrawLine(color, Point{x1, y1}, Point{x2, y2}, AA); }
+	inline void DrawRectangle(const RGBA& color, int x, int y, int width, int height) { DrawRectangle(color, Rectangle{x, y, width, height}); }
+	inline void FillRectangle(const RGBA& color, int x, int y, int width, int height) { FillRectangle(color, Rectangle{x, y, width, height}); }
+	inline void FillCircle(const RGBA& color, int centreX, int centreY, int radius) { FillCircle(color, Point{centreX, centreY}, radius); }
+	inline void FillEllipse(const RGBA& color, int centreX, int centreY, int radiusX, int radiusY) { FillEllipse(color, Point{centreX, centreY}, radiusX, radiusY); }
+	inline void FillTriangle(const RGBA& color, int x1, int y1, int x2, int y2, int x3, int y3) { FillTriangle(color, Point{x1, y1}, Point{x2, y2}, Point{x3, y3}); }
+	inline void DrawBitmap(const BitmapView& bitmap, const Point& p) { DrawBitmap(bitmap, p.x, p.y); }
+
+	/* GETTERS */
+	inline Pixel* GetData() const { return pixels; }
+	inline int GetWidth() const { return width; }
+	inline int GetHeight() const { return height; }
+	inline int GetStride() const { return stride; }
+	inline RGBA GetPixel(int x, int y) const {
+		if (x < 0 || y < 0 || x >= width || y >= height) return RGBA{};
+		return RGBA{Format::Unpack(pixels[getIndex(x, y)])};
+	}
+
+	/* Toggles */
+	inline void EnableAlphaBlending() { useAlphaBlending = true; }
+	inline void DisableAlphaBlending() { useAlphaBlending = false; }
+
+private:
+	Pixel* pixels {nullptr};
+	int width {0};
+	int height {0};
+	int stride {0};
+	bool useAlphaBlending {false};
+
+	inline int getIndex(int x, int y) const { return x + y * stride; }
+	// NOTE: like Renderer, a fully transparent color is blended (so it draws nothing) even without alpha blending
+	inline void writePixel(Pixel& dst, uint32_t color) const {
+		if (!useAlphaBlending && (color & 0xff) != 0) {
+			dst = Format::Pack(color);
+		} else {
+			dst = Format::Blend(dst, color);
+		}
+	}
+	inline void drawPixelUnclipped(uint32_t color, int x, int y) {
+		writePixel(pixels[getIndex(x, y)], color);
+	}
+	// endX is inclusive
+	void drawScanLine(uint32_t color, int startX, int endX, int y) {
+		if (!clipScanLine(startX, endX, y)) return;
+		if (!useAlphaBlending && (color & 0xff) != 0) {
+			Format::FillSpan(pixels + getIndex(startX, y), endX - startX + 1, Format::Pack(color));
+		} else {
+			Format::BlendSpan(pixels + getIndex(startX, y), endX - startX + 1, color);
+		}
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,84 @@
+/********************************
+ * Project: Cidr				*
+ * File: frameArena.cpp			*
+ * Date: 17.10.2026				*
+ ********************************/
+
+#include "frameArena.hpp"
+#include <algorithm>
+
+cdr::FrameArena::FrameArena(size_t blockSize)
+	: blockSize{std::max<size_t>(blockSize, 256)} {
+}
+cdr::FrameArena::FrameArena(const FrameArena& other)
+	: blockSize{other.blockSize} {
+}
+cdr::FrameArena& cdr::FrameArena::operator=(const FrameArena& other) {
+	// NOTE: keeps its own memory, nothing allocated from it may be in use when it is assigned to
+	blockSize = other.blockSize;
+	current = 0;
+	offset = 0;
+	return *this;
+}
+
+void* cdr::FrameArena::Allocate(size_t size, size_t alignment) {
+	while (current < blocks.size()) {
+		Block& block = blocks[current];
+		uintptr_t address = reinterpret_cast<uintptr_t>(block.data.get()) + offset;
+		size_t padding = (alignment - address % alignment) % alignment;
+		if (offset + padding + size <= block.size) {
+			offset += padding + size;
+			return block.data.get() + offset - size;
+		}
+		// the rest of this block is wasted until the arena is rewound or reset
+		if (current + 1 < blocks.size() && blocks[current + 1].size >= size + alignment) {
+			current++;
+			offset = 0;
+			continue;
+		}
+		break;
+	}
+
+	// NOTE: a block that is too small is kept for later, the new block is put right after the current one
+	size_t insertAt = blocks.empty() ? 0 : current + 1;
+	blocks.insert(blocks.begin() + insertAt, allocateBlock(std::max(blockSize, size + alignment)));
+	current = insertAt;
+	offset = 0;
+	return Allocate(size, alignment);
+}
+
+cdr::FrameArena::Marker cdr::FrameArena::GetMarker() const {
+	Marker marker;
+	marker.block = current;
+	marker.offset = offset;
+	return marker;
+}
+void cdr::FrameArena::Rewind(const Marker& marker) {
+	current = marker.block;
+	offset = marker.offset;
+}
+
+void cdr::FrameArena::Reset() {
+	if (blocks.size() > 1) {
+		size_t capacity = GetCapacity();
+		blocks.clear();
+		blocks.push_back(allocateBlock(capacity));
+	}
+	current = 0;
+	offset = 0;
+}
+
+size_t cdr::FrameArena::GetCapacity() const {
+	size_t capacity = 0;
+	for (const auto& block : blocks) {
+		capacity += block.size;
+	}
+	return capacity;
+}
+
+cdr::FrameArena::Block cdr::FrameArena::allocateBlock(size_t size) {
+	heapBlockCount++;
+	heapBytes += size;
+	// NOTE: not value initialized on purpose, the memory is handed out uninitialized anyway
+	return Block{std::unique_ptr<std::byte[]>(new std::byte[size]), size};
+}
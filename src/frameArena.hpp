@@ -0,0 +1,93 @@
+/********************************
+ * Project: Cidr				*
+ * File: frameArena.hpp			*
+ * Date: 17.10.2026				*
+ ********************************/
+
+#ifndef CIDR_FRAME_ARENA_HPP
+#define CIDR_FRAME_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace cdr {
+
+// NOTE: Scratch memory for everything that only lives during a single draw call or frame.
+// Allocating just bumps an offset, memory is given back with Rewind (stack order) or all at once with Reset.
+// If a frame needed more than one block, Reset merges them into a single block that is big enough,
+// so after the first few frames drawing doesn't touch the heap anymore (see GetHeapBlockCount and GetHeapBytes).
+// Copies of an arena start out empty, the memory is never shared.
+class FrameArena {
+public:
+	// position in the arena, returned by GetMarker and used to free everything allocated after it
+	class Marker {
+		friend class FrameArena;
+		size_t block {0};
+		size_t offset {0};
+	};
+
+	// frees everything allocated during its lifetime when it goes out of scope
+	class Scope {
+	public:
+		explicit Scope(FrameArena& arena) : arena{arena}, marker{arena.GetMarker()} {}
+		~Scope() { arena.Rewind(marker); }
+		Scope(const Scope& other) = delete;
+		Scope& operator=(const Scope& other) = delete;
+	private:
+		FrameArena& arena;
+		Marker marker;
+	};
+
+	/* CONSTRUCTOR - DESTRUCTOR */
+	explicit FrameArena(size_t blockSize = 64 * 1024);
+	FrameArena(const FrameArena& other);
+	FrameArena& operator=(const FrameArena& other);
+	FrameArena(FrameArena&& other) = default;
+	FrameArena& operator=(FrameArena&& other) = default;
+
+	// returns uninitialized memory, valid until it is rewound or the arena is reset
+	void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+	template <typename T>
+	inline T* Allocate(size_t count) {
+		static_assert(std::is_trivially_destructible_v<T>, "Cidr: the arena never calls destructors");
+		return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+	}
+
+	Marker GetMarker() const;
+	// frees everything allocated after the marker was taken
+	void Rewind(const Marker& marker);
+	// frees everything, should be called once per frame
+	void Reset();
+
+	/* GETTERS */
+	// number of blocks that were allocated on the heap since the arena was created
+	inline size_t GetHeapBlockCount() const { return heapBlockCount; }
+	// bytes of all those blocks together, a frame that outgrows the arena adds the size of the merged block as well
+	inline size_t GetHeapBytes() const { return heapBytes; }
+	// bytes currently reserved from the heap
+	size_t GetCapacity() const;
+
+private:
+	struct Block {
+		std::unique_ptr<std::byte[]> data;
+		size_t size;
+	};
+
+	size_t blockSize;
+	std::vector<Block> blocks;
+	// NOTE: allocations come from blocks[current] starting at offset, blocks after current are unused
+	size_t current {0};
+	size_t offset {0};
+	size_t heapBlockCount {0};
+	size_t heapBytes {0};
+
+private:
+	Block allocateBlock(size_t size);
+};
+
+}
+
+#endif
@@ -0,0 +1,161 @@
+/********************************
+ * Project: Cidr				*
+ * File: glyphCache.cpp			*
+ * Date: 17.10.2026				*
+ ********************************/
+
+#include "glyphCache.hpp"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+/* FACE */
+
+cdr::GlyphCache::Face::Face(const Font& font, float size, bool useKerning, int shadowOffsetX, int shadowOffsetY)
+	: font{&font}, size{size}, useKerning{useKerning}, shadowOffsetX{shadowOffsetX}, shadowOffsetY{shadowOffsetY} {
+	for (auto& glyph : glyphs) {
+		glyph.store(nullptr, std::memory_order_relaxed);
+	}
+}
+cdr::GlyphCache::Face::~Face() {
+	for (auto& glyph : glyphs) {
+		delete glyph.load(std::memory_order_relaxed);
+	}
+}
+
+const cdr::GlyphCache::Glyph& cdr::GlyphCache::Face::GetGlyph(uint8_t glyph) const {
+	Glyph* cached {glyphs[glyph].load(std::memory_order_acquire)};
+	if (cached) return *cached;
+
+	// NOTE: two threads may create the same glyph at the same time, only the first one is kept
+	Glyph* created {createGlyph(glyph)};
+	if (!glyphs[glyph].compare_exchange_strong(cached, created, std::memory_order_acq_rel)) {
+		delete created;
+		return *cached;
+	}
+	return *created;
+}
+
+cdr::GlyphCache::Glyph* cdr::GlyphCache::Face::createGlyph(uint8_t glyph) const {
+	// NOTE: the formulas are the same as the ones Renderer::DrawText used when it sampled the font sheet directly
+	int fontWidth {font->GetFontWidth()};
+	int fontHeight {font->GetFontHeight()};
+	int charsRows {font->GetFontSheetWidth() / fontWidth};
+	int charsCols {font->GetFontSheetHeight() / fontHeight};
+	int letterX {glyph % charsCols};
+	int letterY {glyph / charsRows};
+
+	int start {0};
+	int end {fontWidth};
+	if (useKerning) {
+		start = std::min(font->GetLeftKernel(letterX, letterY), font->GetRightKernel(letterX, letterY));
+		end   = std::max(font->GetLeftKernel(letterX, letterY), font->GetRightKernel(letterX, letterY));
+	}
+	int rightKernel {font->GetRightKernel(letterX, letterY)};
+
+	// NOTE: the glyph is read from the packed font a whole row at a time
+	std::vector<uint32_t> rows(fontHeight);
+	for (int row = 0; row < fontHeight; row++) {
+		rows[row] = font->GetGlyphRow(letterX, letterY, row);
+	}
+	auto isInGlyph = [&](int x, int y) {
+		return x >= 0 && y >= 0 && x < fontWidth && y < fontHeight;
+	};
+	auto isWhite = [&](int x, int y) {
+		return (rows[y] >> x) & 1;
+	};
+
+	Glyph* result {new Glyph{}};
+	result->start = start;
+	result->advance = end - start;
+	result->width = std::max(0, static_cast<int>(std::ceil(end * size)) - start);
+	result->height = std::max(0, static_cast<int>(std::ceil(fontHeight * size)));
+	result->mask.resize(result->width * result->height);
+
+	for (int i = start; i < end * size; i++) {
+		for (int j = 0; j < fontHeight * size; j++) {
+			uint8_t bits {0};
+			if (i < 0 || i >= rightKernel * size) {
+				bits |= OutsideKerning;
+			}
+
+			int fontX {static_cast<int>(i / size)};
+			int fontY {static_cast<int>(j / size)};
+			if (isInGlyph(fontX, fontY)) {
+				bits |= isWhite(fontX, fontY) ? White : Black;
+			}
+
+			int sx = i / size + shadowOffsetX;
+			int sy = j / size + shadowOffsetY;
+			if (!isInGlyph(sx, sy) || !isWhite(sx, sy)) {
+				bits |= Shadow;
+			}
+
+			result->mask[(i - start) + j * result->width] = bits;
+		}
+	}
+	return result;
+}
+
+/* GLYPH CACHE */
+
+cdr::GlyphCache::GlyphCache(size_t maxFaces) : maxFaces{std::max<size_t>(1, maxFaces)} {}
+
+std::shared_ptr<const cdr::GlyphCache::Face> cdr::GlyphCache::GetFace(const TextStyle& ts) {
+	const uint64_t use {useCounter.fetch_add(1, std::memory_order_relaxed) + 1};
+	{
+		std::shared_lock<std::shared_mutex> lock{mutex};
+		if (const std::shared_ptr<Face>* face = findFace(ts)) {
+			(*face)->lastUse.store(use, std::memory_order_relaxed);
+			return *face;
+		}
+	}
+	std::unique_lock<std::shared_mutex> lock{mutex};
+	if (const std::shared_ptr<Face>* face = findFace(ts)) {
+		(*face)->lastUse.store(use, std::memory_order_relaxed);
+		return *face;
+	}
+	evict(maxFaces - 1);
+	faces.push_back(std::shared_ptr<Face>(new Face{*ts.font, ts.size, ts.useKerning, ts.shadowOffsetX, ts.shadowOffsetY}));
+	faces.back()->lastUse.store(use, std::memory_order_relaxed);
+	return faces.back();
+}
+
+const std::shared_ptr<cdr::GlyphCache::Face>* cdr::GlyphCache::findFace(const TextStyle& ts) const {
+	// NOTE: there are only a handful of faces in use at a time, a linear search is faster than hashing
+	for (const auto& face : faces) {
+		if (face->font == ts.font && face->size == ts.size && face->useKerning == ts.useKerning &&
+			face->shadowOffsetX == ts.shadowOffsetX && face->shadowOffsetY == ts.shadowOffsetY) {
+			return &face;
+		}
+	}
+	return nullptr;
+}
+
+void cdr::GlyphCache::evict(size_t count) {
+	while (faces.size() > count) {
+		auto oldest = std::min_element(faces.begin(), faces.end(), [](const auto& a, const auto& b) {
+			return a->lastUse.load(std::memory_order_relaxed) < b->lastUse.load(std::memory_order_relaxed);
+		});
+		faces.erase(oldest);
+	}
+}
+
+void cdr::GlyphCache::Clear() {
+	std::unique_lock<std::shared_mutex> lock{mutex};
+	faces.clear();
+}
+void cdr::GlyphCache::Trim(size_t maxFaces) {
+	std::unique_lock<std::shared_mutex> lock{mutex};
+	evict(maxFaces);
+}
+
+size_t cdr::GlyphCache::GetFaceCount() const {
+	std::shared_lock<std::shared_mutex> lock{mutex};
+	return faces.size();
+}
+
+cdr::GlyphCache& cdr::GlyphCache::Default() {
+	static GlyphCache cache{};
+	return cache;
+}
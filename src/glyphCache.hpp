@@ -0,0 +1,104 @@
+/********************************
+ * Project: Cidr				*
+ * File: glyphCache.hpp			*
+ * Date: 17.10.2026				*
+ ********************************/
+
+#ifndef CIDR_GLYPH_CACHE_HPP
+#define CIDR_GLYPH_CACHE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
+#include "font.hpp"
+
+namespace cdr {
+
+// NOTE: Keeps every glyph that was drawn as a scaled mask, so drawing text doesn't have to sample
+// and scale the font sheet again. The masks don't contain any colors, a glyph is shared by all
+// text styles with the same font, size, kerning and shadow offsets.
+// The cache is thread safe, glyphs are created lazily and never change or move afterwards.
+// At most maxFaces faces are kept, when another one is needed the least recently used face is removed
+class GlyphCache {
+public:
+	// bits of a mask pixel
+	enum MaskBits : uint8_t {
+		White = 1 << 0,          // font pixel is white (foreground)
+		Black = 1 << 1,          // font pixel is black (background)
+		OutsideKerning = 1 << 2, // left or right of the kerned part of the glyph
+		Shadow = 1 << 3,         // the shadow of this pixel may be drawn
+	};
+
+	struct Glyph {
+		// column of the font glyph the mask starts at (negative if the kerned glyph starts left of it)
+		int start;
+		// how far the caret moves after the glyph in font pixels (not scaled)
+		int advance;
+		int width;
+		int height;
+		// row by row
+		std::vector<uint8_t> mask;
+	};
+
+	// all glyphs of one font with the same size, kerning and shadow offsets
+	class Face {
+		friend class GlyphCache;
+	public:
+		// creates the glyph the first time it is requested
+		const Glyph& GetGlyph(uint8_t glyph) const;
+
+		Face(const Face& other) = delete;
+		Face& operator=(const Face& other) = delete;
+		~Face();
+	private:
+		Face(const Font& font, float size, bool useKerning, int shadowOffsetX, int shadowOffsetY);
+		Glyph* createGlyph(uint8_t glyph) const;
+
+		const Font* font;
+		float size;
+		bool useKerning;
+		int shadowOffsetX;
+		int shadowOffsetY;
+		mutable std::array<std::atomic<Glyph*>, 256> glyphs;
+		// value of the use counter of the cache when the face was requested the last time
+		mutable std::atomic<uint64_t> lastUse {0};
+	};
+
+	/* CONSTRUCTOR - DESTRUCTOR */
+	explicit GlyphCache(size_t maxFaces = 64);
+	GlyphCache(const GlyphCache& other) = delete;
+	GlyphCache& operator=(const GlyphCache& other) = delete;
+
+	// NOTE: returns the face for the text style. A face that is removed from the cache (evicted, Trim or Clear)
+	// stays alive until the last shared_ptr to it is gone, so text that is being drawn is never affected
+	std::shared_ptr<const Face> GetFace(const TextStyle& ts);
+	// removes every face
+	void Clear();
+	// removes the least recently used faces until at most maxFaces are left
+	void Trim(size_t maxFaces);
+
+	/* GETTERS */
+	size_t GetFaceCount() const;
+	inline size_t GetMaxFaces() const { return maxFaces; }
+
+	// the cache used by every renderer unless it was given another one
+	static GlyphCache& Default();
+
+private:
+	mutable std::shared_mutex mutex;
+	std::vector<std::shared_ptr<Face>> faces;
+	size_t maxFaces;
+	std::atomic<uint64_t> useCounter {0};
+
+private:
+	const std::shared_ptr<Face>* findFace(const TextStyle& ts) const;
+	// removes the least recently used faces until at most count are left, the mutex has to be locked exclusively
+	void evict(size_t count);
+};
+
+}
+
+#endif
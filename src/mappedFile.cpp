@@ -0,0 +1,115 @@
+/********************************
+ * Project: Cidr				*
+ * File: mappedFile.cpp			*
+ * Date: 18.10.2026				*
+ ********************************/
+
+#include "mappedFile.hpp"
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+cdr::MappedFile::MappedFile(const std::string& path) {
+	HANDLE file {CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr)};
+	if (file == INVALID_HANDLE_VALUE) {
+		throw std::runtime_error("Cidr: Could not open file (" + path + ")");
+	}
+	fileHandle = file;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize)) {
+		close();
+		throw std::runtime_error("Cidr: Could not read the size of file (" + path + ")");
+	}
+	size = static_cast<size_t>(fileSize.QuadPart);
+	if (size == 0) return;
+
+	mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mappingHandle) {
+		data = static_cast<const uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	}
+	if (!data) {
+		close();
+		throw std::runtime_error("Cidr: Could not map file (" + path + ")");
+	}
+}
+
+void cdr::MappedFile::close() {
+	if (data) UnmapViewOfFile(data);
+	if (mappingHandle) CloseHandle(mappingHandle);
+	if (fileHandle) CloseHandle(fileHandle);
+	data = nullptr;
+	size = 0;
+	mappingHandle = nullptr;
+	fileHandle = nullptr;
+}
+
+#else
+
+cdr::MappedFile::MappedFile(const std::string& path) {
+	int file {open(path.c_str(), O_RDONLY)};
+	if (file < 0) {
+		throw std::runtime_error("Cidr: Could not open file (" + path + ")");
+	}
+	struct stat status;
+	if (fstat(file, &status) != 0) {
+		::close(file);
+		throw std::runtime_error("Cidr: Could not read the size of file (" + path + ")");
+	}
+	size = static_cast<size_t>(status.st_size);
+	if (size > 0) {
+		void* mapping {mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0)};
+		if (mapping == MAP_FAILED) {
+			::close(file);
+			size = 0;
+			throw std::runtime_error("Cidr: Could not map file (" + path + ")");
+		}
+		data = static_cast<const uint8_t*>(mapping);
+	}
+	// NOTE: the mapping keeps the file alive, the descriptor isn't needed anymore
+	::close(file);
+}
+
+void cdr::MappedFile::close() {
+	if (data) munmap(const_cast<uint8_t*>(data), size);
+	data = nullptr;
+	size = 0;
+}
+
+#endif
+
+cdr::MappedFile::~MappedFile() {
+	close();
+}
+
+cdr::MappedFile::MappedFile(MappedFile&& other) noexcept
+	: data{std::exchange(other.data, nullptr)},
+	size{std::exchange(other.size, 0)}
+#ifdef _WIN32
+	, fileHandle{std::exchange(other.fileHandle, nullptr)},
+	mappingHandle{std::exchange(other.mappingHandle, nullptr)}
+#endif
+{
+}
+cdr::MappedFile& cdr::MappedFile::operator=(MappedFile&& other) noexcept {
+	if (this == &other) return *this;
+	close();
+	data = std::exchange(other.data, nullptr);
+	size = std::exchange(other.size, 0);
+#ifdef _WIN32
+	fileHandle = std::exchange(other.fileHandle, nullptr);
+	mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#endif
+	return *this;
+}
@@ -0,0 +1,47 @@
+/********************************
+ * Project: Cidr				*
+ * File: mappedFile.hpp			*
+ * Date: 18.10.2026				*
+ ********************************/
+
+#ifndef CIDR_MAPPED_FILE_HPP
+#define CIDR_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace cdr {
+
+// NOTE: A file mapped read only into memory, the pages are only read from disk when they are touched
+// and nothing is copied into a buffer first. The data stays valid as long as the MappedFile lives.
+// Throws if the file can't be opened or mapped, an empty file has no data and a size of 0
+class MappedFile {
+public:
+	/* CONSTRUCTOR - DESTRUCTOR */
+	explicit MappedFile(const std::string& path);
+	~MappedFile();
+
+	MappedFile(const MappedFile& other) = delete;
+	MappedFile& operator=(const MappedFile& other) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	/* GETTERS */
+	inline const uint8_t* GetData() const { return data; }
+	inline size_t GetSize() const { return size; }
+
+private:
+	const uint8_t* data {nullptr};
+	size_t size {0};
+#ifdef _WIN32
+	void* fileHandle {nullptr};
+	void* mappingHandle {nullptr};
+#endif
+
+	void close();
+};
+
+}
+
+#endif
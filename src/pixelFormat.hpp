@@ -0,0 +1,221 @@
+/********************************
+ * Project: Cidr				*
+ * File: pixelFormat.hpp		*
+ * Date: 18.10.2026				*
+ ********************************/
+
+#ifndef CIDR_PIXEL_FORMAT_HPP
+#define CIDR_PIXEL_FORMAT_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+#include "span.hpp"
+
+// NOTE: Pixel formats a FormatRenderer can draw into and a FormatBitmap can hold.
+// Every format converts from and to the packed RGBA the rest of Cidr uses (R in the highest byte,
+// A in the lowest, straight alpha) and everything is resolved at compile time:
+//   Pixel                       type of a single pixel in memory
+//   Pack(rgba), Unpack(pixel)   conversion from and to RGBA
+//   Blend(pixel, rgba)          blends a color on top of a pixel, same math as BlendPixel
+//   FillSpan, BlendSpan         the row versions used for spans, SIMD where a span kernel fits the format
+// The 32 bit formats are named after their channels from the highest to the lowest bit of the packed
+// pixel (like SDL_PIXELFORMAT_*8888), so ABGR8888 is the byte order R, G, B, A on a little endian cpu
+namespace cdr {
+
+// row functions for formats that don't have faster ones, one Blend per pixel
+template <typename Format>
+struct PixelFormatSpans {
+	template <typename Pixel>
+	static inline void FillSpan(Pixel* dst, int count, Pixel value) {
+		if (count > 0) std::fill_n(dst, count, value);
+	}
+	template <typename Pixel>
+	static inline void BlendSpan(Pixel* dst, int count, uint32_t color) {
+		for (int i = 0; i < count; i++) {
+			dst[i] = Format::Blend(dst[i], color);
+		}
+	}
+};
+
+// 32 bit formats, the template arguments are the bit offsets of the channels
+template <int RShift, int GShift, int BShift, int AShift>
+struct PackedPixelFormat : PixelFormatSpans<PackedPixelFormat<RShift, GShift, BShift, AShift>> {
+	using Pixel = uint32_t;
+	static constexpr bool HasColor {true};
+	static constexpr bool HasAlpha {true};
+
+	static constexpr Pixel Pack(uint32_t color) {
+		return ((color >> 24) & 0xff) << RShift | ((color >> 16) & 0xff) << GShift | ((color >> 8) & 0xff) << BShift | (color & 0xff) << AShift;
+	}
+	static constexpr uint32_t Unpack(Pixel pixel) {
+		return ((pixel >> RShift) & 0xff) << 24 | ((pixel >> GShift) & 0xff) << 16 | ((pixel >> BShift) & 0xff) << 8 | ((pixel >> AShift) & 0xff);
+	}
+	static inline Pixel Blend(Pixel dst, uint32_t color) {
+		return Pack(BlendPixel(Unpack(dst), color));
+	}
+	// NOTE: the blend treats the three colors the same, only the alpha has to be in the lowest byte
+	// for the span kernels, so they work on RGBA8888 and BGRA8888 as they are. The pixels of the other
+	// formats are rotated until their alpha is the lowest byte, blended and rotated back, a chunk at a time
+	static inline void BlendSpan(Pixel* dst, int count, uint32_t color) {
+		if constexpr (AShift == 0) {
+			cdr::BlendSpan(dst, count, Pack(color));
+		} else {
+			constexpr int chunkSize {256};
+			const uint32_t source {rotateAlphaLow(Pack(color))};
+			for (int i = 0; i < count; i += chunkSize) {
+				Pixel* chunk {dst + i};
+				int chunkCount {std::min(chunkSize, count - i)};
+				for (int j = 0; j < chunkCount; j++) chunk[j] = rotateAlphaLow(chunk[j]);
+				cdr::BlendSpan(chunk, chunkCount, source);
+				for (int j = 0; j < chunkCount; j++) chunk[j] = rotateAlphaBack(chunk[j]);
+			}
+		}
+	}
+
+private:
+	static constexpr uint32_t rotateAlphaLow(uint32_t pixel) {
+		return AShift == 0 ? pixel : pixel >> AShift | pixel << (32 - AShift);
+	}
+	static constexpr uint32_t rotateAlphaBack(uint32_t pixel) {
+		return AShift == 0 ? pixel : pixel << AShift | pixel >> (32 - AShift);
+	}
+};
+
+using RGBA8888 = PackedPixelFormat<24, 16, 8, 0>;
+using BGRA8888 = PackedPixelFormat<8, 16, 24, 0>;
+using ABGR8888 = PackedPixelFormat<0, 8, 16, 24>;
+using ARGB8888 = PackedPixelFormat<16, 8, 0, 24>;
+
+// 16 bit 5-6-5 color without alpha, the panels treat every pixel as opaque.
+// Packing drops the low bits, unpacking repeats the high bits in them so white stays white
+struct RGB565 : PixelFormatSpans<RGB565> {
+	using Pixel = uint16_t;
+	static constexpr bool HasColor {true};
+	static constexpr bool HasAlpha {false};
+
+	static constexpr Pixel Pack(uint32_t color) {
+		return static_cast<Pixel>(((color >> 16) & 0xf800) | ((color >> 13) & 0x07e0) | ((color >> 11) & 0x001f));
+	}
+	static constexpr uint32_t Unpack(Pixel pixel) {
+		uint32_t r {(pixel >> 11) & 0x1fu};
+		uint32_t g {(pixel >> 5) & 0x3fu};
+		uint32_t b {pixel & 0x1fu};
+		r = (r << 3) | (r >> 2);
+		g = (g << 2) | (g >> 4);
+		b = (b << 3) | (b >> 2);
+		return r << 24 | g << 16 | b << 8 | 0xff;
+	}
+	static inline Pixel Blend(Pixel dst, uint32_t color) {
+		return Pack(BlendPixel(Unpack(dst), color));
+	}
+	static inline void BlendSpan(Pixel* dst, int count, uint32_t color) {
+		// NOTE: the destination is opaque, so src * srcA and 1 - srcA are the same for the whole span
+		uint32_t sa {color & 0xff};
+		uint32_t t {255 - sa};
+		uint32_t r {((color >> 24) & 0xff) * sa};
+		uint32_t g {((color >> 16) & 0xff) * sa};
+		uint32_t b {((color >> 8) & 0xff) * sa};
+		for (int i = 0; i < count; i++) {
+			uint32_t pixel {Unpack(dst[i])};
+			dst[i] = Pack(div255(r + (pixel >> 24) * t) << 24 | div255(g + ((pixel >> 16) & 0xff) * t) << 16 | div255(b + ((pixel >> 8) & 0xff) * t) << 8);
+		}
+	}
+};
+
+// 8 bit alpha (coverage) masks, the color is dropped. Unpacked a mask pixel is white with that alpha
+// and blending composites the alphas (source over), so overlapping shapes add up instead of being replaced
+struct A8 : PixelFormatSpans<A8> {
+	using Pixel = uint8_t;
+	static constexpr bool HasColor {false};
+	static constexpr bool HasAlpha {true};
+
+	static constexpr Pixel Pack(uint32_t color) {
+		return static_cast<Pixel>(color & 0xff);
+	}
+	static constexpr uint32_t Unpack(Pixel pixel) {
+		return 0xffffff00 | pixel;
+	}
+	static inline Pixel Blend(Pixel dst, uint32_t color) {
+		uint32_t sa {color & 0xff};
+		return static_cast<Pixel>(sa + div255(dst * (255 - sa)));
+	}
+	static inline void FillSpan(Pixel* dst, int count, Pixel value) {
+		if (count > 0) memset(dst, value, count);
+	}
+};
+
+// 8 bit grey without alpha, 1 byte per pixel. Packing takes the luma of the color with the integer
+// weights stb_image uses for grey files (77, 150, 29), unpacking repeats the grey in every channel
+struct Grey8 : PixelFormatSpans<Grey8> {
+	using Pixel = uint8_t;
+	static constexpr bool HasColor {false};
+	static constexpr bool HasAlpha {false};
+
+	static constexpr Pixel Pack(uint32_t color) {
+		return static_cast<Pixel>((((color >> 24) & 0xff) * 77 + ((color >> 16) & 0xff) * 150 + ((color >> 8) & 0xff) * 29) >> 8);
+	}
+	static constexpr uint32_t Unpack(Pixel pixel) {
+		return uint32_t(pixel) << 24 | uint32_t(pixel) << 16 | uint32_t(pixel) << 8 | 0xff;
+	}
+	static inline Pixel Blend(Pixel dst, uint32_t color) {
+		return Pack(BlendPixel(Unpack(dst), color));
+	}
+	static inline void FillSpan(Pixel* dst, int count, Pixel value) {
+		if (count > 0) memset(dst, value, count);
+	}
+};
+
+// 24 bit color without alpha, the bytes R, G, B in memory (like SDL_PIXELFORMAT_RGB24 and 3 component files)
+struct RGB24Pixel {
+	uint8_t r;
+	uint8_t g;
+	uint8_t b;
+};
+static_assert(sizeof(RGB24Pixel) == 3, "RGB24 pixels have to be tightly packed");
+
+struct RGB24 : PixelFormatSpans<RGB24> {
+	using Pixel = RGB24Pixel;
+	static constexpr bool HasColor {true};
+	static constexpr bool HasAlpha {false};
+
+	static constexpr Pixel Pack(uint32_t color) {
+		return Pixel{static_cast<uint8_t>(color >> 24), static_cast<uint8_t>(color >> 16), static_cast<uint8_t>(color >> 8)};
+	}
+	static constexpr uint32_t Unpack(Pixel pixel) {
+		return uint32_t(pixel.r) << 24 | uint32_t(pixel.g) << 16 | uint32_t(pixel.b) << 8 | 0xff;
+	}
+	static inline Pixel Blend(Pixel dst, uint32_t color) {
+		return Pack(BlendPixel(Unpack(dst), color));
+	}
+	static inline void BlendSpan(Pixel* dst, int count, uint32_t color) {
+		// NOTE: the destination is opaque like the one of RGB565
+		uint32_t sa {color & 0xff};
+		uint32_t t {255 - sa};
+		uint32_t r {((color >> 24) & 0xff) * sa};
+		uint32_t g {((color >> 16) & 0xff) * sa};
+		uint32_t b {((color >> 8) & 0xff) * sa};
+		for (int i = 0; i < count; i++) {
+			dst[i].r = static_cast<uint8_t>(div255(r + dst[i].r * t));
+			dst[i].g = static_cast<uint8_t>(div255(g + dst[i].g * t));
+			dst[i].b = static_cast<uint8_t>(div255(b + dst[i].b * t));
+		}
+	}
+};
+
+// converts count pixels from one format to another, a plain copy if both are the same
+template <typename From, typename To>
+void ConvertPixels(const typename From::Pixel* src, typename To::Pixel* dst, int count) {
+	if constexpr (std::is_same_v<From, To>) {
+		if (count > 0) memcpy(dst, src, count * sizeof(typename From::Pixel));
+	} else {
+		for (int i = 0; i < count; i++) {
+			dst[i] = To::Pack(From::Unpack(src[i]));
+		}
+	}
+}
+
+}
+
+#endif
@@ -0,0 +1,315 @@
+/********************************
+ * Project: Cidr				*
+ * File: rasterizer.cpp			*
+ * Date: 17.10.2026				*
+ ********************************/
+
+#include "rasterizer.hpp"
+#include <cmath>
+#include <cstdlib>
+
+cdr::TriangleRasterizer::TriangleRasterizer(FPoint p1, FPoint p2, FPoint p3) {
+	if (!std::isfinite(p1.x) || !std::isfinite(p1.y) || !std::isfinite(p2.x) || !std::isfinite(p2.y) ||
+		!std::isfinite(p3.x) || !std::isfinite(p3.y)) {
+		return;
+	}
+
+	auto toFixed = [](float value) {
+		float clamped {std::max(-float(guardBand), std::min(float(guardBand), value))};
+		return static_cast<int64_t>(std::lround(clamped * (1 << subPixelBits)));
+	};
+	const int64_t vx[3] {toFixed(p1.x), toFixed(p2.x), toFixed(p3.x)};
+	const int64_t vy[3] {toFixed(p1.y), toFixed(p2.y), toFixed(p3.y)};
+
+	// NOTE: twice the signed area, the edges are oriented so it ends up positive
+	int64_t signedArea {(vx[2] - vx[1]) * (vy[0] - vy[1]) - (vy[2] - vy[1]) * (vx[0] - vx[1])};
+	if (signedArea == 0) return;
+	bool flip {signedArea < 0};
+	area = flip ? -signedArea : signedArea;
+
+	for (int i = 0; i < 3; i++) {
+		int from {(i + 1) % 3};
+		int to {(i + 2) % 3};
+		if (flip) std::swap(from, to);
+		int64_t dx {vx[to] - vx[from]};
+		int64_t dy {vy[to] - vy[from]};
+
+		Edge& edge = edges[i];
+		edge.a = -dy;
+		edge.b = dx;
+		edge.c = dy * vx[from] - dx * vy[from];
+		// NOTE: a top edge is horizontal with the triangle below it, a left edge goes up
+		bool topLeft {(dy == 0 && dx > 0) || dy < 0};
+		edge.bias = topLeft ? 0 : -1;
+	}
+
+	auto floorPixel = [](int64_t v) { return static_cast<int>(v >> subPixelBits); };
+	auto ceilPixel = [](int64_t v) { return static_cast<int>((v + (1 << subPixelBits) - 1) >> subPixelBits); };
+	minX = ceilPixel(std::min({vx[0], vx[1], vx[2]}));
+	minY = ceilPixel(std::min({vy[0], vy[1], vy[2]}));
+	maxX = floorPixel(std::max({vx[0], vx[1], vx[2]}));
+	maxY = floorPixel(std::max({vy[0], vy[1], vy[2]}));
+}
+
+void cdr::TriangleRasterizer::GetEdgeValues(int x, int y, int64_t values[3]) const {
+	for (int i = 0; i < 3; i++) {
+		values[i] = edges[i].At(x, y);
+	}
+}
+void cdr::TriangleRasterizer::GetEdgeStepsX(int64_t steps[3]) const {
+	for (int i = 0; i < 3; i++) {
+		steps[i] = edges[i].a * one;
+	}
+}
+void cdr::TriangleRasterizer::GetEdgeStepsY(int64_t steps[3]) const {
+	for (int i = 0; i < 3; i++) {
+		steps[i] = edges[i].b * one;
+	}
+}
+
+namespace {
+
+// moves the end points of the line that lie outside of the square from -band to band onto its border (Liang-Barsky),
+// a line that misses the square is clamped into it, it can't be visible then
+void clipToGuardBand(cdr::Point& start, cdr::Point& end, int band) {
+	auto outside = [&](const cdr::Point& p) { return p.x < -band || p.x > band || p.y < -band || p.y > band; };
+	if (!outside(start) && !outside(end)) return;
+	const double x0 {double(start.x)};
+	const double y0 {double(start.y)};
+	const double dx {double(end.x) - x0};
+	const double dy {double(end.y) - y0};
+	double t0 {0};
+	double t1 {1};
+	// keeps the part of the line where p * t <= q
+	auto clipSide = [&](double p, double q) {
+		if (p == 0) return q >= 0;
+		if (p < 0) t0 = std::max(t0, q / p);
+		else t1 = std::min(t1, q / p);
+		return t0 <= t1;
+	};
+	if (clipSide(-dx, x0 + band) && clipSide(dx, band - x0) && clipSide(-dy, y0 + band) && clipSide(dy, band - y0)) {
+		auto pointAt = [&](double t) {
+			return cdr::Point{static_cast<int>(std::lround(x0 + t * dx)), static_cast<int>(std::lround(y0 + t * dy))};
+		};
+		if (t1 < 1) end = pointAt(t1);
+		if (t0 > 0) start = pointAt(t0);
+	} else {
+		auto clamp = [&](cdr::Point& p) { p = cdr::Point{std::clamp(p.x, -band, band), std::clamp(p.y, -band, band)}; };
+		clamp(start);
+		clamp(end);
+	}
+}
+
+}
+
+cdr::LineRasterizer::LineRasterizer(Point start, Point end) {
+	clipToGuardBand(start, end, guardBand);
+	int64_t dx {int64_t(end.x) - start.x};
+	int64_t dy {int64_t(end.y) - start.y};
+	// NOTE: lines exactly at 45 degrees count as steep, like the old DDA
+	steep = std::abs(dy) >= std::abs(dx);
+	majorStart = steep ? start.y : start.x;
+	minorStart = steep ? start.x : start.y;
+	int64_t majorDelta {steep ? dy : dx};
+	minorDelta = steep ? dx : dy;
+	majorStep = majorDelta < 0 ? -1 : 1;
+	steps = std::abs(majorDelta);
+}
+
+bool cdr::LineRasterizer::clipMajor(const Rectangle& clip, int64_t& first, int64_t& last) const {
+	if (steps == 0) return false;
+	int64_t low {steep ? clip.y : clip.x};
+	int64_t high {low + (steep ? clip.height : clip.width) - 1};
+	if (majorStep > 0) {
+		first = std::max<int64_t>(0, low - majorStart);
+		last = std::min<int64_t>(steps - 1, high - majorStart);
+	} else {
+		first = std::max<int64_t>(0, majorStart - high);
+		last = std::min<int64_t>(steps - 1, majorStart - low);
+	}
+	return first <= last;
+}
+
+void cdr::LineRasterizer::getMinorRange(const Rectangle& clip, int& low, int& high) const {
+	low = steep ? clip.x : clip.y;
+	high = low + (steep ? clip.width : clip.height) - 1;
+}
+
+void cdr::EllipseRasterizer::AddTo(CoverageRasterizer& shape) const {
+	// NOTE: an ellipse is a rounded rectangle with the radii of half its size, the pixels of the coverage rasterizer start at their top left corner
+	FRectangle bounds {float(centre.x - radiusX), float(centre.y - radiusY), float(radiusX * 2 + 1), float(radiusY * 2 + 1)};
+	shape.AddRoundedRectangle(bounds, radiusX + 0.5f, radiusY + 0.5f);
+}
+
+int cdr::EllipseRasterizer::RowWalker::seek(const Shape& shape, int y) {
+	// NOTE: the square root is only a guess that is corrected with the exact decision values
+	int64_t remaining {shape.limit - 4 * int64_t(y) * y * shape.weightY};
+	if (remaining < 0) return -1;
+	int halfWidth {static_cast<int>(std::sqrt(static_cast<double>(remaining) / (4.0 * shape.weightX)))};
+	while (halfWidth > 0 && shape.At(halfWidth, y) > 0) halfWidth--;
+	while (shape.At(halfWidth + 1, y) <= 0) halfWidth++;
+	return shape.At(halfWidth, y) <= 0 ? halfWidth : -1;
+}
+
+cdr::CoverageRasterizer::CoverageRasterizer(const Rectangle& area, FrameArena& arena)
+	: area{Rectangle{area.x, area.y, std::max(0, area.width), std::max(0, area.height)}} {
+	cells = arena.Allocate<Cell>(size_t(this->area.width) * this->area.height);
+	rowStart = arena.Allocate<int>(this->area.height);
+	rowEnd = arena.Allocate<int>(this->area.height);
+	std::fill_n(rowStart, this->area.height, INT_MAX);
+	std::fill_n(rowEnd, this->area.height, INT_MIN);
+}
+
+void cdr::CoverageRasterizer::AddEdge(FPoint from, FPoint to) {
+	if (!std::isfinite(from.x) || !std::isfinite(from.y) || !std::isfinite(to.x) || !std::isfinite(to.y)) return;
+	if (area.width == 0) return;
+	auto toFixed = [](float value) {
+		return static_cast<int64_t>(std::lround(std::clamp(value, -guardBand, guardBand) * one));
+	};
+	int64_t x0 {toFixed(from.x)};
+	int64_t y0 {toFixed(from.y)};
+	int64_t x1 {toFixed(to.x)};
+	int64_t y1 {toFixed(to.y)};
+	if (y0 == y1) return;
+	// NOTE: edges going down add, edges going up subtract, the walk always goes down
+	int direction {1};
+	if (y0 > y1) {
+		std::swap(x0, x1);
+		std::swap(y0, y1);
+		direction = -1;
+	}
+	const int firstRow {static_cast<int>(std::max<int64_t>(area.y, floorDiv(y0, one)))};
+	const int lastRow {static_cast<int>(std::min<int64_t>(area.y + area.height - 1, floorDiv(y1 - 1, one)))};
+	if (firstRow > lastRow) return;
+	const int64_t dx {x1 - x0};
+	const int64_t dy {y1 - y0};
+	const int64_t left {int64_t(area.x) * one};
+	const int64_t right {int64_t(area.x + area.width) * one};
+	// NOTE: x of the edge on a row border and y of the edge on a column border, always computed from the end points
+	auto xAt = [&](int64_t y) { return x0 + floorDiv((y - y0) * dx, dy); };
+	auto yAt = [&](int64_t x) { return dx > 0 ? y0 + floorDiv((x - x0) * dy, dx) : y0 + floorDiv((x0 - x) * dy, -dx); };
+
+	for (int row = firstRow; row <= lastRow; row++) {
+		const int64_t top {std::max(y0, int64_t(row) * one)};
+		const int64_t bottom {std::min(y1, int64_t(row + 1) * one)};
+		const int64_t xTop {xAt(top)};
+		const int64_t xBottom {xAt(bottom)};
+		// the part of the edge in this row goes from low to high x, y goes from yLow to yHigh
+		const int64_t low {std::min(xTop, xBottom)};
+		const int64_t high {std::max(xTop, xBottom)};
+		if (low >= right) continue;
+		const int64_t yLow {xTop <= xBottom ? top : bottom};
+		const int64_t yHigh {xTop <= xBottom ? bottom : top};
+		auto crossing = [&](int64_t x) { return std::clamp(yAt(x), top, bottom); };
+		Cell* cell {cells + size_t(row - area.y) * area.width};
+		if (high <= left) {
+			touchCells(row - area.y, 0, 0);
+			cell[0].cover += direction * static_cast<int>(bottom - top);
+			continue;
+		}
+
+		int first {static_cast<int>(floorDiv(low, one))};
+		int last {high == low ? first : static_cast<int>(floorDiv(high - 1, one))};
+		last = std::min(last, area.x + area.width - 1);
+		touchCells(row - area.y, std::max(first, area.x) - area.x, last - area.x);
+		int64_t x {low};
+		int64_t y {yLow};
+		// NOTE: the part left of the area covers every pixel of the row right of it
+		if (first < area.x) {
+			int64_t yLeft {crossing(left)};
+			cell[0].cover += direction * static_cast<int>(std::abs(yLeft - y));
+			first = area.x;
+			x = left;
+			y = yLeft;
+		}
+		for (int column = first; column <= last; column++) {
+			const int64_t border {int64_t(column) * one};
+			const int64_t nextX {column == last ? std::min(high, border + one) : border + one};
+			const int64_t nextY {nextX == high ? yHigh : crossing(nextX)};
+			const int cover {direction * static_cast<int>(std::abs(nextY - y))};
+			cell[column - area.x].cover += cover;
+			cell[column - area.x].area += cover * static_cast<int>((x - border) + (nextX - border));
+			x = nextX;
+			y = nextY;
+		}
+	}
+}
+
+void cdr::CoverageRasterizer::AddPolygon(const FPoint* points, int count) {
+	if (count < 3) return;
+	for (int i = 0; i < count; i++) {
+		AddEdge(points[i], points[(i + 1) % count]);
+	}
+}
+
+void cdr::CoverageRasterizer::AddRoundedRectangle(const FRectangle& rectangle, float radiusX, float radiusY) {
+	if (!(rectangle.width > 0.0f) || !(rectangle.height > 0.0f)) return;
+	radiusX = std::isfinite(radiusX) ? std::clamp(radiusX, 0.0f, rectangle.width * 0.5f) : 0.0f;
+	radiusY = std::isfinite(radiusY) ? std::clamp(radiusY, 0.0f, rectangle.height * 0.5f) : 0.0f;
+	if (radiusX == 0.0f || radiusY == 0.0f) radiusX = radiusY = 0.0f;
+
+	// NOTE: a quarter of the arc is split into segments that stay within a tenth of a pixel of it (computed for the
+	// larger radius). The vertices between the ends are pushed out so every segment has the same area as the arc it replaces
+	constexpr double halfPi {1.5707963267948966};
+	constexpr double tolerance {0.1};
+	double radius {std::max(radiusX, radiusY)};
+	int segments {0};
+	if (radius > 0.0) {
+		double angle {radius > tolerance ? 2.0 * std::acos(1.0 - tolerance / radius) : halfPi};
+		segments = std::clamp(static_cast<int>(std::ceil(halfPi / angle)), 1, maxArcSegments);
+	}
+	float unitX[maxArcSegments + 1];
+	float unitY[maxArcSegments + 1];
+	const double step {segments > 0 ? halfPi / segments : 0.0};
+	const double scale {segments > 0 ? std::sqrt(step / std::sin(step)) : 1.0};
+	const double stepCos {std::cos(step)};
+	const double stepSin {std::sin(step)};
+	double c {1.0};
+	double s {0.0};
+	for (int i = 0; i <= segments; i++) {
+		bool end {i == 0 || i == segments};
+		unitX[i] = static_cast<float>(end ? c : c * scale);
+		unitY[i] = static_cast<float>(end ? s : s * scale);
+		double next {c * stepCos - s * stepSin};
+		s = s * stepCos + c * stepSin;
+		c = next;
+	}
+	unitX[segments] = 0.0f;
+	unitY[segments] = 1.0f;
+
+	const float left {rectangle.x + radiusX};
+	const float top {rectangle.y + radiusY};
+	const float right {rectangle.x + rectangle.width - radiusX};
+	const float bottom {rectangle.y + rectangle.height - radiusY};
+	// NOTE: the corners clockwise from the top left one, every one starts where the one before ended
+	FPoint first {left - radiusX, top};
+	FPoint previous {first};
+	auto addVertex = [&](float x, float y) {
+		FPoint vertex {x, y};
+		AddEdge(previous, vertex);
+		previous = vertex;
+	};
+	for (int i = 1; i <= segments; i++) addVertex(left - unitX[i] * radiusX, top - unitY[i] * radiusY);
+	for (int i = 0; i <= segments; i++) addVertex(right + unitY[i] * radiusX, top - unitX[i] * radiusY);
+	for (int i = 0; i <= segments; i++) addVertex(right + unitX[i] * radiusX, bottom + unitY[i] * radiusY);
+	for (int i = 0; i <= segments; i++) addVertex(left - unitY[i] * radiusX, bottom + unitX[i] * radiusY);
+	AddEdge(previous, first);
+}
+
+void cdr::CoverageRasterizer::touchCells(int row, int first, int last) {
+	Cell* cell {cells + size_t(row) * area.width};
+	if (rowStart[row] > rowEnd[row]) {
+		std::fill(cell + first, cell + last + 1, Cell{0, 0});
+		rowStart[row] = first;
+		rowEnd[row] = last;
+		return;
+	}
+	if (first < rowStart[row]) {
+		std::fill(cell + first, cell + rowStart[row], Cell{0, 0});
+		rowStart[row] = first;
+	}
+	if (last > rowEnd[row]) {
+		std::fill(cell + rowEnd[row] + 1, cell + last + 1, Cell{0, 0});
+		rowEnd[row] = last;
+	}
+}
@@ -0,0 +1,770 @@
+/********************************
+ * Project: Cidr				*
+ * File: rasterizer.hpp			*
+ * Date: 17.10.2026				*
+ ********************************/
+
+#ifndef CIDR_RASTERIZER_HPP
+#define CIDR_RASTERIZER_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include "point.hpp"
+#include "rectangle.hpp"
+#include "frameArena.hpp"
+
+// NOTE: Rasterizers used by the renderer, they only find the covered pixels and leave drawing them to the caller.
+//
+// Triangle rasterizer used by every triangle fill of the renderer.
+// The vertices are snapped to 24.8 fixed point and a pixel is covered if its sample point
+// (the integer pixel coordinate) is inside of all three edges, computed with 64 bit integer edge functions.
+// Pixels exactly on an edge belong to the triangle only if the edge is a top or left edge (top-left rule),
+// so triangles sharing an edge never both cover or both miss a pixel on it.
+// The bounding box is walked in 8x8 blocks: blocks outside of an edge are skipped and blocks inside
+// of all edges are accepted without testing single pixels.
+namespace cdr {
+
+class CoverageRasterizer;
+
+class TriangleRasterizer {
+public:
+	static constexpr int subPixelBits {8};
+	static constexpr int blockSize {8};
+	// NOTE: vertices are clamped to this range (in pixels) so the edge functions can't overflow
+	static constexpr int guardBand {1 << 20};
+
+	TriangleRasterizer(FPoint p1, FPoint p2, FPoint p3);
+
+	// true if the triangle has no area (or invalid coordinates) and covers nothing
+	inline bool IsEmpty() const { return area == 0; }
+
+	// calls span(x, y, count) once for every covered row inside the clip, from top to bottom.
+	// A triangle is convex so the covered pixels of a row are always one span
+	template <typename SpanFunction>
+	void Rasterize(const Rectangle& clip, SpanFunction&& span) const;
+
+	// NOTE: the edge function values of a pixel divided by the area are the barycentric weights of p1, p2 and p3.
+	// They are exact integers, so interpolating with them gives the same result no matter where a span was clipped
+	void GetEdgeValues(int x, int y, int64_t values[3]) const;
+	// how much the edge function values change from one pixel to the one right of it
+	void GetEdgeStepsX(int64_t steps[3]) const;
+	// how much the edge function values change from one pixel to the one below it
+	void GetEdgeStepsY(int64_t steps[3]) const;
+	// twice the area of the triangle in fixed point
+	inline int64_t GetArea() const { return area; }
+
+private:
+	// NOTE: a pixel in fixed point, coordinates are multiplied by it instead of shifted because they can be negative
+	static constexpr int64_t one {int64_t(1) << subPixelBits};
+
+	struct Edge {
+		// E(X, Y) = a * X + b * Y + c with X and Y in fixed point, positive inside
+		int64_t a;
+		int64_t b;
+		int64_t c;
+		// -1 for edges that don't own the pixels exactly on them
+		int64_t bias;
+
+		inline int64_t At(int x, int y) const {
+			return a * (x * one) + b * (y * one) + c;
+		}
+	};
+
+	// edges[i] is the edge opposite of vertex i
+	Edge edges[3];
+	int64_t area {0};
+	// bounding box in pixels, inclusive
+	int minX {0};
+	int minY {0};
+	int maxX {-1};
+	int maxY {-1};
+};
+
+template <typename SpanFunction>
+void TriangleRasterizer::Rasterize(const Rectangle& clip, SpanFunction&& span) const {
+	if (IsEmpty()) return;
+	int startX {std::max(minX, clip.x)};
+	int startY {std::max(minY, clip.y)};
+	int endX {std::min(maxX, clip.x + clip.width - 1)};
+	int endY {std::min(maxY, clip.y + clip.height - 1)};
+	if (startX > endX || startY > endY) return;
+
+	const int64_t stepX[3] {edges[0].a * one, edges[1].a * one, edges[2].a * one};
+
+	for (int bandY = startY; bandY <= endY; bandY += blockSize) {
+		int bandEndY {std::min(bandY + blockSize - 1, endY)};
+		int rows {bandEndY - bandY + 1};
+		int rowStart[blockSize];
+		int rowEnd[blockSize];
+		std::fill_n(rowStart, rows, INT_MAX);
+		std::fill_n(rowEnd, rows, INT_MIN);
+
+		for (int blockX = startX; blockX <= endX; blockX += blockSize) {
+			int blockEndX {std::min(blockX + blockSize - 1, endX)};
+
+			// NOTE: the edge functions are linear, so the corners are enough to tell
+			// if the whole block is inside or outside of an edge
+			bool rejected {false};
+			bool accepted {true};
+			for (const Edge& edge : edges) {
+				int64_t e00 {edge.At(blockX, bandY) + edge.bias};
+				int64_t e10 {edge.At(blockEndX, bandY) + edge.bias};
+				int64_t e01 {edge.At(blockX, bandEndY) + edge.bias};
+				int64_t e11 {edge.At(blockEndX, bandEndY) + edge.bias};
+				if (std::max({e00, e10, e01, e11}) < 0) {
+					rejected = true;
+					break;
+				}
+				accepted &= std::min({e00, e10, e01, e11}) >= 0;
+			}
+			if (rejected) continue;
+
+			if (accepted) {
+				for (int row = 0; row < rows; row++) {
+					rowStart[row] = std::min(rowStart[row], blockX);
+					rowEnd[row] = std::max(rowEnd[row], blockEndX);
+				}
+				continue;
+			}
+
+			for (int row = 0; row < rows; row++) {
+				int64_t e0 {edges[0].At(blockX, bandY + row) + edges[0].bias};
+				int64_t e1 {edges[1].At(blockX, bandY + row) + edges[1].bias};
+				int64_t e2 {edges[2].At(blockX, bandY + row) + edges[2].bias};
+				for (int x = blockX; x <= blockEndX; x++) {
+					if ((e0 | e1 | e2) >= 0) {
+						rowStart[row] = std::min(rowStart[row], x);
+						rowEnd[row] = std::max(rowEnd[row], x);
+					}
+					e0 += stepX[0];
+					e1 += stepX[1];
+					e2 += stepX[2];
+				}
+			}
+		}
+
+		for (int row = 0; row < rows; row++) {
+			if (rowStart[row] <= rowEnd[row]) {
+				span(rowStart[row], bandY + row, rowEnd[row] - rowStart[row] + 1);
+			}
+		}
+	}
+}
+
+// NOTE: Line rasterizer used by DrawLine. A line takes one step per pixel along its major axis
+// (x for shallow lines, y for steep ones) and the minor coordinate is tracked as an integer plus a
+// remainder, so stepping never touches floating point (Bresenham, or Xiaolin Wu for anti aliasing).
+// Before walking, the range of steps is clipped against the clip rectangle (parametric clipping as
+// in Liang-Barsky, done on the steps themselves so the clipped line has exactly the same pixels),
+// so a line that is mostly outside of the clip only costs its visible part.
+// Like the old DDA the end point itself isn't part of the line.
+// Any int coordinates work, end points far outside of the canvas are moved onto the guard band first.
+class LineRasterizer {
+public:
+	// NOTE: end points outside of this range (in pixels) are moved along the line onto its border so the steps can't overflow
+	static constexpr int guardBand {1 << 20};
+
+	LineRasterizer(Point start, Point end);
+
+	// calls plot(x, y) for every pixel of the line inside of the clip
+	template <typename PlotFunction>
+	void Rasterize(const Rectangle& clip, PlotFunction&& plot) const;
+	// calls plot(x, y, coverage) for the two pixels the line passes between at every step,
+	// coverage goes from 1 to 255 (pixels without coverage are skipped)
+	template <typename PlotFunction>
+	void RasterizeAA(const Rectangle& clip, PlotFunction&& plot) const;
+
+	// number of steps (pixels along the major axis), 0 if start and end are the same point
+	inline int64_t GetStepCount() const { return steps; }
+	inline bool IsSteep() const { return steep; }
+
+private:
+	// true if y is the major axis
+	bool steep {false};
+	int majorStart {0};
+	int minorStart {0};
+	// +1 or -1
+	int majorStep {1};
+	// how far the minor coordinate moves over all steps (signed, |minorDelta| <= steps)
+	int64_t minorDelta {0};
+	int64_t steps {0};
+
+	static inline int64_t floorDiv(int64_t a, int64_t b) {
+		// NOTE: b is always positive
+		int64_t q {a / b};
+		return (a % b < 0) ? q - 1 : q;
+	}
+	// the steps whose major coordinate lies inside of the clip, false if there are none
+	bool clipMajor(const Rectangle& clip, int64_t& first, int64_t& last) const;
+	// the minor axis range of the clip, inclusive
+	void getMinorRange(const Rectangle& clip, int& low, int& high) const;
+	// narrows the steps down to the ones where minorAt(step) lies inside of [low, high].
+	// minorAt is monotonic, so the ends are found with a binary search (it's skipped if the whole range is visible)
+	template <typename MinorFunction>
+	static bool clipMinor(int64_t& first, int64_t& last, int low, int high, const MinorFunction& minorAt);
+	template <typename PlotFunction>
+	void rasterize(const Rectangle& clip, PlotFunction&& plot) const;
+	template <typename PlotFunction>
+	void rasterizeAA(const Rectangle& clip, PlotFunction&& plot) const;
+};
+
+template <typename PlotFunction>
+void LineRasterizer::Rasterize(const Rectangle& clip, PlotFunction&& plot) const {
+	if (steep) {
+		rasterize(clip, [&](int major, int minor) { plot(minor, major); });
+	} else {
+		rasterize(clip, [&](int major, int minor) { plot(major, minor); });
+	}
+}
+template <typename PlotFunction>
+void LineRasterizer::RasterizeAA(const Rectangle& clip, PlotFunction&& plot) const {
+	if (steep) {
+		rasterizeAA(clip, [&](int major, int minor, int coverage) { plot(minor, major, coverage); });
+	} else {
+		rasterizeAA(clip, [&](int major, int minor, int coverage) { plot(major, minor, coverage); });
+	}
+}
+
+template <typename MinorFunction>
+bool LineRasterizer::clipMinor(int64_t& first, int64_t& last, int low, int high, const MinorFunction& minorAt) {
+	int firstMinor {minorAt(first)};
+	int lastMinor {minorAt(last)};
+	if (std::min(firstMinor, lastMinor) >= low && std::max(firstMinor, lastMinor) <= high) return true;
+	
+	// returns the first step in [from, to) for which isPast is true (isPast goes from false to true once), to if there is none
+	auto findFirst = [](int64_t from, int64_t to, auto&& isPast) {
+		while (from < to) {
+			int64_t middle {from + (to - from) / 2};
+			if (isPast(middle)) to = middle;
+			else from = middle + 1;
+		}
+		return from;
+	};
+	int64_t end {last + 1};
+	if (lastMinor >= firstMinor) {
+		first = findFirst(first, end, [&](int64_t step) { return minorAt(step) >= low; });
+		last = findFirst(first, end, [&](int64_t step) { return minorAt(step) > high; }) - 1;
+	} else {
+		first = findFirst(first, end, [&](int64_t step) { return minorAt(step) <= high; });
+		last = findFirst(first, end, [&](int64_t step) { return minorAt(step) < low; }) - 1;
+	}
+	return first <= last;
+}
+
+template <typename PlotFunction>
+void LineRasterizer::rasterize(const Rectangle& clip, PlotFunction&& plot) const {
+	int64_t first;
+	int64_t last;
+	if (!clipMajor(clip, first, last)) return;
+	int low;
+	int high;
+	getMinorRange(clip, low, high);
+	// NOTE: the minor coordinate of a step is the exact position rounded, minorStart + round(step * minorDelta / steps)
+	const int64_t denominator {2 * steps};
+	auto minorAt = [&](int64_t step) {
+		return minorStart + static_cast<int>(floorDiv(2 * step * minorDelta + steps, denominator));
+	};
+	if (!clipMinor(first, last, low, high, minorAt)) return;
+
+	int64_t numerator {2 * first * minorDelta + steps};
+	int64_t whole {floorDiv(numerator, denominator)};
+	int minor {minorStart + static_cast<int>(whole)};
+	int64_t remainder {numerator - whole * denominator};
+	int major {majorStart + majorStep * static_cast<int>(first)};
+	const int64_t remainderStep {2 * minorDelta};
+	for (int64_t step = first; step <= last; step++) {
+		plot(major, minor);
+		major += majorStep;
+		remainder += remainderStep;
+		if (remainder >= denominator) {
+			remainder -= denominator;
+			minor++;
+		} else if (remainder < 0) {
+			remainder += denominator;
+			minor--;
+		}
+	}
+}
+
+template <typename PlotFunction>
+void LineRasterizer::rasterizeAA(const Rectangle& clip, PlotFunction&& plot) const {
+	int64_t first;
+	int64_t last;
+	if (!clipMajor(clip, first, last)) return;
+	int low;
+	int high;
+	getMinorRange(clip, low, high);
+	// NOTE: the line passes between the pixels minor and minor + 1, minor is the exact position rounded down
+	auto minorAt = [&](int64_t step) {
+		return minorStart + static_cast<int>(floorDiv(step * minorDelta, steps));
+	};
+	if (!clipMinor(first, last, low - 1, high, minorAt)) return;
+
+	int64_t numerator {first * minorDelta};
+	int64_t whole {floorDiv(numerator, steps)};
+	int minor {minorStart + static_cast<int>(whole)};
+	int64_t remainder {numerator - whole * steps};
+	int major {majorStart + majorStep * static_cast<int>(first)};
+	// NOTE: coverage = remainder / steps * 255 with a 32 bit fixed point reciprocal instead of a division per pixel
+	const uint64_t coverageScale {(uint64_t(255) << 32) / static_cast<uint64_t>(steps)};
+	for (int64_t step = first; step <= last; step++) {
+		// the further the line is from minor, the more it covers minor + 1
+		int coverage {static_cast<int>((static_cast<uint64_t>(remainder) * coverageScale) >> 32)};
+		if (coverage < 255 && minor >= low) {
+			plot(major, minor, 255 - coverage);
+		}
+		if (coverage > 0 && minor + 1 <= high) {
+			plot(major, minor + 1, coverage);
+		}
+		major += majorStep;
+		remainder += minorDelta;
+		if (remainder >= steps) {
+			remainder -= steps;
+			minor++;
+		} else if (remainder < 0) {
+			remainder += steps;
+			minor--;
+		}
+	}
+}
+
+// NOTE: Ellipse rasterizer used by the circles and ellipses of the renderer (a circle is an ellipse with equal radii).
+// A pixel belongs to the ellipse if its centre is inside of the ellipse with the radii + 0.5, so it covers exactly
+// radiusX * 2 + 1 by radiusY * 2 + 1 pixels. Everything is decided with the integer midpoint decision value
+// 4 * x^2 * b^2 + 4 * y^2 * a^2 - a^2 * b^2 (a and b are the doubled radii, <= 0 inside). It is walked from the
+// middle row outwards, one row and one pixel at a time with additions only, so a row costs a few additions and no
+// square root. The ellipse is symmetric, every step gives the same row above and below the centre.
+// The covered pixels are handed to the caller as horizontal spans: one per row for the filled ellipse and up
+// to two for the one pixel wide outline (8-connected like the midpoint circle algorithm).
+// With anti aliasing the distance of a pixel to the edge is estimated from the decision value and its gradient,
+// the edge pixels come with their coverage and every pixel is part of exactly one span, so nothing is blended twice.
+class EllipseRasterizer {
+public:
+	// NOTE: radii are clamped to these so the decision values can't overflow. The one of ellipses is smaller
+	// because their decision values are scaled by both radii, circles only by one
+	static constexpr int maxCircleRadius {1 << 20};
+	static constexpr int maxEllipseRadius {1 << 14};
+	// coverage spans are handed out in pieces of at most this many pixels
+	static constexpr int chunkSize {256};
+
+	EllipseRasterizer(Point centre, int radiusX, int radiusY) : centre{centre} {
+		int maxRadius {radiusX == radiusY ? maxCircleRadius : maxEllipseRadius};
+		this->radiusX = std::min(radiusX, maxRadius);
+		this->radiusY = std::min(radiusY, maxRadius);
+	}
+
+	// true if a radius is smaller than 1, nothing is drawn then
+	inline bool IsEmpty() const { return radiusX < 1 || radiusY < 1; }
+	// NOTE: the anti aliased edge is an estimate that gets far off at the tips of thin ellipses (one radius at
+	// least 4 times the other), the renderer accumulates their exact coverage with AddTo instead
+	inline bool IsThin() const { return std::max(radiusX, radiusY) >= 4 * std::min(radiusX, radiusY); }
+	// adds the ellipse with the radii + 0.5 around the centre pixel to the shape
+	void AddTo(CoverageRasterizer& shape) const;
+	// the pixels the ellipse can cover, anti aliased edges reach one pixel further
+	inline Rectangle GetBounds(bool AA) const {
+		int padding {AA ? 1 : 0};
+		return Rectangle{centre.x - radiusX - padding, centre.y - radiusY - padding, (radiusX + padding) * 2 + 1, (radiusY + padding) * 2 + 1};
+	}
+
+	// calls span(x, y, count) once for every row of the filled ellipse inside the clip.
+	// The rows come in pairs from the middle outwards, not from top to bottom
+	template <typename SpanFunction>
+	void Rasterize(const Rectangle& clip, SpanFunction&& span) const;
+	// same for the outline, a row has one span at the top and bottom of the ellipse and two at its sides
+	template <typename SpanFunction>
+	void RasterizeOutline(const Rectangle& clip, SpanFunction&& span) const;
+	// calls span(x, y, count, coverage) for the filled ellipse with an anti aliased edge. coverage is nullptr
+	// for the pixels fully inside, otherwise it points to count coverages from 1 to 255 (pixels without coverage are skipped)
+	template <typename SpanFunction>
+	void RasterizeAA(const Rectangle& clip, SpanFunction&& span) const;
+	// same for an anti aliased outline one pixel wide, all of its spans come with a coverage
+	template <typename SpanFunction>
+	void RasterizeOutlineAA(const Rectangle& clip, SpanFunction&& span) const;
+
+private:
+	// NOTE: the ellipse with the doubled radii a and b, At(x, y) is the decision value of the pixel x, y
+	// relative to the centre. For circles the weights are divided by a^2 so the values stay small
+	struct Shape {
+		int64_t weightX;
+		int64_t weightY;
+		int64_t limit;
+		// only the pixels from -columns to columns and -rows to rows can be inside
+		int columns;
+		int rows;
+
+		Shape(int a, int b) : columns{a / 2}, rows{b / 2} {
+			int64_t a2 {int64_t(a) * a};
+			int64_t b2 {int64_t(b) * b};
+			weightX = a == b ? 1 : b2;
+			weightY = a == b ? 1 : a2;
+			limit = a == b ? a2 : a2 * b2;
+		}
+		inline int64_t At(int64_t x, int64_t y) const { return 4 * (x * x * weightX + y * y * weightY) - limit; }
+	};
+	// the half width of a shape (the largest x of a row that is inside, -1 if there is none), walked
+	// from row y to y + 1 with y >= 0, where the half width can only get smaller
+	class RowWalker {
+	public:
+		// NOTE: the middle row is as wide as the shape, other rows are searched for
+		RowWalker(const Shape& shape, int y)
+			: weightX{shape.weightX}, weightY{shape.weightY}, halfWidth{y == 0 ? shape.columns : seek(shape, y)} {
+			value = shape.At(halfWidth, y);
+			rowStep = 4 * weightY * (2 * int64_t(y) + 1);
+			pixelStep = 4 * weightX * (2 * int64_t(halfWidth) - 1);
+		}
+		inline int GetHalfWidth() const { return halfWidth; }
+		inline void Next() {
+			value += rowStep;
+			rowStep += 8 * weightY;
+			// NOTE: while the edge is steep the half width shrinks by at most one pixel, that step is taken without a branch
+			bool outside {value > 0 && halfWidth >= 0};
+			value -= outside ? pixelStep : 0;
+			pixelStep -= outside ? 8 * weightX : 0;
+			halfWidth -= outside;
+			while (value > 0 && halfWidth >= 0) {
+				value -= pixelStep;
+				pixelStep -= 8 * weightX;
+				halfWidth--;
+			}
+		}
+	private:
+		static int seek(const Shape& shape, int y);
+
+		int64_t weightX;
+		int64_t weightY;
+		int halfWidth;
+		// decision value of the pixel halfWidth, y
+		int64_t value;
+		// how much value changes from y to y + 1 and from halfWidth to halfWidth - 1
+		int64_t rowStep;
+		int64_t pixelStep;
+	};
+
+	Point centre;
+	int radiusX {0};
+	int radiusY {0};
+
+	// NOTE: the rows of the shape inside the clip relative to the centre are first to last, the walk
+	// covers the distances from the centre nearest to farthest that are part of them. False if there are none
+	inline bool clipRows(const Rectangle& clip, const Shape& shape, int& first, int& last, int& nearest, int& farthest) const {
+		if (centre.x + shape.columns < clip.x || centre.x - shape.columns >= clip.x + clip.width) return false;
+		first = std::max(-shape.rows, clip.y - centre.y);
+		last = std::min(shape.rows, clip.y + clip.height - 1 - centre.y);
+		if (first > last) return false;
+		nearest = first > 0 ? first : last < 0 ? -last : 0;
+		farthest = std::max(-first, last);
+		return true;
+	}
+	// calls row(y) for y and -y if they are between first and last
+	template <typename RowFunction>
+	static inline void forRows(int distance, int first, int last, RowFunction&& row) {
+		if (distance >= first && distance <= last) row(distance);
+		if (distance != 0 && -distance >= first && -distance <= last) row(-distance);
+	}
+	// calls span for the pixels from left to right (relative to the centre) of row y inside the clip
+	template <typename SpanFunction>
+	void emitSpan(const Rectangle& clip, int y, int left, int right, SpanFunction&& span) const;
+	// calls span with the coverages coverageAt(x) of the pixels from left to right, split into runs of covered pixels
+	template <typename CoverageFunction, typename SpanFunction>
+	void emitCoverage(const Rectangle& clip, int y, int left, int right, const CoverageFunction& coverageAt, SpanFunction&& span) const;
+	// the length of the gradient of a decision value divided by 8, without a square root (error below 2%)
+	static inline int64_t gradientLength(const Shape& shape, int x, int y) {
+		int64_t gx {std::abs(int64_t(x)) * shape.weightX};
+		int64_t gy {std::abs(int64_t(y)) * shape.weightY};
+		int64_t high {std::max(gx, gy)};
+		int64_t low {std::min(gx, gy)};
+		return std::max(high + low * 5 / 32, high * 27 / 32 + low * 71 / 128);
+	}
+	// the coverage of a pixel by the filled ellipse, 0.5 - the distance to the edge
+	static inline int fillCoverage(const Shape& edge, int x, int y) {
+		int64_t length {gradientLength(edge, x, y)};
+		if (length == 0) return 255;
+		float coverage {static_cast<float>(4 * length - edge.At(x, y)) * (255.0f / 8.0f) / static_cast<float>(length)};
+		return static_cast<int>(std::clamp(coverage, 0.0f, 255.0f));
+	}
+	// the coverage of a pixel by the outline, 1 - the distance to the edge
+	static inline int outlineCoverage(const Shape& edge, int x, int y) {
+		int64_t length {gradientLength(edge, x, y)};
+		if (length == 0) return 0;
+		int64_t value {edge.At(x, y)};
+		float coverage {static_cast<float>(8 * length - (value < 0 ? -value : value)) * (255.0f / 8.0f) / static_cast<float>(length)};
+		return static_cast<int>(std::clamp(coverage, 0.0f, 255.0f));
+	}
+};
+
+template <typename SpanFunction>
+void EllipseRasterizer::Rasterize(const Rectangle& clip, SpanFunction&& span) const {
+	if (IsEmpty()) return;
+	Shape edge {2 * radiusX + 1, 2 * radiusY + 1};
+	int first, last, nearest, farthest;
+	if (!clipRows(clip, edge, first, last, nearest, farthest)) return;
+	RowWalker walker {edge, nearest};
+	for (int distance = nearest; distance <= farthest; distance++) {
+		int halfWidth {walker.GetHalfWidth()};
+		forRows(distance, first, last, [&](int y) { emitSpan(clip, y, -halfWidth, halfWidth, span); });
+		walker.Next();
+	}
+}
+
+template <typename SpanFunction>
+void EllipseRasterizer::RasterizeOutline(const Rectangle& clip, SpanFunction&& span) const {
+	if (IsEmpty()) return;
+	Shape edge {2 * radiusX + 1, 2 * radiusY + 1};
+	int first, last, nearest, farthest;
+	if (!clipRows(clip, edge, first, last, nearest, farthest)) return;
+	// NOTE: a row of the outline reaches from its own half width back to one pixel past the half width
+	// of the row one further away from the centre, so the outline has no gaps where the edge is flat
+	RowWalker walker {edge, nearest};
+	for (int distance = nearest; distance <= farthest; distance++) {
+		int halfWidth {walker.GetHalfWidth()};
+		walker.Next();
+		int inner {std::min(walker.GetHalfWidth() + 1, halfWidth)};
+		forRows(distance, first, last, [&](int y) {
+			if (inner <= 0) {
+				emitSpan(clip, y, -halfWidth, halfWidth, span);
+			} else {
+				emitSpan(clip, y, -halfWidth, -inner, span);
+				emitSpan(clip, y, inner, halfWidth, span);
+			}
+		});
+	}
+}
+
+template <typename SpanFunction>
+void EllipseRasterizer::RasterizeAA(const Rectangle& clip, SpanFunction&& span) const {
+	if (IsEmpty()) return;
+	// NOTE: pixels inside the ellipse half a pixel smaller are fully covered, the ones outside of the ellipse
+	// half a pixel bigger aren't covered at all, only the band in between needs a coverage
+	Shape inside {2 * radiusX, 2 * radiusY};
+	Shape edge {2 * radiusX + 1, 2 * radiusY + 1};
+	Shape outside {2 * radiusX + 2, 2 * radiusY + 2};
+	int first, last, nearest, farthest;
+	if (!clipRows(clip, outside, first, last, nearest, farthest)) return;
+	RowWalker innerWalker {inside, nearest};
+	RowWalker outerWalker {outside, nearest};
+	for (int distance = nearest; distance <= farthest; distance++) {
+		int inner {innerWalker.GetHalfWidth()};
+		int outer {outerWalker.GetHalfWidth()};
+		forRows(distance, first, last, [&](int y) {
+			auto coverageAt = [&](int x) { return fillCoverage(edge, x, y); };
+			if (inner < 0) {
+				emitCoverage(clip, y, -outer, outer, coverageAt, span);
+			} else {
+				emitCoverage(clip, y, -outer, -inner - 1, coverageAt, span);
+				emitSpan(clip, y, -inner, inner, [&](int x, int spanY, int count) { span(x, spanY, count, static_cast<const uint8_t*>(nullptr)); });
+				emitCoverage(clip, y, inner + 1, outer, coverageAt, span);
+			}
+		});
+		innerWalker.Next();
+		outerWalker.Next();
+	}
+}
+
+template <typename SpanFunction>
+void EllipseRasterizer::RasterizeOutlineAA(const Rectangle& clip, SpanFunction&& span) const {
+	if (IsEmpty()) return;
+	// NOTE: the outline is a band one pixel wide centred on the edge, so only pixels less than a pixel
+	// away from the edge are covered (between the ellipses one pixel smaller and one pixel bigger)
+	Shape inside {2 * radiusX - 1, 2 * radiusY - 1};
+	Shape edge {2 * radiusX + 1, 2 * radiusY + 1};
+	Shape outside {2 * radiusX + 3, 2 * radiusY + 3};
+	int first, last, nearest, farthest;
+	if (!clipRows(clip, outside, first, last, nearest, farthest)) return;
+	RowWalker innerWalker {inside, nearest};
+	RowWalker outerWalker {outside, nearest};
+	for (int distance = nearest; distance <= farthest; distance++) {
+		int inner {innerWalker.GetHalfWidth()};
+		int outer {outerWalker.GetHalfWidth()};
+		forRows(distance, first, last, [&](int y) {
+			auto coverageAt = [&](int x) { return outlineCoverage(edge, x, y); };
+			if (inner < 0) {
+				emitCoverage(clip, y, -outer, outer, coverageAt, span);
+			} else {
+				emitCoverage(clip, y, -outer, -inner - 1, coverageAt, span);
+				emitCoverage(clip, y, inner + 1, outer, coverageAt, span);
+			}
+		});
+		innerWalker.Next();
+		outerWalker.Next();
+	}
+}
+
+template <typename SpanFunction>
+void EllipseRasterizer::emitSpan(const Rectangle& clip, int y, int left, int right, SpanFunction&& span) const {
+	int startX {std::max(centre.x + left, clip.x)};
+	int endX {std::min(centre.x + right, clip.x + clip.width - 1)};
+	if (startX <= endX) span(startX, centre.y + y, endX - startX + 1);
+}
+
+template <typename CoverageFunction, typename SpanFunction>
+void EllipseRasterizer::emitCoverage(const Rectangle& clip, int y, int left, int right, const CoverageFunction& coverageAt, SpanFunction&& span) const {
+	int startX {std::max(centre.x + left, clip.x)};
+	int endX {std::min(centre.x + right, clip.x + clip.width - 1)};
+	uint8_t coverage[chunkSize];
+	int count {0};
+	for (int x = startX; x <= endX; x++) {
+		int value {coverageAt(x - centre.x)};
+		if (value > 0) coverage[count++] = static_cast<uint8_t>(value);
+		if (count > 0 && (value == 0 || count == chunkSize || x == endX)) {
+			int runEnd {value == 0 ? x : x + 1};
+			span(runEnd - count, centre.y + y, count, static_cast<const uint8_t*>(coverage));
+			count = 0;
+		}
+	}
+}
+
+
+// NOTE: Coverage rasterizer for anti aliased fills of any shape made of straight edges (polygons, triangles and the
+// flattened arcs of rounded rectangles and ellipses), a signed area accumulator like the ones of font-rs, stb_truetype
+// and FreeType. Every edge adds to the cells of the pixels it crosses how far it goes down in them (cover) and how much
+// of that is left of it (area), with the sign of its direction. Walking a row from left to right and summing the covers
+// gives the exact area of every pixel covered by the shape, so the cost grows with the length of the edges (and one
+// addition per pixel), not with a number of samples. The sum is clamped to 1, overlapping parts of a shape don't add up
+// (non-zero fill rule). Only inside of pixels where parts with opposite winding meet (self intersecting polygons) they
+// cancel out and the coverage is too small.
+// The pixel x, y covers the square from x, y to x + 1, y + 1. The vertices are snapped to 24.8 fixed point and every
+// crossing of an edge with a pixel border is computed from its end points with integers, so a pixel gets the same coverage
+// no matter which area (clip) the shape is rasterized in. The parts of edges left of the area only add their cover to its first pixel
+class CoverageRasterizer {
+public:
+	static constexpr int subPixelBits {8};
+	// NOTE: coordinates are clamped to this range (in pixels) so the fixed point math can't overflow
+	static constexpr float guardBand {1 << 20};
+	// most segments a quarter of an arc is split into
+	static constexpr int maxArcSegments {256};
+	// coverage spans are handed out in pieces of at most this many pixels
+	static constexpr int chunkSize {256};
+
+	// NOTE: only the pixels inside of area are rasterized, usually the bounds of the shape intersected with the clip.
+	// The cells are allocated from the arena and have to stay valid until the shape is rasterized
+	CoverageRasterizer(const Rectangle& area, FrameArena& arena);
+
+	// NOTE: the edges have to form closed shapes, anything added with AddEdge is filled like a polygon
+	void AddEdge(FPoint from, FPoint to);
+	// adds the edges of the closed polygon
+	void AddPolygon(const FPoint* points, int count);
+	// rounded rectangle with elliptic corners, the radii are clamped to half of its size
+	// (so an ellipse is a rounded rectangle with the radii of half its size)
+	void AddRoundedRectangle(const FRectangle& rectangle, float radiusX, float radiusY);
+
+	// calls span(x, y, count) for every run of pixels that are covered at least half
+	template <typename SpanFunction>
+	void Rasterize(SpanFunction&& span) const;
+	// calls span(x, y, count, coverage) for every run of covered pixels. coverage is nullptr for the pixels fully
+	// covered, otherwise it points to count coverages from 1 to 255 (pixels without coverage are skipped)
+	template <typename SpanFunction>
+	void RasterizeAA(SpanFunction&& span) const;
+
+private:
+	static constexpr int64_t one {1 << subPixelBits};
+	// the value of a fully covered pixel, cover * 2 * one - area summed over the row
+	static constexpr int fullCoverage {2 * one * one};
+
+	struct Cell {
+		// how far the edges go down (positive) or up inside of the pixel, in fixed point
+		int cover;
+		// cover times the distance of the edges to the left border of the pixel, times 2
+		int area;
+	};
+
+	Rectangle area;
+	Cell* cells {nullptr};
+	// NOTE: the first and last cell of every row an edge added something to. Only the cells in between are
+	// cleared (when an edge reaches them), so a shape doesn't cost a pass over the whole area before it is rasterized
+	int* rowStart {nullptr};
+	int* rowEnd {nullptr};
+
+	static inline int64_t floorDiv(int64_t a, int64_t b) {
+		// NOTE: b is always positive
+		int64_t q {a / b};
+		return (a % b < 0) ? q - 1 : q;
+	}
+	// makes the cells from first to last of the row part of it (clearing the ones that weren't)
+	void touchCells(int row, int first, int last);
+	template <typename SpanFunction>
+	void rasterize(bool AA, SpanFunction&& span) const;
+	// the last cell up to end that is followed only by empty cells after x, checks 8 cells at once over long runs
+	static inline int skipEmpty(const Cell* cell, int x, int end) {
+		while (x + 8 <= end) {
+			uint64_t bits[8];
+			memcpy(bits, cell + x + 1, sizeof(bits));
+			if ((bits[0] | bits[1] | bits[2] | bits[3] | bits[4] | bits[5] | bits[6] | bits[7]) != 0) break;
+			x += 8;
+		}
+		while (x < end && cell[x + 1].cover == 0 && cell[x + 1].area == 0) x++;
+		return x;
+	}
+};
+
+template <typename SpanFunction>
+void CoverageRasterizer::Rasterize(SpanFunction&& span) const {
+	rasterize(false, [&](int x, int y, int count, const uint8_t*) { span(x, y, count); });
+}
+
+template <typename SpanFunction>
+void CoverageRasterizer::RasterizeAA(SpanFunction&& span) const {
+	rasterize(true, span);
+}
+
+template <typename SpanFunction>
+void CoverageRasterizer::rasterize(bool AA, SpanFunction&& span) const {
+	uint8_t coverage[chunkSize];
+	const Cell empty {0, 0};
+	const int last {area.width - 1};
+	for (int row = 0; row < area.height; row++) {
+		if (rowStart[row] > rowEnd[row]) continue;
+		const Cell* cell {cells + size_t(row) * area.width};
+		const int y {area.y + row};
+		const int end {rowEnd[row]};
+		int cover {0};
+		auto toValue = [&](int sum) {
+			int value {(std::min(std::abs(sum), fullCoverage) * 255 + fullCoverage / 2) / fullCoverage};
+			return AA ? value : value >= 128 ? 255 : 0;
+		};
+		// NOTE: the empty cells after a pixel only have the cover, they are skipped if it has the same value as the pixel.
+		// Right of the last cell the coverage doesn't change anymore, it is 0 unless the shape reaches past the right border
+		auto skip = [&](int x, int value) {
+			if (toValue(cover) != value) return x;
+			int next {skipEmpty(cell, x, end)};
+			return next >= end ? last : next;
+		};
+		int solidStart {-1};
+		int count {0};
+		for (int x = rowStart[row]; x <= last; x++) {
+			const Cell& current {x <= end ? cell[x] : empty};
+			int sum {cover + 2 * int(one) * current.cover - current.area};
+			cover += 2 * int(one) * current.cover;
+			int value {toValue(sum)};
+			if (value == 255) {
+				if (count > 0) {
+					span(area.x + x - count, y, count, static_cast<const uint8_t*>(coverage));
+					count = 0;
+				}
+				if (solidStart < 0) solidStart = x;
+				x = skip(x, value);
+				continue;
+			}
+			if (solidStart >= 0) {
+				span(area.x + solidStart, y, x - solidStart, static_cast<const uint8_t*>(nullptr));
+				solidStart = -1;
+			}
+			if (value > 0) coverage[count++] = static_cast<uint8_t>(value);
+			if (count > 0 && (value == 0 || count == chunkSize)) {
+				int runEnd {value == 0 ? x : x + 1};
+				span(area.x + runEnd - count, y, count, static_cast<const uint8_t*>(coverage));
+				count = 0;
+			}
+			if (value == 0) x = skip(x, value);
+		}
+		if (solidStart >= 0) span(area.x + solidStart, y, last + 1 - solidStart, static_cast<const uint8_t*>(nullptr));
+		if (count > 0) span(area.x + last + 1 - count, y, count, static_cast<const uint8_t*>(coverage));
+	}
+}
+
+}
+
+#endif
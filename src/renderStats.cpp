@@ -0,0 +1,44 @@
+/********************************
+ * Project: Cidr				*
+ * File: renderStats.cpp		*
+ * Date: 17.10.2026				*
+ ********************************/
+
+#include "renderStats.hpp"
+
+void cdr::RenderStats::Reset() {
+	*this = RenderStats{};
+}
+
+cdr::RenderStats& cdr::RenderStats::operator+=(const RenderStats& other) {
+	pixelsWritten += other.pixelsWritten;
+	pixelsBlended += other.pixelsBlended;
+	shaderInvocations += other.shaderInvocations;
+	textureSamples += other.textureSamples;
+	primitivesCulled += other.primitivesCulled;
+	for (int i = 0; i < PrimitiveTypeCount; i++) {
+		primitives[i].calls += other.primitives[i].calls;
+		primitives[i].culled += other.primitives[i].culled;
+		primitives[i].nanoseconds += other.primitives[i].nanoseconds;
+	}
+	return *this;
+}
+
+const char* cdr::RenderStats::GetName(PrimitiveType type) {
+	switch (type) {
+		case PrimitiveType::Clear: return "Clear";
+		case PrimitiveType::Pixel: return "Pixel";
+		case PrimitiveType::Line: return "Line";
+		case PrimitiveType::Rectangle: return "Rectangle";
+		case PrimitiveType::FillRectangle: return "FillRectangle";
+		case PrimitiveType::Circle: return "Circle";
+		case PrimitiveType::FillCircle: return "FillCircle";
+		case PrimitiveType::Triangle: return "Triangle";
+		case PrimitiveType::FillTriangle: return "FillTriangle";
+		case PrimitiveType::FillPolygon: return "FillPolygon";
+		case PrimitiveType::TexturedTriangle: return "TexturedTriangle";
+		case PrimitiveType::Bitmap: return "Bitmap";
+		case PrimitiveType::Text: return "Text";
+		default: return "Unknown";
+	}
+}
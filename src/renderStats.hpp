@@ -0,0 +1,71 @@
+/********************************
+ * Project: Cidr				*
+ * File: renderStats.hpp		*
+ * Date: 17.10.2026				*
+ ********************************/
+
+#ifndef CIDR_RENDER_STATS_HPP
+#define CIDR_RENDER_STATS_HPP
+
+#include <array>
+#include <cstdint>
+
+namespace cdr {
+
+// NOTE: Counters a Renderer collects while drawing, see Renderer::EnableStats.
+// They are only collected if the library is compiled with CIDR_STATS defined, without it
+// the counting code doesn't exist and all counters stay 0.
+// Reset them once per frame (Renderer::ResetStats) to get per frame numbers.
+struct RenderStats {
+	enum class PrimitiveType {
+		Clear,
+		Pixel,
+		Line,
+		Rectangle,
+		FillRectangle,
+		Circle,
+		FillCircle,
+		Triangle,
+		FillTriangle,
+		FillPolygon,
+		TexturedTriangle,
+		Bitmap,
+		Text,
+		Count,
+	};
+	static constexpr int PrimitiveTypeCount {static_cast<int>(PrimitiveType::Count)};
+
+	struct PrimitiveStats {
+		uint64_t calls {0};
+		// calls that didn't write a single pixel (outside of the clip rectangle, empty or degenerate)
+		uint64_t culled {0};
+		// time spent inside of the calls
+		uint64_t nanoseconds {0};
+	};
+
+	// every pixel written to the canvas, blended or not
+	uint64_t pixelsWritten {0};
+	// the part of pixelsWritten that was blended with the canvas
+	uint64_t pixelsBlended {0};
+	// pixels a shader was evaluated for (a span shader counts every pixel of its span)
+	uint64_t shaderInvocations {0};
+	// texels sampled by DrawBitmap and textured triangles (one per pixel, no matter how many texels the filter reads)
+	uint64_t textureSamples {0};
+	// sum of PrimitiveStats::culled over all primitive types
+	uint64_t primitivesCulled {0};
+	// NOTE: only the outermost call is counted, DrawTriangle drawing three lines is one Triangle and no Line.
+	// A CommandList replays a primitive once per tile it touches and the tiles run in parallel,
+	// so there calls are counted per tile and the time is the sum over all threads
+	std::array<PrimitiveStats, PrimitiveTypeCount> primitives {};
+
+	void Reset();
+	inline const PrimitiveStats& Get(PrimitiveType type) const { return primitives[static_cast<int>(type)]; }
+	inline PrimitiveStats& Get(PrimitiveType type) { return primitives[static_cast<int>(type)]; }
+	RenderStats& operator+=(const RenderStats& other);
+
+	static const char* GetName(PrimitiveType type);
+};
+
+}
+
+#endif
@@ -5,13 +5,17 @@
  ********************************/
 
 #include "renderer.hpp"
+#include "span.hpp"
+#include "rasterizer.hpp"
 #include <cstring>
+#include <climits>
 #include <algorithm>
 #include <iterator>
 #include <cmath>
 #include <vector>
 #include <array>
 #include <thread>
+#include <stdexcept>
 #ifndef STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
@@ -21,167 +25,238 @@
 #include <stb/stb_image_write.h>
 #endif
 #include "timer.hpp"
+#ifdef CIDR_STATS
+#include <chrono>
+#endif
 
 static inline double lerp(double a, double b, double t) {
 	return a + t * (b - a);
 }
+// encodes a linear light value (0 - 65535) back to sRGB
+static inline uint8_t encodeLinear(const cdr::SRGBTables& tables, float value) {
+	return tables.toSRGB[std::clamp(static_cast<int>(value), 0, 65535) >> 4];
+}
+// mixes two colors in linear light, the alpha is mixed as it is
+static cdr::RGBA mixLinear(const cdr::RGBA& color1, const cdr::RGBA& color2, float t) {
+	const cdr::SRGBTables& tables {cdr::GetSRGBTables()};
+	auto mix = [&](uint8_t a, uint8_t b) {
+		return encodeLinear(tables, tables.toLinear[a] * (1 - t) + tables.toLinear[b] * t);
+	};
+	return cdr::RGBA(mix(color1.r, color2.r), mix(color1.g, color2.g), mix(color1.b, color2.b), color1.a * (1 - t) + color2.a * t);
+}
+
+#ifdef CIDR_STATS
+class cdr::Renderer::StatsScope {
+public:
+	StatsScope(Renderer& renderer, RenderStats::PrimitiveType type)
+		: renderer{renderer}, type{type}, active{renderer.collectStats && renderer.statsDepth == 0} {
+		if (!active) return;
+		renderer.statsDepth++;
+		pixelsWritten = renderer.stats.pixelsWritten;
+		start = std::chrono::steady_clock::now();
+	}
+	~StatsScope() {
+		if (!active) return;
+		renderer.statsDepth--;
+		RenderStats::PrimitiveStats& primitive {renderer.stats.Get(type)};
+		primitive.calls++;
+		primitive.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+		if (renderer.stats.pixelsWritten == pixelsWritten) {
+			primitive.culled++;
+			renderer.stats.primitivesCulled++;
+		}
+	}
+	StatsScope(const StatsScope& other) = delete;
+	StatsScope& operator=(const StatsScope& other) = delete;
+private:
+	Renderer& renderer;
+	RenderStats::PrimitiveType type;
+	bool active;
+	uint64_t pixelsWritten {0};
+	std::chrono::steady_clock::time_point start {};
+};
+// NOTE: without CIDR_STATS the counting compiles to nothing
+#define CIDR_STATS_SCOPE(type) StatsScope statsScope {*this, RenderStats::PrimitiveType::type}
+#define CIDR_STATS_ADD(counter, value) do { if (collectStats) stats.counter += (value); } while (0)
+#else
+#define CIDR_STATS_SCOPE(type)
+#define CIDR_STATS_ADD(counter, value) do {} while (0)
+#endif
 
-cdr::Renderer::Renderer(uint32_t* pixels, int width, int height) 
-	: pixels{pixels}, 
+cdr::Renderer::Renderer(uint32_t* pixels, int width, int height, int stride) 
+	: CanvasClip(width, height),
+	pixels{pixels}, 
 	width{width}, 
 	height{height},
+	stride{stride > 0 ? stride : width},
 	globalX(0), globalY(0) {
 }
 
+void cdr::Renderer::copySettings(const Renderer& other) {
+	ScaleType = other.ScaleType;
+	OutOfBoundsType = other.OutOfBoundsType;
+	ClampToBorderColor = other.ClampToBorderColor;
+	clip = other.clip;
+	pixels = other.pixels;
+	width = other.width;
+	height = other.height;
+	stride = other.stride;
+	useAlphaBlending = other.useAlphaBlending;
+	useLinearLight = other.useLinearLight;
+	usePremultipliedAlpha = other.usePremultipliedAlpha;
+	globalX = other.globalX;
+	globalY = other.globalY;
+	textStyle = other.textStyle;
+	glyphCache = other.glyphCache;
+	collectStats = other.collectStats;
+}
+
 void cdr::Renderer::Clear() {
-	memset(pixels, 0, width * height * sizeof(uint32_t));
-	globalX = globalY = 0;
+	Clear(0u);
 }
 void cdr::Renderer::Clear(const RGBA& color) {
-	std::fill(pixels, pixels + width * height, RGBtoUINT(color));
-	globalX = globalY = 0;
+	Clear(RGBtoUINT(color));
 }
 void cdr::Renderer::Clear(uint32_t color) {
-	std::fill(pixels, pixels + width * height, color);
+	CIDR_STATS_SCOPE(Clear);
+	addDamage(clip);
+	color = toCanvas(color);
+	CIDR_STATS_ADD(pixelsWritten, uint64_t(clip.width) * clip.height);
+	if (clip.x == 0 && clip.y == 0 && clip.width == width && clip.height == height && stride == width) {
+		std::fill(pixels, pixels + width * height, color);
+	} else {
+		for (int y = clip.y; y < clip.y + clip.height; y++) {
+			std::fill_n(pixels + getIndex(clip.x, y), clip.width, color);
+		}
+	}
 	globalX = globalY = 0;
 }
 
 void cdr::Renderer::DrawPixel(const cdr::RGBA& color, const Point& p) {
-	if(!useAlphaBlending && color.a != 0)
-		pixels[getIndex(p.x, p.y)] = RGBtoUINT(color);
-	else
-		pixels[getIndex(p.x, p.y)] = RGBtoUINT(alphaBlendColor(pixels[getIndex(p.x, p.y)], RGBtoUINT(color)));
+	DrawPixel(RGBtoUINT(color), p.x, p.y);
 }
 void cdr::Renderer::DrawPixel(const cdr::RGBA& color, int x, int y) {
-	if(!useAlphaBlending && color.a != 0)
-		pixels[getIndex(x, y)] = RGBtoUINT(color);
-	else
-		pixels[getIndex(x, y)] = RGBtoUINT(alphaBlendColor(pixels[getIndex(x, y)], RGBtoUINT(color)));
+	DrawPixel(RGBtoUINT(color), x, y);
+}
+inline uint32_t cdr::Renderer::toCanvas(uint32_t color) const {
+	return usePremultipliedAlpha ? PremultiplyPixel(color) : color;
+}
+inline void cdr::Renderer::drawPixelUnclipped(uint32_t color, int x, int y) {
+	writePixelUnclipped(toCanvas(color), x, y);
+}
+inline void cdr::Renderer::writePixelUnclipped(uint32_t color, int x, int y) {
+	uint32_t& dst {pixels[getIndex(x, y)]};
+	CIDR_STATS_ADD(pixelsWritten, 1);
+	if (!useAlphaBlending && (color & 0xff) != 0) {
+		dst = color;
+	} else {
+		CIDR_STATS_ADD(pixelsBlended, 1);
+		dst = blendPixel(dst, color);
+	}
+}
+inline uint32_t cdr::Renderer::blendPixel(uint32_t dst, uint32_t src) const {
+	if (usePremultipliedAlpha) return BlendPixelPremultiplied(dst, src);
+	return useLinearLight ? BlendPixelLinear(dst, src) : BlendPixel(dst, src);
+}
+inline void cdr::Renderer::blendSpan(uint32_t* dst, int count, uint32_t color) const {
+	if (usePremultipliedAlpha) BlendSpanPremultiplied(dst, count, color);
+	else if (useLinearLight) BlendSpanLinear(dst, count, color);
+	else BlendSpan(dst, count, color);
+}
+inline void cdr::Renderer::blendSpan(uint32_t* dst, const uint32_t* colors, int count) const {
+	if (usePremultipliedAlpha) BlendSpanPremultiplied(dst, colors, count);
+	else if (useLinearLight) BlendSpanLinear(dst, colors, count);
+	else BlendSpan(dst, colors, count);
+}
+inline void cdr::Renderer::drawTexelUnclipped(const BitmapView& bitmap, uint32_t texel, int x, int y) {
+	if (bitmap.IsPremultiplied() == usePremultipliedAlpha) {
+		writePixelUnclipped(texel, x, y);
+	} else {
+		drawPixelUnclipped(UnpremultiplyPixel(texel), x, y);
+	}
+}
+inline uint32_t cdr::Renderer::getBorderColor(const BitmapView& bitmap) const {
+	const uint32_t color {RGBtoUINT(ClampToBorderColor)};
+	return bitmap.IsPremultiplied() ? PremultiplyPixel(color) : color;
+}
+void cdr::Renderer::drawCoverageSpan(uint32_t color, const uint8_t* coverage, int x, int y, int count) {
+	CIDR_STATS_ADD(pixelsWritten, count);
+	CIDR_STATS_ADD(pixelsBlended, count);
+	// NOTE: the colors are built on the stack in chunks and blended with the span kernels
+	const uint32_t rgb {color & 0xffffff00};
+	const uint32_t alpha {color & 0xff};
+	constexpr int chunkSize {256};
+	uint32_t colors[chunkSize];
+	uint32_t* dst {pixels + getIndex(x, y)};
+	for (int i = 0; i < count; i += chunkSize) {
+		int chunkCount {std::min(chunkSize, count - i)};
+		for (int k = 0; k < chunkCount; k++) {
+			colors[k] = rgb | div255(alpha * coverage[i + k]);
+		}
+		if (usePremultipliedAlpha) PremultiplySpan(colors, colors, chunkCount);
+		blendSpan(dst + i, colors, chunkCount);
+	}
+}
+void cdr::Renderer::drawCoverageSpan(const uint32_t* colors, const uint8_t* coverage, int x, int y, int count) {
+	CIDR_STATS_ADD(pixelsWritten, count);
+	CIDR_STATS_ADD(pixelsBlended, count);
+	constexpr int chunkSize {256};
+	uint32_t scaled[chunkSize];
+	uint32_t* dst {pixels + getIndex(x, y)};
+	for (int i = 0; i < count; i += chunkSize) {
+		int chunkCount {std::min(chunkSize, count - i)};
+		for (int k = 0; k < chunkCount; k++) {
+			uint32_t color {colors[i + k]};
+			scaled[k] = (color & 0xffffff00) | div255((color & 0xff) * coverage[i + k]);
+		}
+		if (usePremultipliedAlpha) PremultiplySpan(scaled, scaled, chunkCount);
+		blendSpan(dst + i, scaled, chunkCount);
+	}
 }
 void cdr::Renderer::DrawPixel(uint32_t color, int x, int y) {
-	if (!useAlphaBlending && (color & 0xff) != 0)
-		pixels[getIndex(x, y)] = color;
-	else
-		pixels[getIndex(x, y)] = RGBtoUINT(alphaBlendColor(pixels[getIndex(x, y)], color));
+	CIDR_STATS_SCOPE(Pixel);
+	if (!isInClip(x, y)) return;
+	addDamage(Rectangle{x, y, 1, 1});
+	drawPixelUnclipped(color, x, y);
 }
 
-// TODO: Add clipping
 void cdr::Renderer::DrawLine(const cdr::RGBA& color, const Point& start, const Point& end, bool AA, bool GC) {
-	// calculate delta lengths
-	int dx {end.x - start.x}; 
-	int dy {end.y - start.y};
-
-	// get largest component (x or y) for stepping 
-	int biggest {std::max(std::abs(dx), std::abs(dy))};
-	// p is the point that runs along the line 
-	FPoint p { static_cast<float>(start.x), static_cast<float>(start.y) };
-	// calculate how far each component should move every step in the loop
-	FPoint step {dx / static_cast<float>(biggest), dy / static_cast<float>(biggest)};
+	CIDR_STATS_SCOPE(Line);
+	addDamage(std::min(start.x, end.x), std::min(start.y, end.y), std::max(start.x, end.x), std::max(start.y, end.y), AA ? 1 : 0);
+	LineRasterizer line {start, end};
+	const uint32_t colorUINT {RGBtoUINT(color)};
 	
 	// Anti aliasing disabled
 	if(!AA) {
-		
-		for(int i {0}; i < biggest; i++) {
-			// Plot point in current location 
-			DrawPixel(color, std::round(p.x), std::round(p.y));
-			// step further in line 
-			p += step;
-		}
+		line.Rasterize(clip, [&](int x, int y) {
+			drawPixelUnclipped(colorUINT, x, y);
+		});
 	}
-	// Anti aliasing enabled
+	// Anti aliasing enabled, the coverage scales the alpha of the color and the result is blended once.
+	// With gamma correction the blend happens in linear light, same as with EnableLinearLight
 	else {
-		for(int i {0}; i < biggest; i++) {
-			// line is steep
-			if(biggest == std::abs(dy)) {
-				// calculate anti aliasing values for points that are close to the line 
-				float AAValue1 = (p.x - static_cast<int>(p.x));
-				float AAValue2 = (1 - (p.x - static_cast<int>(p.x)));
-				// use gamma correction
-				if(GC) {
-					RGBA result1 {alphaBlendColorGammaCorrected(GetPixel(p.x + 1, p.y), color, AAValue1 * 255.f)};
-					RGBA result2 {alphaBlendColorGammaCorrected(GetPixel(p.x, p.y),     color, AAValue2 * 255.f)};
-					result1.a = result1.a * color.a / 255.f;
-					result2.a = result2.a * color.a / 255.f;
-					DrawPixel(alphaBlendColor(GetPixel(p.x + 1, p.y), result1, result1.a), p.x + 1, p.y);
-					DrawPixel(alphaBlendColor(GetPixel(p.x, p.y),     result2, result2.a), p.x,     p.y);
-				}
-				else {
-					DrawPixel(alphaBlendColor(GetPixel(p.x + 1, p.y), color, AAValue1 * color.a), p.x + 1, p.y);
-					DrawPixel(alphaBlendColor(GetPixel(p.x,     p.y), color, AAValue2 * color.a), p.x,     p.y); 
-				}
-			}
-			// line is shallow
-			else {
-				// calculate anti aliasing values for points that are close to the line 
-				float AAValue1 = (p.y - static_cast<int>(p.y));
-				float AAValue2 = (1 - (p.y - static_cast<int>(p.y)));
-				// use gamma correction
-				if(GC) {
-					RGBA result1 {alphaBlendColorGammaCorrected(GetPixel(p.x, p.y + 1), color, AAValue1 * 255.f)};
-					RGBA result2 {alphaBlendColorGammaCorrected(GetPixel(p.x, p.y),     color, AAValue2 * 255.f)};
-					result1.a = result1.a * color.a / 255.f;
-					result2.a = result2.a * color.a / 255.f;
-					DrawPixel(alphaBlendColor(GetPixel(p.x, p.y + 1), result1, result1.a), p.x, p.y + 1);
-					DrawPixel(alphaBlendColor(GetPixel(p.x, p.y),     result2, result2.a), p.x, p.y);
-				}
-				else {
-					DrawPixel(alphaBlendColor(GetPixel(p.x, p.y + 1), color, AAValue1 * color.a), p.x, p.y + 1);
-					DrawPixel(alphaBlendColor(GetPixel(p.x, p.y),     color, AAValue2 * color.a), p.x, p.y);
-				}
-			}
-			
-			// step further in line 
-			p += step;
-		}
+		bool linear {(GC || useLinearLight) && !usePremultipliedAlpha};
+		line.RasterizeAA(clip, [&](int x, int y, int coverage) {
+			CIDR_STATS_ADD(pixelsWritten, 1);
+			CIDR_STATS_ADD(pixelsBlended, 1);
+			uint32_t& dst {pixels[getIndex(x, y)]};
+			uint32_t src {(colorUINT & 0xffffff00) | div255(coverage * color.a)};
+			dst = linear ? BlendPixelLinear(dst, src) : blendPixel(dst, toCanvas(src));
+		});
 	}
 }
 
 void cdr::Renderer::DrawRectangle(const RGBA& color, Rectangle rectangle) {
-	// exit if the rectangle is outside of the screen
-	if(rectangle.x >= this->width) return;
-	if(rectangle.y >= this->height) return;
-	if(rectangle.x + rectangle.width - 1 < 0) return;
-	if(rectangle.y + rectangle.height - 1 < 0) return;
-	
-	// clamp locations
-	Point clampedLocation {rectangle.x, rectangle.y};
-	if(rectangle.x < 0) {
-		rectangle.width -= std::abs(clampedLocation.x);
-		clampedLocation.x = 0;
-		// exit function if rectangle is outside of screen
-		if(rectangle.width < 0) 
-			return;
-	}
-	if(rectangle.y < 0) {
-		rectangle.height -= std::abs(clampedLocation.y);
-		clampedLocation.y = 0;
-		// exit function if rectangle is outside of screen
-		if(rectangle.height < 0) 
-			return;
-	}
-	int clampedWidth {std::min(this->width - clampedLocation.x, rectangle.width)};
-	int clampedHeight {std::min(this->height - clampedLocation.y, rectangle.height)};
-	
-	// loop till the itrating value hits the rectangle end or if it goes outside of the screen
-	for(int i = clampedLocation.x + 1; i < clampedLocation.x + clampedWidth; i++) {
-		// top side
-		if(rectangle.y >= 0)
-			DrawPixel(color, i, clampedLocation.y);
-		// bottom side
-		if(clampedLocation.y + rectangle.height - 1 < this->height)
-			DrawPixel(color, i, clampedLocation.y + rectangle.height - 1);
-	}
-	// loop till the itrating value hits the rectangle end or if it goes outside of the screen
-	for(int i = clampedLocation.y; i < clampedLocation.y + clampedHeight; i++) {
-		// left side
-		if(rectangle.x >= 0)
-			DrawPixel(color, clampedLocation.x, i);
-		// right side
-		if(clampedLocation.x + rectangle.width - 1< this->width)
-			DrawPixel(color, clampedLocation.x + rectangle.width - 1, i);
-	}
+	CIDR_STATS_SCOPE(Rectangle);
+	if (rectangle.width <= 0 || rectangle.height <= 0) return;
+	addDamage(rectangle);
+	const uint32_t colorUINT {RGBtoUINT(color)};
+	rasterizeOutline(rectangle,
+		[&](int startX, int endX, int y) { drawScanLine(colorUINT, startX, endX, y); },
+		[&](int x, int y) { drawPixelUnclipped(colorUINT, x, y); });
 }
 void cdr::Renderer::FillRectangle(const RGBA& color, Rectangle rectangle) {
+	CIDR_STATS_SCOPE(FillRectangle);
 	// exit if the rectangle is outside of the screen
 	if(rectangle.x >= this->width) return;
 	if(rectangle.y >= this->height) return;
@@ -192,801 +267,478 @@ void cdr::Renderer::FillRectangle(const RGBA& color, Rectangle rectangle) {
 	}
 	
 	// clamp locations
-	Point clampedLocation {rectangle.x, rectangle.y};
-	if(rectangle.x < 0) {
-		rectangle.width -= std::abs(clampedLocation.x);
-		clampedLocation.x = 0;
-		// exit function if rectangle is outside of screen
-		if(rectangle.width < 0) 
-			return;
-	}
-	if(rectangle.y < 0) {
-		rectangle.height -= std::abs(clampedLocation.y);
-		clampedLocation.y = 0;
-		// exit function if rectangle is outside of screen
-		if(rectangle.height < 0) 
-			return;
-	}
-	int clampedWidth {std::min(this->width - clampedLocation.x, rectangle.width)};
-	int clampedHeight {std::min(this->height - clampedLocation.y, rectangle.height)};
+	Rectangle visible {clipRectangle(rectangle)};
+	addDamage(visible);
+	Point clampedLocation {visible.x, visible.y};
+	int clampedWidth {visible.width};
+	int clampedHeight {visible.height};
+	uint32_t colorUINT {toCanvas(RGBtoUINT(color))};
+	CIDR_STATS_ADD(pixelsWritten, uint64_t(clampedWidth) * clampedHeight);
 	if (!useAlphaBlending) {
 		for(int i = 0; i < clampedHeight; i++) {
-			std::fill_n(pixels + getIndex(clampedLocation.x, clampedLocation.y + i), clampedWidth, RGBtoUINT(color));
+			FillSpan(pixels + getIndex(clampedLocation.x, clampedLocation.y + i), clampedWidth, colorUINT);
 		}
 	} else {
-		for (int x = clampedLocation.x; x < clampedLocation.x + clampedWidth; x++) {
-			for (int y = clampedLocation.y; y < clampedLocation.y + clampedHeight; y++) {
-				pixels[getIndex(x, y)] = RGBtoUINT(alphaBlendColor(pixels[getIndex(x, y)], RGBtoUINT(color)));
-			}
+		CIDR_STATS_ADD(pixelsBlended, uint64_t(clampedWidth) * clampedHeight);
+		for(int i = 0; i < clampedHeight; i++) {
+			blendSpan(pixels + getIndex(clampedLocation.x, clampedLocation.y + i), clampedWidth, colorUINT);
 		}
 	}
 }
 void cdr::Renderer::FillRectangle(RGBA (*shader)(const Renderer& renderer, int x, int y), Rectangle rectangle) {
+	fillRectangle(&shadePixels<RGBA (*)(const Renderer&, int, int)>, &shader, rectangle);
+}
+void cdr::Renderer::fillRectangle(SpanShadeFunction shade, const void* shader, Rectangle rectangle) {
+	CIDR_STATS_SCOPE(FillRectangle);
 	// exit if the rectangle is outside of the screen
 	if(rectangle.x >= this->width) return;
 	if(rectangle.y >= this->height) return;
 	
 	// clamp locations
-	Point clampedLocation {rectangle.x, rectangle.y};
-	if(rectangle.x < 0) {
-		rectangle.width -= std::abs(clampedLocation.x);
-		clampedLocation.x = 0;
-		// exit function if rectangle is outside of screen
-		if(rectangle.width < 0) 
-			return;
-	}
-	if(rectangle.y < 0) {
-		rectangle.height -= std::abs(clampedLocation.y);
-		clampedLocation.y = 0;
-		// exit function if rectangle is outside of screen
-		if(rectangle.height < 0) 
-			return;
-	}
-	int clampedWidth {std::min(this->width - clampedLocation.x, rectangle.width)};
-	int clampedHeight {std::min(this->height - clampedLocation.y, rectangle.height)};
+	Rectangle visible {clipRectangle(rectangle)};
+	if (visible.width <= 0 || visible.height <= 0) return;
+	addDamage(visible);
+	CIDR_STATS_ADD(shaderInvocations, uint64_t(visible.width) * visible.height);
 	
-	std::vector<std::vector<uint32_t>> shadedPixels{};
-	for (int y = clampedLocation.y; y < clampedLocation.y + clampedHeight; y++) {
-		shadedPixels.push_back(std::vector<uint32_t>{});
-		for (int x = clampedLocation.x; x < clampedLocation.x + clampedWidth; x++) {
-			shadedPixels[y - clampedLocation.y].push_back(RGBtoUINT(shader(*this, x, y)));
-		}
+	// NOTE: everything is shaded before anything is written so shaders which read the canvas see the original pixels
+	FrameArena::Scope scratch {frameArena};
+	uint32_t* shadedPixels {frameArena.Allocate<uint32_t>(visible.width * visible.height)};
+	for (int y = 0; y < visible.height; y++) {
+		shade(shader, *this, visible.x, visible.x + visible.width, visible.y + y, shadedPixels + y * visible.width);
 	}
 	
-	for (int y = clampedLocation.y; y <	 clampedLocation.y + clampedHeight; y++) {
-		memcpy(pixels + getIndex(clampedLocation.x, y), shadedPixels[y - clampedLocation.y].data(), clampedWidth * sizeof(uint32_t));
+	for (int y = 0; y < visible.height; y++) {
+		drawSpan(shadedPixels + y * visible.width, visible.x, visible.y + y, visible.width);
 	}
 }
 
 void cdr::Renderer::DrawCircle(const RGBA& color, const Point& centreLocation, int radius, bool AA) {
-	if(radius < 1) return;
-	if(radius == 1) DrawPixel(color, centreLocation);
-	
-	float x{static_cast<float>(radius)};
-	float y{};
-	
-	while((int)x > (int)y) {
-		x = sqrt(x * x - 2 * y - 1);
-		
-		if(!AA) {
-			DrawPixel(color, (int) x + centreLocation.x, (int) y + centreLocation.y);	
-			DrawPixel(color, (int)-x + centreLocation.x, (int) y + centreLocation.y);
-			DrawPixel(color, (int) x + centreLocation.x, (int)-y + centreLocation.y);
-			DrawPixel(color, (int)-x + centreLocation.x, (int)-y + centreLocation.y);
-			DrawPixel(color, (int) y + centreLocation.x, (int) x + centreLocation.y);
-			DrawPixel(color, (int)-y + centreLocation.x, (int) x + centreLocation.y);
-			DrawPixel(color, (int) y + centreLocation.x, (int)-x + centreLocation.y);
-			DrawPixel(color, (int)-y + centreLocation.x, (int)-x + centreLocation.y);
-		}
-		else {
-			float AAValue1 = 255 * (x - static_cast<int>(x));
-			float AAValue2 = 255 * (1 - (x - static_cast<int>(x)));
-			
-			DrawPixel(alphaBlendColor(GetPixel((int) x + centreLocation.x, (int) y + centreLocation.y), color, AAValue1), (int)x + centreLocation.x, (int)y + centreLocation.y);
-			DrawPixel(alphaBlendColor(GetPixel((int) x + centreLocation.x - 1, (int) y + centreLocation.y), color, AAValue2), (int) x + centreLocation.x - 1, (int) y + centreLocation.y);
-			
-			DrawPixel(alphaBlendColor(GetPixel((int)-x + centreLocation.x, (int) y + centreLocation.y), color, AAValue1), (int)-x + centreLocation.x, (int) y + centreLocation.y);
-			DrawPixel(alphaBlendColor(GetPixel((int)-x + centreLocation.x + 1, (int) y + centreLocation.y), color, AAValue2), (int)-x + centreLocation.x + 1, (int) y + centreLocation.y);
-			
-			DrawPixel(alphaBlendColor(GetPixel((int) x + centreLocation.x, (int)-y + centreLocation.y), color, AAValue1), (int) x + centreLocation.x, (int)-y + centreLocation.y);
-			DrawPixel(alphaBlendColor(GetPixel((int) x + centreLocation.x - 1, (int)-y + centreLocation.y), color, AAValue2), (int) x + centreLocation.x - 1, (int)-y + centreLocation.y);
-			
-			DrawPixel(alphaBlendColor(GetPixel((int)-x + centreLocation.x, (int)-y + centreLocation.y), color, AAValue1), (int)-x + centreLocation.x, (int)-y + centreLocation.y);
-			DrawPixel(alphaBlendColor(GetPixel((int)-x + centreLocation.x + 1, (int)-y + centreLocation.y), color, AAValue2), (int)-x + centreLocation.x + 1, (int)-y + centreLocation.y);
-			
-			DrawPixel(alphaBlendColor(GetPixel((int) y + centreLocation.x, (int) x + centreLocation.y), color, AAValue1), (int) y + centreLocation.x, (int) x + centreLocation.y);
-			DrawPixel(alphaBlendColor(GetPixel((int) y + centreLocation.x, (int) x + centreLocation.y - 1), color, AAValue2), (int) y + centreLocation.x, (int) x + centreLocation.y - 1);
-			
-			DrawPixel(alphaBlendColor(GetPixel((int)-y + centreLocation.x, (int) x + centreLocation.y), color, AAValue1), (int)-y + centreLocation.x, (int) x + centreLocation.y);
-			DrawPixel(alphaBlendColor(GetPixel((int)-y + centreLocation.x, (int) x + centreLocation.y - 1), color, AAValue2), (int)-y + centreLocation.x, (int) x + centreLocation.y - 1);
-			
-			DrawPixel(alphaBlendColor(GetPixel((int) y + centreLocation.x, (int)-x + centreLocation.y), color, AAValue1), (int) y + centreLocation.x, (int)-x + centreLocation.y);
-			DrawPixel(alphaBlendColor(GetPixel((int) y + centreLocation.x, (int)-x + centreLocation.y + 1), color, AAValue2), (int) y + centreLocation.x, (int)-x + centreLocation.y + 1);
-			
-			DrawPixel(alphaBlendColor(GetPixel((int)-y + centreLocation.x, (int)-x + centreLocation.y), color, AAValue1), (int)-y + centreLocation.x, (int)-x + centreLocation.y);
-			DrawPixel(alphaBlendColor(GetPixel((int)-y + centreLocation.x, (int)-x + centreLocation.y + 1), color, AAValue2), (int)-y + centreLocation.x, (int)-x + centreLocation.y + 1);
-		}
-		y++;
+	CIDR_STATS_SCOPE(Circle);
+	DrawEllipse(color, centreLocation, radius, radius, AA);
+}
+void cdr::Renderer::DrawEllipse(const RGBA& color, const Point& centreLocation, int radiusX, int radiusY, bool AA) {
+	CIDR_STATS_SCOPE(Circle);
+	EllipseRasterizer ellipse {centreLocation, radiusX, radiusY};
+	if (ellipse.IsEmpty()) return;
+	addDamage(ellipse.GetBounds(AA));
+	const uint32_t colorUINT {RGBtoUINT(color)};
+	
+	if (!AA) {
+		ellipse.RasterizeOutline(clip, [&](int x, int y, int count) {
+			drawScanLine(colorUINT, x, x + count - 1, y);
+		});
+	}
+	// NOTE: every pixel of the anti aliased outline is blended once with the coverage scaling the alpha of the color
+	else {
+		ellipse.RasterizeOutlineAA(clip, [&](int x, int y, int count, const uint8_t* coverage) {
+			drawCoverageSpan(colorUINT, coverage, x, y, count);
+		});
 	}
 }
 void cdr::Renderer::FillCircle(const RGBA& color, const Point& centreLocation, int radius, bool AA) {
-	if(radius < 1) return;
-	if(radius == 1) DrawPixel(color, centreLocation);
-	
-	float x{static_cast<float>(radius)};
-	float y{};
-	
-	while((int) x > 0) {
-		x = sqrt(x * x - 2 * y - 1);
-		
-		for(int i = (int)-x + centreLocation.x; i < (int)x + centreLocation.x; i++) {
-			if(!AA || (i != (int)-x + centreLocation.x)){
-				DrawPixel(color, i, (int)y + centreLocation.y);
-				DrawPixel(color, i, (int)-y + centreLocation.y);
-			}
-			else {
-				float AAValue1 = 255 * (x - static_cast<int>(x));
-				float AAValue2 = 255 * (1 - (x - static_cast<int>(x)));
-				
-				DrawPixel(alphaBlendColor(GetPixel((int)-x + centreLocation.x, (int)y + centreLocation.y), color, AAValue1), (int)-x + centreLocation.x, (int)y + centreLocation.y);
-				DrawPixel(alphaBlendColor(GetPixel((int)-x + centreLocation.x + 1, (int)y + centreLocation.y), color, AAValue2), (int)-x + centreLocation.x + 1, (int)y + centreLocation.y);
-				
-				DrawPixel(alphaBlendColor(GetPixel((int)x + centreLocation.x, (int)y + centreLocation.y), color, AAValue1), (int)x + centreLocation.x, (int)y + centreLocation.y);
-				DrawPixel(alphaBlendColor(GetPixel((int)x + centreLocation.x - 1, (int)y + centreLocation.y), color, AAValue2), (int)x + centreLocation.x - 1, (int)y + centreLocation.y);
-				
-				DrawPixel(alphaBlendColor(GetPixel((int)x + centreLocation.x, (int)-y + centreLocation.y), color, AAValue1), (int)x + centreLocation.x, (int)-y + centreLocation.y);
-				DrawPixel(alphaBlendColor(GetPixel((int)x + centreLocation.x - 1, (int)-y + centreLocation.y), color, AAValue2), (int)x + centreLocation.x - 1, (int)-y + centreLocation.y);
-
-				DrawPixel(alphaBlendColor(GetPixel((int)-x + centreLocation.x, (int)-y + centreLocation.y), color, AAValue1), (int)-x + centreLocation.x, (int)-y + centreLocation.y);
-				DrawPixel(alphaBlendColor(GetPixel((int)-x + centreLocation.x + 1, (int)-y + centreLocation.y), color, AAValue2), (int)-x + centreLocation.x + 1, (int)-y + centreLocation.y);
-				
-				DrawPixel(alphaBlendColor(GetPixel((int)-y + centreLocation.x, (int)x + centreLocation.y), color, AAValue1), (int)-y + centreLocation.x, (int)x + centreLocation.y);
-				DrawPixel(alphaBlendColor(GetPixel((int)-y + centreLocation.x, (int)x + centreLocation.y - 1), color, AAValue2), (int)-y + centreLocation.x, (int)x + centreLocation.y - 1);
-				
-				DrawPixel(alphaBlendColor(GetPixel((int)y + centreLocation.x, (int)x + centreLocation.y), color, AAValue1), (int)y + centreLocation.x, (int)x + centreLocation.y);
-				DrawPixel(alphaBlendColor(GetPixel((int)y + centreLocation.x, (int)x + centreLocation.y - 1), color, AAValue2), (int)y + centreLocation.x, (int)x + centreLocation.y - 1);
-
-				DrawPixel(alphaBlendColor(GetPixel((int)-y + centreLocation.x, (int)-x + centreLocation.y), color, AAValue1), (int)-y + centreLocation.x, (int)-x + centreLocation.y);
-				DrawPixel(alphaBlendColor(GetPixel((int)-y + centreLocation.x, (int)-x + centreLocation.y + 1), color, AAValue2), (int)-y + centreLocation.x, (int)-x + centreLocation.y + 1);
-								
-				DrawPixel(alphaBlendColor(GetPixel((int)y + centreLocation.x, (int)-x + centreLocation.y), color, AAValue1), (int)y + centreLocation.x, (int)-x + centreLocation.y);
-				DrawPixel(alphaBlendColor(GetPixel((int)y + centreLocation.x, (int)-x + centreLocation.y + 1), color, AAValue2), (int)y + centreLocation.x, (int)-x + centreLocation.y + 1);
-			}
-		}
-		
-		y++;
+	CIDR_STATS_SCOPE(FillCircle);
+	FillEllipse(color, centreLocation, radius, radius, AA);
+}
+void cdr::Renderer::FillEllipse(const RGBA& color, const Point& centreLocation, int radiusX, int radiusY, bool AA) {
+	CIDR_STATS_SCOPE(FillCircle);
+	EllipseRasterizer ellipse {centreLocation, radiusX, radiusY};
+	if (ellipse.IsEmpty()) return;
+	addDamage(ellipse.GetBounds(AA));
+	const uint32_t colorUINT {RGBtoUINT(color)};
+	
+	if (!AA) {
+		ellipse.Rasterize(clip, [&](int x, int y, int count) {
+			drawScanLine(colorUINT, x, x + count - 1, y);
+		});
+	}
+	else if (ellipse.IsThin()) {
+		Rectangle visible {clipRectangle(ellipse.GetBounds(AA))};
+		if (visible.width <= 0 || visible.height <= 0) return;
+		FrameArena::Scope scratch {frameArena};
+		CoverageRasterizer shape {visible, frameArena};
+		ellipse.AddTo(shape);
+		fillCoverage(shape, colorUINT, AA);
+	}
+	// NOTE: the inside is filled like without anti aliasing, only the edge pixels are blended with their coverage
+	else {
+		ellipse.RasterizeAA(clip, [&](int x, int y, int count, const uint8_t* coverage) {
+			if (!coverage) drawScanLine(colorUINT, x, x + count - 1, y);
+			else drawCoverageSpan(colorUINT, coverage, x, y, count);
+		});
 	}
 }
 void cdr::Renderer::FillCircle(RGBA (*shader)(const Renderer& renderer, int x, int y), const Point& centreLocation, int radius, bool AA) {
-	if(radius < 1) return;
-	if(radius == 1) DrawPixel(shader(*this, centreLocation.x, centreLocation.y), centreLocation);
-	
-	float x{static_cast<float>(radius)};
-	float y{};
-	
-	std::vector<std::vector<uint32_t>> shadedPixels{};
-	shadedPixels.resize(radius * 2);
-	for (int i = 0; i < radius * 2; i++) {
-		shadedPixels[i].resize(radius * 2);
-	}
-	for (int i = 0; i < radius * 2; i++) {
-		for (int j = 0; j < radius * 2; j++) {
-			if((i-radius) * (i-radius) + (j-radius) * (j-radius) <= radius*radius)
-			shadedPixels[i][j] = RGBtoUINT(shader(*this, i - radius + centreLocation.x, j- radius + centreLocation.y));
-		}
-	}		
-	
-	while((int) x > 0) {
-		x = sqrt(x * x - 2 * y - 1);
-		shadedPixels.push_back({});	
-		
-		for(int i = (int)-x + centreLocation.x; i < (int)x + centreLocation.x; i++) {
-			if(!AA || (i != (int)-x + centreLocation.x)) {
-				int ni = i - centreLocation.x + radius;
-				DrawPixel(shadedPixels[ni][y + radius], i, (int)y + centreLocation.y);
-				DrawPixel(shadedPixels[ni][-y + radius], i, (int)-y + centreLocation.y);
-			}
-			else  {
-				float AAValue1 = 255 * (x - static_cast<int>(x));
-				float AAValue2 = 255 * (1 - (x - static_cast<int>(x)));
-				
-				DrawPixel(alphaBlendColor(GetPixel((int)-x + centreLocation.x, (int)y + centreLocation.y), shadedPixels[(int)-x + radius][y + radius], AAValue1), (int)-x + centreLocation.x, (int)y + centreLocation.y);
-				DrawPixel(alphaBlendColor(GetPixel((int)-x + centreLocation.x + 1, (int)y + centreLocation.y), shadedPixels[(int)-x + 1 + radius][y + radius], AAValue2), (int)-x + centreLocation.x + 1, (int)y + centreLocation.y);
-				
-				DrawPixel(alphaBlendColor(GetPixel((int)x + centreLocation.x, (int)y + centreLocation.y), shadedPixels[(int)x + radius][y + radius], AAValue1), (int)x + centreLocation.x, (int)y + centreLocation.y);
-				DrawPixel(alphaBlendColor(GetPixel((int)x + centreLocation.x - 1, (int)y + centreLocation.y), shadedPixels[(int)x - 1 + radius][y + radius], AAValue2), (int)x + centreLocation.x - 1, (int)y + centreLocation.y);
-				
-				DrawPixel(alphaBlendColor(GetPixel((int)x + centreLocation.x, (int)-y + centreLocation.y), shadedPixels[(int)x + radius][-y + radius], AAValue1), (int)x + centreLocation.x, (int)-y + centreLocation.y);
-				DrawPixel(alphaBlendColor(GetPixel((int)x + centreLocation.x - 1, (int)-y + centreLocation.y), shadedPixels[(int)x - 1 + radius][-y + radius], AAValue2), (int)x + centreLocation.x - 1, (int)-y + centreLocation.y);
-
-				DrawPixel(alphaBlendColor(GetPixel((int)-x + centreLocation.x, (int)-y + centreLocation.y), shadedPixels[(int)-x + radius][-y + radius], AAValue1), (int)-x + centreLocation.x, (int)-y + centreLocation.y);
-				DrawPixel(alphaBlendColor(GetPixel((int)-x + centreLocation.x + 1, (int)-y + centreLocation.y), shadedPixels[(int)-x + 1 + radius][-y + radius], AAValue2), (int)-x + centreLocation.x + 1, (int)-y + centreLocation.y);
-				
-				DrawPixel(alphaBlendColor(GetPixel((int)-y + centreLocation.x, (int)x + centreLocation.y), shadedPixels[-y + radius][(int)x + radius], AAValue1), (int)-y + centreLocation.x, (int)x + centreLocation.y);
-				DrawPixel(alphaBlendColor(GetPixel((int)-y + centreLocation.x, (int)x + centreLocation.y - 1), shadedPixels[-y + radius][(int)x + radius - 1], AAValue2), (int)-y + centreLocation.x, (int)x + centreLocation.y - 1);
-				
-				DrawPixel(alphaBlendColor(GetPixel((int)y + centreLocation.x, (int)x + centreLocation.y), shadedPixels[y + radius][(int)x + radius], AAValue1), (int)y + centreLocation.x, (int)x + centreLocation.y);
-				DrawPixel(alphaBlendColor(GetPixel((int)y + centreLocation.x, (int)x + centreLocation.y - 1), shadedPixels[y + radius][(int)x + radius - 1], AAValue2), (int)y + centreLocation.x, (int)x + centreLocation.y - 1);
-
-				DrawPixel(alphaBlendColor(GetPixel((int)-y + centreLocation.x, (int)-x + centreLocation.y), shadedPixels[-y + radius][(int)-x + radius], AAValue1), (int)-y + centreLocation.x, (int)-x + centreLocation.y);
-				DrawPixel(alphaBlendColor(GetPixel((int)-y + centreLocation.x, (int)-x + centreLocation.y + 1), shadedPixels[-y + radius][(int)-x + radius + 1], AAValue2), (int)-y + centreLocation.x, (int)-x + centreLocation.y + 1);
-								
-				DrawPixel(alphaBlendColor(GetPixel((int)y + centreLocation.x, (int)-x + centreLocation.y), shadedPixels[y + radius][(int)-x + radius], AAValue1), (int)y + centreLocation.x, (int)-x + centreLocation.y);
-				DrawPixel(alphaBlendColor(GetPixel((int)y + centreLocation.x, (int)-x + centreLocation.y + 1), shadedPixels[y + radius][(int)-x + radius + 1], AAValue2), (int)y + centreLocation.x, (int)-x + centreLocation.y + 1);
-			}
-		}
-		
-		y++;
+	fillEllipse(&shadePixels<RGBA (*)(const Renderer&, int, int)>, &shader, centreLocation, radius, radius, AA);
+}
+void cdr::Renderer::FillEllipse(RGBA (*shader)(const Renderer& renderer, int x, int y), const Point& centreLocation, int radiusX, int radiusY, bool AA) {
+	fillEllipse(&shadePixels<RGBA (*)(const Renderer&, int, int)>, &shader, centreLocation, radiusX, radiusY, AA);
+}
+void cdr::Renderer::fillEllipse(SpanShadeFunction shade, const void* shader, const Point& centreLocation, int radiusX, int radiusY, bool AA) {
+	CIDR_STATS_SCOPE(FillCircle);
+	EllipseRasterizer ellipse {centreLocation, radiusX, radiusY};
+	if (ellipse.IsEmpty()) return;
+	addDamage(ellipse.GetBounds(AA));
+	
+	// NOTE: the spans of a row are next to each other, so every visible row is shaded once from its first
+	// to its last pixel into one buffer before anything is drawn (shaders that read the canvas see the original pixels).
+	// Then the spans are walked again and drawn from that buffer
+	Rectangle visible {clipRectangle(ellipse.GetBounds(AA))};
+	if (visible.width <= 0 || visible.height <= 0) return;
+	FrameArena::Scope scratch {frameArena};
+	int* rowStart {frameArena.Allocate<int>(visible.height)};
+	int* rowEnd {frameArena.Allocate<int>(visible.height)};
+	int* rowOffset {frameArena.Allocate<int>(visible.height)};
+	std::fill_n(rowStart, visible.height, INT_MAX);
+	std::fill_n(rowEnd, visible.height, INT_MIN);
+	// NOTE: thin ellipses get their exact coverage like the ones of FillEllipse
+	const bool exact {AA && ellipse.IsThin()};
+	CoverageRasterizer shape {exact ? visible : Rectangle{}, frameArena};
+	if (exact) ellipse.AddTo(shape);
+	auto rasterizeAA = [&](auto&& span) {
+		if (exact) shape.RasterizeAA(span);
+		else ellipse.RasterizeAA(clip, span);
+	};
+	auto addSpan = [&](int x, int y, int count) {
+		rowStart[y - visible.y] = std::min(rowStart[y - visible.y], x);
+		rowEnd[y - visible.y] = std::max(rowEnd[y - visible.y], x + count);
+	};
+	if (!AA) ellipse.Rasterize(clip, addSpan);
+	else rasterizeAA([&](int x, int y, int count, const uint8_t*) { addSpan(x, y, count); });
+	
+	int shadedCount {0};
+	for (int row = 0; row < visible.height; row++) {
+		rowOffset[row] = shadedCount;
+		if (rowStart[row] < rowEnd[row]) shadedCount += rowEnd[row] - rowStart[row];
+	}
+	if (shadedCount == 0) return;
+	CIDR_STATS_ADD(shaderInvocations, shadedCount);
+	uint32_t* shadedPixels {frameArena.Allocate<uint32_t>(shadedCount)};
+	for (int row = 0; row < visible.height; row++) {
+		if (rowStart[row] < rowEnd[row]) {
+			shade(shader, *this, rowStart[row], rowEnd[row], visible.y + row, shadedPixels + rowOffset[row]);
+		}
+	}
+	auto shadedAt = [&](int x, int y) {
+		return shadedPixels + rowOffset[y - visible.y] + (x - rowStart[y - visible.y]);
+	};
+	
+	if (!AA) {
+		ellipse.Rasterize(clip, [&](int x, int y, int count) {
+			drawSpan(shadedAt(x, y), x, y, count);
+		});
+	} else {
+		rasterizeAA([&](int x, int y, int count, const uint8_t* coverage) {
+			if (!coverage) drawSpan(shadedAt(x, y), x, y, count);
+			else drawCoverageSpan(shadedAt(x, y), coverage, x, y, count);
+		});
 	}
 }
 
 void cdr::Renderer::DrawTriangle(const RGBA& color, const Point& p1, const Point& p2, const Point& p3, bool AA, bool GC) {
+	CIDR_STATS_SCOPE(Triangle);
 	DrawLine(color, p1, p2, AA, GC);
 	DrawLine(color, p2, p3, AA, GC);
 	DrawLine(color, p3, p1, AA, GC);
 }
-struct DPoint {
-	double x;
-	double y;
-} minTx, maxTx;
-
-// void cdr::Renderer::DrawTriangle(const Bitmap& texture, float tx1, float ty1, float tx2, float ty2, float tx3, float ty3, float x1, float y1, float x2, float y2, float x3, float y3) {
-void cdr::Renderer::DrawTriangle(const Bitmap& texture, FPoint tp1, FPoint tp2, FPoint tp3, FPoint p1, FPoint p2, FPoint p3) {
-	Timer t{};
-	
-	// sort top most point
-	if(p1.y > p2.y) {
-		std::swap(p1, p2);
-		std::swap(tp1, tp2);
-	}
-	if(p2.y > p3.y) {
-		std::swap(p2, p3);
-		std::swap(tp2, tp3);
-	}
-	if(p1.y > p2.y) {
-		std::swap(p1, p2);
-		std::swap(tp1, tp2);
-	}
-	
-	tp1.x *= texture.GetWidth();
-	tp2.x *= texture.GetWidth();
-	tp3.x *= texture.GetWidth();
-	tp1.y *= texture.GetHeight();
-	tp2.y *= texture.GetHeight();
-	tp3.y *= texture.GetHeight();
-
-
-
-#if !defined(CDR_LINEAR) && !defined(CDR_BARYCENTRIC)
-	for (int y = std::ceil(p1.y); y < std::ceil(p2.y); y++) {
-		double t1 = (y - std::ceil(p1.y)) / (double)(std::ceil(p3.y) - std::ceil(p1.y));
-		double t2 = (y - std::ceil(p1.y)) / (double)(std::ceil(p2.y) - std::ceil(p1.y));
-
-		double min = lerp(p1.x, p3.x, t1);
-		double max = lerp(p1.x, p2.x, t2);
-		int startX = std::ceil(min);
-		int endX = std::ceil(max);
-		
-		minTx.x = lerp(tp1.x, tp3.x, t1);
-		minTx.y = lerp(tp1.y, tp3.y, t1);
-		
-		maxTx.x = lerp(tp1.x, tp2.x, t2);
-		maxTx.y = lerp(tp1.y, tp2.y, t2);
-		
-		if (min > max) {
-			std::swap(min, max);
-			std::swap(startX, endX);
-			std::swap(minTx, maxTx);
-		}
-		
-		double xStep{};
-		double yStep{};
-		if (max - min) {
-			xStep = (maxTx.x - minTx.x) / (max - min);
-			yStep = (maxTx.y - minTx.y) / (max - min);
-		}
-		
-		double xLerp = minTx.x;
-		xLerp -= (min - startX) * xStep;
-		double yLerp = minTx.y;
-		yLerp -= (min - startX) * yStep;
-		
-		for (int x = startX; x < endX; x++) {
+void cdr::Renderer::DrawTriangle(const BitmapView& texture, FPoint tp1, FPoint tp2, FPoint tp3, FPoint p1, FPoint p2, FPoint p3) {
+	CIDR_STATS_SCOPE(TexturedTriangle);
+	if (texture.IsEmpty()) return;
+	addDamage(std::min({p1.x, p2.x, p3.x}), std::min({p1.y, p2.y, p3.y}), std::max({p1.x, p2.x, p3.x}), std::max({p1.y, p2.y, p3.y}), 0);
+	TriangleRasterizer triangle {p1, p2, p3};
+	if (triangle.IsEmpty()) return;
+	// NOTE: the texture coordinates are divided by the area up front, so a pixel costs two dot products
+	const double scale {1.0 / triangle.GetArea()};
+	const double tx[3] {tp1.x * texture.GetWidth() * scale, tp2.x * texture.GetWidth() * scale, tp3.x * texture.GetWidth() * scale};
+	const double ty[3] {tp1.y * texture.GetHeight() * scale, tp2.y * texture.GetHeight() * scale, tp3.y * texture.GetHeight() * scale};
+	int64_t steps[3];
+	triangle.GetEdgeStepsX(steps);
+	
+	// NOTE: the texture coordinates are affine, so their derivatives and the mip level are the same for the whole triangle
+	int64_t stepsY[3];
+	triangle.GetEdgeStepsY(stepsY);
+	double dxdx {steps[0] * tx[0] + steps[1] * tx[1] + steps[2] * tx[2]};
+	double dydx {steps[0] * ty[0] + steps[1] * ty[1] + steps[2] * ty[2]};
+	double dxdy {stepsY[0] * tx[0] + stepsY[1] * tx[1] + stepsY[2] * tx[2]};
+	double dydy {stepsY[0] * ty[0] + stepsY[1] * ty[1] + stepsY[2] * ty[2]};
+	float lod = 0.5f * std::log2(std::max(dxdx * dxdx + dydx * dydx, dxdy * dxdy + dydy * dydy));
+	
+	triangle.Rasterize(clip, [&](int startX, int y, int count) {
+		CIDR_STATS_ADD(textureSamples, count);
+		int64_t e[3];
+		triangle.GetEdgeValues(startX, y, e);
+		for (int x = startX; x < startX + count; x++) {
+			double xLerp {e[0] * tx[0] + e[1] * tx[1] + e[2] * tx[2]};
+			double yLerp {e[0] * ty[0] + e[1] * ty[1] + e[2] * ty[2]};
 #ifdef CDR_PERFORMANCE
+			CIDR_STATS_ADD(pixelsWritten, 1);
 			pixels[getIndex(x, y)] = texture.GetRawPixel(xLerp, yLerp);
 #else
 			// NOTE: doing this, instead of just DrawPixel(sampleTexture(texture, xLerp, yLerp), x, y), in order to achieve *performance*
 			if (this->ScaleType == ScaleType::Nearest) {
-				if (!useAlphaBlending && (texture.GetRawPixel((float)xLerp, (float)yLerp)& 0xff) != 0 && (float)xLerp >= 0 && (float)yLerp >= 0 && (float)xLerp < texture.GetWidth() && (float)yLerp < texture.GetHeight()) {
-					pixels[getIndex(x, y)] = texture.GetRawPixel((float)xLerp, (float)yLerp);
-				} else {
-					DrawPixel(sampleTextureRaw(texture, (float)xLerp, (float)yLerp), x, y);
-				}
+				drawTexelUnclipped(texture, sampleTextureRaw(texture, (float)xLerp, (float)yLerp), x, y);
 			} else {
-				DrawPixel(sampleTexture(texture, xLerp, yLerp), x, y);
+				drawTexelUnclipped(texture, RGBtoUINT(sampleTexture(texture, xLerp, yLerp, lod)), x, y);
 			}
 #endif			
-			xLerp += xStep;
-			yLerp += yStep;
+			e[0] += steps[0];
+			e[1] += steps[1];
+			e[2] += steps[2];
 		}
-	}
-	
-	for (int y = std::ceil(p2.y); y < std::ceil(p3.y); y++) {
-		double t1 = (y - std::ceil(p1.y)) / (double)(std::ceil(p3.y) - std::ceil(p1.y));
-		double t2 = (y - std::ceil(p2.y)) / (double)(std::ceil(p3.y) - std::ceil(p2.y));
-		
-		double min = lerp(p1.x, p3.x, t1);
-		double max = lerp(p2.x, p3.x, t2);
-		int startX = std::ceil(min);
-		int endX = std::ceil(max);
-
-		minTx.x = lerp(tp1.x, tp3.x, t1);
-		minTx.y = lerp(tp1.y, tp3.y, t1);
-		
-		maxTx.x = lerp(tp2.x, tp3.x, t2);
-		maxTx.y = lerp(tp2.y, tp3.y, t2);
-		
-		if (min > max) {
-			std::swap(min, max);
-			std::swap(startX, endX);
-			std::swap(minTx, maxTx);
-		}
-		
-		double xStep{};
-		double yStep{};
-		if (max - min) {
-			xStep = (maxTx.x - minTx.x) / (max - min);
-			yStep = (maxTx.y - minTx.y) / (max - min);
-		}
-		
-		double xLerp = minTx.x;
-		xLerp -= (min - startX) * xStep;
-		double yLerp = minTx.y;
-		yLerp -= (min - startX) * yStep;
-		
-		for (int x = startX; x < endX; x++) {
-#ifdef CDR_PERFORMANCE
-			pixels[getIndex(x, y)] = texture.GetRawPixel(xLerp, yLerp);
-#else
-			// NOTE: doing this, instead of just DrawPixel(sampleTexture(texture, xLerp, yLerp), x, y), in order to achieve *performance*
-			if (this->ScaleType == ScaleType::Nearest) {
-				if (!useAlphaBlending && (texture.GetRawPixel((float)xLerp, (float)yLerp)& 0xff) != 0 && (float)xLerp >= 0 && (float)yLerp >= 0 && (float)xLerp < texture.GetWidth() && (float)yLerp < texture.GetHeight()) {
-					pixels[getIndex(x, y)] = texture.GetRawPixel((float)xLerp, (float)yLerp);
-				} else {
-					DrawPixel(sampleTextureRaw(texture, (float)xLerp, (float)yLerp), x, y);
-				}
-			} else {
-				DrawPixel(sampleTexture(texture, xLerp, yLerp), x, y);
-			}
-#endif			
-			xLerp += xStep;
-			yLerp += yStep;
-		}
-	}
-	
-#elif defined(cdr_linear)
-	
-	// NOTE: can we do this in one loop? will that do anything?
-	// std::thread t1 { [&](){ 
-	
-	for (int y = std::ceil(p1.y); y < std::ceil(p2.y); y++) {
-		double t1 = (y - p1.y) / (double)(p3.y - p1.y);
-		double t2 = (y - p1.y) / (double)(p2.y - p1.y);
-		
-		double min = lerp(p1.x, p3.x, t1);
-		double max = lerp(p1.x, p2.x, t2);
-		int startX = std::ceil(min);
-		int endX = std::ceil(max);
-		
-		minTx.x = lerp(tp1.x, tp3.x, t1);
-		minTx.y = lerp(tp1.y, tp3.y, t1);
-		
-		maxTx.x = lerp(tp1.x, tp2.x, t2);
-		maxTx.y = lerp(tp1.y, tp2.y, t2);
-		
-		if (min > max) {
-			std::swap(startX, endX);
-			std::swap(min, max);
-			std::swap(minTx, maxTx);
-		}
-		
-		for (int x = startX; x < endX; x++) {
-			DrawPixel(sampleTexture(texture, 
-				lerp(minTx.x, maxTx.x, (x - min) / (max - min)), 
-				lerp(minTx.y, maxTx.y, (x - min) / (max - min))), 
-				x, y);
-		}
-	}
-	
-	// } };
-	// std::thread t2 { [&](){ 
-	
-	for (int y = std::ceil(p2.y); y < std::ceil(p3.y); y++) {
-		double t1 = (y - p1.y) / (double)(p3.y - p1.y);
-		double t2 = (y - p2.y) / (double)(p3.y - p2.y);
-		
-		double min = lerp(p1.x, p3.x, t1);
-		double max = lerp(p2.x, p3.x, t2);
-		int startX = std::ceil(min);
-		int endX = std::ceil(max);
-
-		minTx.x = lerp(tp1.x, tp3.x, t1);
-		minTx.y = lerp(tp1.y, tp3.y, t1);
-		
-		maxTx.x = lerp(tp2.x, tp3.x, t2);
-		maxTx.y = lerp(tp2.y, tp3.y, t2);
-		
-		if (min > max) {
-			std::swap(startX, endX);
-			std::swap(min, max);
-			std::swap(minTx, maxTx);
-		}
-		
-		for (int x = startX; x < endX; x++) {
-			DrawPixel(sampleTexture(texture, 
-				lerp(minTx.x, maxTx.x, (x - min) / (max - min)), 
-				lerp(minTx.y, maxTx.y, (x - min) / (max - min))), 
-				x, y);
-		}
-	}
-	// }};
-	// t1.join();
-	// t2.join();
-#else
-	float leftStep{};
-	if (p3.y - p1.y != 0) {
-		leftStep = (p3.x - p1.x) / (p3.y - p1.y);
-	}
-	float rightStep{};
-	if (p2.y - p1.y != 0) {
-		rightStep = (p2.x - p1.x) / (p2.y - p1.y);
-	}
-	
-	float left = p1.x + (std::ceil(p1.y) - p1.y) * leftStep;
-	float right = p1.x + (std::ceil(p1.y) - p1.y) * rightStep;
-	
-	// float denom = edgeFunc(p1, p2, p3);// (p2.y - p3.y)*(p1.x - p3.x) + (p3.x - p2.x)*(p1.y - p3.y);
-	float denom = (p3.x - p1.x)*(p2.y - p1.y) - (p3.y - p1.y)*(p2.x - p1.x);// (p2.y - p3.y)*(p1.x - p3.x) + (p3.x - p2.x)*(p1.y - p3.y);
-	float w1{};
-	float w2{};
-	float w3{};
-
-	for (int y = std::ceil(p1.y); y < std::ceil(p2.y); y++) {
-		int min = std::ceil(left);
-		int max = std::ceil(right);
-		
-		if (min > max) {
-			std::swap(min, max);
-		}
-		
-		for (int x = min; x < max; x++) {
-			
-			// DrawPixel(RGB::Red, x, y);
-			
-			w1 = ((x - p2.x)*(p3.y - p2.y) - (y - p2.y)*(p3.x - p2.x)) / denom;
-			w2 = ((x - p3.x)*(p1.y - p3.y) - (y - p3.y)*(p1.x - p3.x)) / denom;
-			w3 = ((x - p1.x)*(p2.y - p1.y) - (y - p1.y)*(p2.x - p1.x)) / denom;
-			
-			// w1 = ((p2.y - p3.y)*(x - p3.x) + (p3.x - p2.x)*(y - p3.y)) / denom;
-			// w2 = ((p3.y - p1.y)*(x - p3.x) + (p1.x - p3.x)*(y - p3.y)) / denom;
-			// w3 = 1.f - w1 - w2;
-			
-			float t = (w1 * tp1.x + w2 * tp2.x + w3 * tp3.x);
-			float s = (w1 * tp1.y + w2 * tp2.y + w3 * tp3.y);
-			
-			DrawPixel(sampleTexture(texture, 
-				t, s),
-				x, y);
-		}
-		
-		left += leftStep;
-		right += rightStep;
-	}
-	
-	if (p3.y - p2.y != 0) {
-		rightStep = (p3.x - p2.x) / (p3.y - p2.y);
-	}
-	// right = p1.x + (std::ceil(p1.y) - p1.y) * rightStep
-	right = p2.x + (std::ceil(p2.y) - p2.y) * rightStep;
-	
-	for (int y = std::ceil(p2.y); y < std::ceil(p3.y); y++) {
-		int min = std::ceil(left);
-		int max = std::ceil(right);
-		
-		if (min > max) {
-			std::swap(min, max);
-		}
-		
-		for (int x = min; x < max; x++) {
-			
-			// DrawPixel(RGB::Green, x, y);
-			
-			// FPoint p {float(x), float(y)};
-			w1 = ((x - p2.x)*(p3.y - p2.y) - (y - p2.y)*(p3.x - p2.x)) / denom;
-			w2 = ((x - p3.x)*(p1.y - p3.y) - (y - p3.y)*(p1.x - p3.x)) / denom;
-			w3 = ((x - p1.x)*(p2.y - p1.y) - (y - p1.y)*(p2.x - p1.x)) / denom;
-			
-			// w1 = ((p2.y - p3.y)*(x - p3.x) + (p3.x - p2.x)*(y - p3.y)) / denom;
-			// w2 = ((p3.y - p1.y)*(x - p3.x) + (p1.x - p3.x)*(y - p3.y)) / denom;
-			// w3 = 1.f - w1 - w2;
-			
-			float t = (w1 * tp1.x + w2 * tp2.x + w3 * tp3.x);
-			float s = (w1 * tp1.y + w2 * tp2.y + w3 * tp3.y);
-			
-			DrawPixel(sampleTexture(texture, 
-				t, 
-				s),
-				x, y);
-		}
-		
-		left += leftStep;
-		right += rightStep;
-	}
-#endif
-	
-	static int counter = 0;
-	static double accumulation = 0;
-	counter++;
-	accumulation += t.elapsedSeconds()*1000;
-	
-	if (counter > 128) {
-		// std::cout << "speed: " << accumulation/counter << std::endl;
-		counter = 0;
-		accumulation = 0;
-	}
+	});
 }
-void cdr::Renderer::FillTriangle(const RGBA& color, Point p1, Point p2, Point p3) {
-	// sort top most point
-	if(p1.y > p2.y) {
-		std::swap(p1, p2);
-	}
-	if(p2.y > p3.y) {
-		std::swap(p2, p3);
-	}
-	if(p1.y > p2.y) {
-		std::swap(p1, p2);
-	}
-
-	if(p3.y - p1.y != 0) {
-		float x1 = 0;
-		float x2 = 0;
-		for (int i = p2.y; i >= p1.y; i--)	{
-			x1 = lerp(p1.x, p3.x, (i - p1.y) / (float)(p3.y - p1.y));
-			x2 = lerp(p1.x, p2.x, (i - p1.y) / (float)(p2.y - p1.y));
-			if(x1 > x2) {
-				std::swap(x1, x2);
-			}
-			drawScanLine(RGBtoUINT(color), std::round(x1), std::round(x2), i);
-		}
-		
-		for (int i = p2.y; i < p3.y; i++)	{
-			x1 = lerp(p1.x, p3.x, (i - p1.y) / (float)(p3.y - p1.y));
-			x2 = lerp(p2.x, p3.x, (i - p2.y) / (float)(p3.y - p2.y));
-			if(x1 > x2) {
-				std::swap(x1, x2);
-			}
-			drawScanLine(RGBtoUINT(color), std::round(x1), std::round(x2), i);
-		}
+void cdr::Renderer::FillTriangle(const RGBA& color, Point p1, Point p2, Point p3, bool AA) {
+	CIDR_STATS_SCOPE(FillTriangle);
+	const uint32_t colorUINT {RGBtoUINT(color)};
+	if (AA) {
+		const FPoint points[3] {p1, p2, p3};
+		fillPolygon(colorUINT, points, 3, true);
+		return;
 	}
+	addDamage(std::min({p1.x, p2.x, p3.x}), std::min({p1.y, p2.y, p3.y}), std::max({p1.x, p2.x, p3.x}), std::max({p1.y, p2.y, p3.y}), 0);
+	TriangleRasterizer{p1, p2, p3}.Rasterize(clip, [&](int x, int y, int count) {
+		drawScanLine(colorUINT, x, x + count - 1, y);
+	});
 }
 void cdr::Renderer::FillTriangle(RGBA color1, RGBA color2, RGBA color3, Point p1, Point p2, Point p3) {
-	// sort top most point
-	if(p1.y > p2.y) {
-		std::swap(p1, p2);
-		std::swap(color1, color2);
-	}
-	if(p2.y > p3.y) {
-		std::swap(p2, p3);
-		std::swap(color2, color3);
-	}
-	if(p1.y > p2.y) {
-		std::swap(p1, p2);
-		std::swap(color1, color2);
-	}
-
-	if(p3.y - p1.y != 0) {
-		float x1 = 0;
-		float x2 = 0;
-		RGBA lerpColorV1{}; // vertical lerp color from side 1
-		RGBA lerpColorV2{}; // vertical lerp color from side 2
-		
-		for (int i = p2.y; i >= p1.y; i--)	{
-			float t1 = (i - p1.y) / (float)(p3.y - p1.y);
-			float t2 = (i - p1.y) / (float)(p2.y - p1.y);
-			x1 = lerp(p1.x, p3.x, t1);
-			x2 = lerp(p1.x, p2.x, t2);
-			
-			lerpColorV1.r = static_cast<uint8_t>(lerp(color1.r, color3.r, t1));
-			lerpColorV1.g = static_cast<uint8_t>(lerp(color1.g, color3.g, t1));
-			lerpColorV1.b = static_cast<uint8_t>(lerp(color1.b, color3.b, t1));
-			lerpColorV1.a = static_cast<uint8_t>(lerp(color1.a, color3.a, t1));
-			lerpColorV2.r = static_cast<uint8_t>(lerp(color1.r, color2.r, t2));
-			lerpColorV2.g = static_cast<uint8_t>(lerp(color1.g, color2.g, t2));
-			lerpColorV2.b = static_cast<uint8_t>(lerp(color1.b, color2.b, t2));
-			lerpColorV2.a = static_cast<uint8_t>(lerp(color1.a, color2.a, t2));
-			
-			if(x1 > x2) {
-				std::swap(x1, x2);
-				std::swap(lerpColorV1, lerpColorV2);
-			}
-			drawScanLine(lerpColorV1, lerpColorV2, std::round(x1), std::round(x2), i);
-		}
-		
-		for (int i = p2.y; i < p3.y; i++)	{
-			float t1 = (i - p1.y) / (float)(p3.y - p1.y);
-			float t2 = (i - p2.y) / (float)(p3.y - p2.y);
-			x1 = lerp(p1.x, p3.x, t1);
-			x2 = lerp(p2.x, p3.x, t2);
-			
-			lerpColorV1.r = static_cast<uint8_t>(lerp(color1.r, color3.r, t1));
-			lerpColorV1.g = static_cast<uint8_t>(lerp(color1.g, color3.g, t1));
-			lerpColorV1.b = static_cast<uint8_t>(lerp(color1.b, color3.b, t1));
-			lerpColorV1.a = static_cast<uint8_t>(lerp(color1.a, color3.a, t1));
-			lerpColorV2.r = static_cast<uint8_t>(lerp(color2.r, color3.r, t2));
-			lerpColorV2.g = static_cast<uint8_t>(lerp(color2.g, color3.g, t2));
-			lerpColorV2.b = static_cast<uint8_t>(lerp(color2.b, color3.b, t2));
-			lerpColorV2.a = static_cast<uint8_t>(lerp(color2.a, color3.a, t2));
-			
-			if(x1 > x2) {
-				std::swap(x1, x2);
-				std::swap(lerpColorV1, lerpColorV2);
+	CIDR_STATS_SCOPE(FillTriangle);
+	addDamage(std::min({p1.x, p2.x, p3.x}), std::min({p1.y, p2.y, p3.y}), std::max({p1.x, p2.x, p3.x}), std::max({p1.y, p2.y, p3.y}), 0);
+	TriangleRasterizer triangle {p1, p2, p3};
+	if (triangle.IsEmpty()) return;
+	const double scale {1.0 / triangle.GetArea()};
+	const double channels[4][3] {
+		{color1.r * scale, color2.r * scale, color3.r * scale},
+		{color1.g * scale, color2.g * scale, color3.g * scale},
+		{color1.b * scale, color2.b * scale, color3.b * scale},
+		{color1.a * scale, color2.a * scale, color3.a * scale},
+	};
+	int64_t steps[3];
+	triangle.GetEdgeStepsX(steps);
+	
+	// the span is shaded in chunks into a buffer on the stack and then copied or blended
+	constexpr int chunkSize {256};
+	uint32_t shaded[chunkSize];
+	triangle.Rasterize(clip, [&](int x, int y, int count) {
+		int64_t e[3];
+		triangle.GetEdgeValues(x, y, e);
+		for (int chunkX = x; chunkX < x + count; chunkX += chunkSize) {
+			int chunkCount {std::min(chunkSize, x + count - chunkX)};
+			for (int i = 0; i < chunkCount; i++) {
+				uint32_t color {0};
+				for (const auto& channel : channels) {
+					double value {e[0] * channel[0] + e[1] * channel[1] + e[2] * channel[2]};
+					color = (color << 8) | static_cast<uint32_t>(std::clamp(value, 0.0, 255.0));
+				}
+				shaded[i] = color;
+				e[0] += steps[0];
+				e[1] += steps[1];
+				e[2] += steps[2];
 			}
-			drawScanLine(lerpColorV1, lerpColorV2, std::round(x1), std::round(x2), i);
+			drawSpan(shaded, chunkX, y, chunkCount);
 		}
-	}
+	});
 }
 void cdr::Renderer::FillTriangle(RGBA (*shader)(const Renderer& renderer, int x, int y), Point p1, Point p2, Point p3) {
-	// sort top most point
-	if(p1.y > p2.y) {
-		std::swap(p1, p2);
+	fillTriangle(&shadePixels<RGBA (*)(const Renderer&, int, int)>, &shader, p1, p2, p3);
+}
+void cdr::Renderer::fillTriangle(SpanShadeFunction shade, const void* shader, Point p1, Point p2, Point p3) {
+	CIDR_STATS_SCOPE(FillTriangle);
+	addDamage(std::min({p1.x, p2.x, p3.x}), std::min({p1.y, p2.y, p3.y}), std::max({p1.x, p2.x, p3.x}), std::max({p1.y, p2.y, p3.y}), 0);
+	TriangleRasterizer triangle {p1, p2, p3};
+	if (triangle.IsEmpty()) return;
+	
+	// NOTE: first all visible spans are collected and shaded into one buffer,
+	// after that they are drawn to the canvas (shaders that read the canvas see the original pixels)
+	struct Span {
+		int x;
+		int y;
+		int count;
+		int offset;
+	};
+	FrameArena::Scope scratch {frameArena};
+	// NOTE: every visible row has exactly one span
+	Span* spans {frameArena.Allocate<Span>(clip.height)};
+	int spanCount {0};
+	int shadedCount {0};
+	triangle.Rasterize(clip, [&](int x, int y, int count) {
+		spans[spanCount++] = Span{x, y, count, shadedCount};
+		shadedCount += count;
+	});
+	
+	CIDR_STATS_ADD(shaderInvocations, shadedCount);
+	uint32_t* shadedPixels {frameArena.Allocate<uint32_t>(shadedCount)};
+	for (int i = 0; i < spanCount; i++) {
+		shade(shader, *this, spans[i].x, spans[i].x + spans[i].count, spans[i].y, shadedPixels + spans[i].offset);
+	}
+	for (int i = 0; i < spanCount; i++) {
+		drawSpan(shadedPixels + spans[i].offset, spans[i].x, spans[i].y, spans[i].count);
 	}
-	if(p2.y > p3.y) {
-		std::swap(p2, p3);
+}
+void cdr::Renderer::FillPolygon(const RGBA& color, const FPoint* points, int count, bool AA) {
+	CIDR_STATS_SCOPE(FillPolygon);
+	fillPolygon(RGBtoUINT(color), points, count, AA);
+}
+void cdr::Renderer::fillPolygon(uint32_t color, const FPoint* points, int count, bool AA) {
+	if (count < 3) return;
+	float minX {points[0].x};
+	float minY {points[0].y};
+	float maxX {points[0].x};
+	float maxY {points[0].y};
+	for (int i = 0; i < count; i++) {
+		if (!std::isfinite(points[i].x) || !std::isfinite(points[i].y)) return;
+		minX = std::min(minX, points[i].x);
+		minY = std::min(minY, points[i].y);
+		maxX = std::max(maxX, points[i].x);
+		maxY = std::max(maxY, points[i].y);
+	}
+	addDamage(minX, minY, maxX, maxY, 1);
+	
+	// NOTE: the pixel centres of the renderer are whole numbers, the ones of the coverage rasterizer are half way between them
+	auto toPixel = [](float value, bool up) {
+		float clamped {std::clamp(value + 0.5f, -CoverageRasterizer::guardBand, CoverageRasterizer::guardBand)};
+		return static_cast<int>(up ? std::ceil(clamped) : std::floor(clamped));
+	};
+	int left {toPixel(minX, false)};
+	int top {toPixel(minY, false)};
+	Rectangle visible {clipRectangle(Rectangle{left, top, toPixel(maxX, true) - left, toPixel(maxY, true) - top})};
+	if (visible.width <= 0 || visible.height <= 0) return;
+	FrameArena::Scope scratch {frameArena};
+	CoverageRasterizer shape {visible, frameArena};
+	for (int i = 0; i < count; i++) {
+		const FPoint& from {points[i]};
+		const FPoint& to {points[(i + 1) % count]};
+		shape.AddEdge(FPoint{from.x + 0.5f, from.y + 0.5f}, FPoint{to.x + 0.5f, to.y + 0.5f});
+	}
+	fillCoverage(shape, color, AA);
+}
+void cdr::Renderer::FillRoundedRectangle(const RGBA& color, Rectangle rectangle, int radius, bool AA) {
+	CIDR_STATS_SCOPE(FillRectangle);
+	if (rectangle.width <= 0 || rectangle.height <= 0) return;
+	addDamage(rectangle);
+	Rectangle visible {clipRectangle(rectangle)};
+	if (visible.width <= 0 || visible.height <= 0) return;
+	FrameArena::Scope scratch {frameArena};
+	CoverageRasterizer shape {visible, frameArena};
+	shape.AddRoundedRectangle(FRectangle(rectangle), static_cast<float>(radius), static_cast<float>(radius));
+	fillCoverage(shape, RGBtoUINT(color), AA);
+}
+void cdr::Renderer::fillCoverage(const CoverageRasterizer& shape, uint32_t color, bool AA) {
+	if (!AA) {
+		shape.Rasterize([&](int x, int y, int count) {
+			drawScanLine(color, x, x + count - 1, y);
+		});
 	}
-	if(p1.y > p2.y) {
-		std::swap(p1, p2);
+	// NOTE: like the anti aliased ellipses, fully covered runs are filled and only the edge pixels are blended with their coverage
+	else {
+		shape.RasterizeAA([&](int x, int y, int count, const uint8_t* coverage) {
+			if (!coverage) drawScanLine(color, x, x + count - 1, y);
+			else drawCoverageSpan(color, coverage, x, y, count);
+		});
 	}
+}
 
-	// Shaded pixels for the top triangle
-	std::vector<std::vector<uint32_t>> shadedPixelsTopTri{};
-	// Shaded pixels for the bottom triangle
-	std::vector<std::vector<uint32_t>> shadedPixelsBottomTri{};
-	
-	if(p3.y - p1.y != 0) {
-		float x1 = 0;
-		float x2 = 0;
+void cdr::Renderer::drawScanLine(uint32_t color, int startX, int endX, int y) {
+	// NOTE: endX is inclusive
+	if (!clipScanLine(startX, endX, y)) return;
 
-		// Get the shaded pixels of the top triangle
-		shadedPixelsTopTri.resize(p2.y - p1.y + 1);
-		for (int i = p2.y; i >= p1.y; i--) {
-			x1 = lerp(p1.x, p3.x, (i - p1.y) / (float)(p3.y - p1.y));
-			x2 = lerp(p1.x, p2.x, (i - p1.y) / (float)(p2.y - p1.y));
-			if(x1 > x2) {
-				std::swap(x1, x2);
-			}
-			for (int j = std::round(x1); j < std::round(x2); j++) {				
-				shadedPixelsTopTri[i - p1.y].push_back(RGBtoUINT(shader(*this, j, i)));
-			}
-		}
-		
-		// Get the shaded pixels of the bottom triangle
-		shadedPixelsBottomTri.resize(p3.y - p2.y + 1);
-		for (int i = p2.y; i < p3.y; i++) {
-			x1 = lerp(p1.x, p3.x, (i - p1.y) / (float)(p3.y - p1.y));
-			x2 = lerp(p2.x, p3.x, (i - p2.y) / (float)(p3.y - p2.y));
-			if(x1 > x2) {
-				std::swap(x1, x2);
-			}
-			for (int j = std::round(x1); j < std::round(x2); j++) {
-				shadedPixelsBottomTri[i - p2.y].push_back(RGBtoUINT(shader(*this, j, i)));
-			}
-		}
-		
-		// Copy shaded pixels to render pixels
-		for (int i = p2.y; i >= p1.y; i--)	{
-			x1 = lerp(p1.x, p3.x, (i - p1.y) / (float)(p3.y - p1.y));
-			x2 = lerp(p1.x, p2.x, (i - p1.y) / (float)(p2.y - p1.y));
-			if(x1 > x2) {
-				std::swap(x1, x2);
-			}
-			memcpy(pixels + getIndex(std::round(x1), i), 
-				shadedPixelsTopTri[i - p1.y].data(), 
-				(std::round(x2) - std::round(x1)) * sizeof(uint32_t));
-		}
-		
-		// Get the shaded pixels of the bottom triangle
-		for (int i = p2.y; i < p3.y; i++)	{
-			x1 = lerp(p1.x, p3.x, (i - p1.y) / (float)(p3.y - p1.y));
-			x2 = lerp(p2.x, p3.x, (i - p2.y) / (float)(p3.y - p2.y));
-			if(x1 > x2) {
-				std::swap(x1, x2);
-			}
-			memcpy(pixels + getIndex(std::round(x1), i), 
-				shadedPixelsBottomTri[i - p2.y].data(), 
-				(std::round(x2) - std::round(x1)) * sizeof(uint32_t));
-		}
+	color = toCanvas(color);
+	CIDR_STATS_ADD(pixelsWritten, endX - startX + 1);
+	if (!useAlphaBlending && (color & 0xff) != 0) {
+		FillSpan(pixels + getIndex(startX, y), endX - startX + 1, color);
+	} else {
+		CIDR_STATS_ADD(pixelsBlended, endX - startX + 1);
+		blendSpan(pixels + getIndex(startX, y), endX - startX + 1, color);
 	}
 }
-
-void cdr::Renderer::drawScanLine(uint32_t color, int startX, int endX, int y) {
-	// std::fill_n(pixels + getIndex(startX, y), endX - startX, color);
-	for(int i = startX; i <= endX; i++) {
-		// if(GetPixel(i,y).r)
-		DrawPixel(color, i, y);
+void cdr::Renderer::drawSpan(const uint32_t* colors, int x, int y, int count) {
+	if (y < clip.y || y >= clip.y + clip.height) return;
+	if (x < clip.x) {
+		colors += clip.x - x;
+		count -= clip.x - x;
+		x = clip.x;
+	}
+	count = std::min(count, clip.x + clip.width - x);
+	if (count <= 0) return;
+	
+	uint32_t* dst {pixels + getIndex(x, y)};
+	CIDR_STATS_ADD(pixelsWritten, count);
+	if (usePremultipliedAlpha) {
+		// NOTE: the colors are straight, they are converted in chunks on the stack
+		constexpr int chunkSize {256};
+		uint32_t premultiplied[chunkSize];
+		for (int i = 0; i < count; i += chunkSize) {
+			int chunkCount {std::min(chunkSize, count - i)};
+			PremultiplySpan(premultiplied, colors + i, chunkCount);
+			writeSpan(premultiplied, dst + i, chunkCount);
+		}
+	} else {
+		writeSpan(colors, dst, count);
 	}
 }
-void cdr::Renderer::drawScanLine(const RGBA& color1, const RGBA& color2, int startX, int endX, int y) {
-	float rStep{(color2.r - color1.r) / (float)(endX - startX)};
-	float gStep{(color2.g - color1.g) / (float)(endX - startX)};
-	float bStep{(color2.b - color1.b) / (float)(endX - startX)};
-	float aStep{(color2.a - color1.a) / (float)(endX - startX)};
-	
-	float rLerp{static_cast<float>(color1.r)};
-	float gLerp{static_cast<float>(color1.g)};
-	float bLerp{static_cast<float>(color1.b)};
-	float aLerp{static_cast<float>(color1.a)};
-	
-	for (int i = startX; i < endX; i++) {
-		DrawPixel({(uint8_t)rLerp, (uint8_t)gLerp, (uint8_t)bLerp, (uint8_t)aLerp}, i, y);
-		
-		rLerp += rStep;
-		gLerp += gStep;
-		bLerp += bStep;
-		aLerp += aStep;
+void cdr::Renderer::writeSpan(const uint32_t* colors, uint32_t* dst, int count) {
+	if (useAlphaBlending) {
+		CIDR_STATS_ADD(pixelsBlended, count);
+		blendSpan(dst, colors, count);
+		return;
+	}
+#ifdef CIDR_STATS
+	if (collectStats) {
+		for (int i = 0; i < count; i++) {
+			stats.pixelsBlended += (colors[i] & 0xff) == 0;
+		}
+	}
+#endif
+	// NOTE: same as DrawPixel, pixels with an alpha of 0 are blended even if alpha blending is disabled
+	for (int i = 0; i < count; i++) {
+		dst[i] = (colors[i] & 0xff) != 0 ? colors[i] : blendPixel(dst[i], colors[i]);
 	}
 }
 // TODO: fix this mess
-void cdr::Renderer::DrawBitmap(const Bitmap& bitmap, float destX, float destY, int destWidth, int destHeight, float srcX, float srcY, int srcWidth, int srcHeight) {
+void cdr::Renderer::DrawBitmap(const BitmapView& bitmap, float destX, float destY, int destWidth, int destHeight, float srcX, float srcY, int srcWidth, int srcHeight) {
+	CIDR_STATS_SCOPE(Bitmap);
+	if (bitmap.IsEmpty()) return;
 	// Exit if image is out of bounds of the canvas
 	if(destX >= width) return;	
 	if(destY >= height) return;
 	if(destX + destWidth < 0) return;
 	if(destY + destHeight < 0) return;
+	addDamage(destX, destY, destX + destWidth, destY + destHeight, 0);
 		
 	// optimzation if image has no scale
 	if(destWidth == srcWidth && destHeight == srcHeight && srcX == 0 && srcY == 0 && srcWidth == bitmap.GetWidth() && srcHeight == bitmap.GetHeight()) {
-		/* srcRectangle == destRectangle, I'm only going to use srcRectangle */
-		
-		if(destX < 0) {
-			srcX += std::abs(destX);
-			srcWidth -= std::abs(destX);
-			destWidth = srcWidth;
-			destX = 0;
-		}
-		if(destX + destWidth >= width) {
-			srcWidth += width - (destX + destWidth);;
-			destWidth = srcWidth;
-		}
-		if(destY < 0) {
-			srcY += std::abs(destY);
-			srcHeight -= std::abs(destY);
-			destHeight = srcHeight;
-			destY = 0;
-		}
-		if(destY + destHeight >= height) {
-			srcHeight += height - (destY + destHeight);;
-			destHeight += srcHeight;
-		}
-		
-		for(int i = srcY; i < srcY + bitmap.GetHeight() - (bitmap.GetHeight() - destHeight); i++) {			
-			memcpy(pixels + getIndex(destX, destY + (i - srcY)), 
-				bitmap.GetData() + i * bitmap.GetWidth() + (int)srcX, 
-				(bitmap.GetWidth() - (bitmap.GetWidth() - srcWidth)) * sizeof(uint32_t)); 
+		/* srcRectangle == destRectangle, I'm only going to copy the visible rows */
+		Rectangle destRect {static_cast<int>(destX), static_cast<int>(destY), destWidth, destHeight};
+		Rectangle visible {clipRectangle(destRect)};
+		CIDR_STATS_ADD(pixelsWritten, uint64_t(visible.width) * visible.height);
+		
+		for(int y = visible.y; y < visible.y + visible.height; y++) {
+			uint32_t* dst {pixels + getIndex(visible.x, y)};
+			const uint32_t* src {bitmap.GetRow(y - destRect.y) + (visible.x - destRect.x)};
+			if (bitmap.IsPremultiplied() == usePremultipliedAlpha) {
+				memcpy(dst, src, visible.width * sizeof(uint32_t));
+			} else if (usePremultipliedAlpha) {
+				PremultiplySpan(dst, src, visible.width);
+			} else {
+				UnpremultiplySpan(dst, src, visible.width);
+			}
 		}
 	} else {
 		float cx = destWidth / (float)srcWidth;
 		float cy = destHeight / (float)srcHeight;
-		
-		for (int iDest = destX; iDest < destX + destWidth; iDest++) {
-			for (int jDest = destY; jDest < destY + destHeight; jDest++) {
-				
-				if(iDest < 0 || jDest < 0 || iDest >= GetWidth() || jDest >= GetHeight()) 
-					continue;
-				
+		// NOTE: the mip level is the same for every pixel, it only depends on the scale
+		float lod = std::log2(std::max(1 / cx, 1 / cy));
+		
+		// NOTE: the destination rows and columns start at the truncated position, only the ones inside of the clip are walked
+		int startX {std::max(static_cast<int>(destX), clip.x)};
+		int startY {std::max(static_cast<int>(destY), clip.y)};
+		int clipRight {clip.x + clip.width};
+		int clipBottom {clip.y + clip.height};
+		for (int jDest = startY; jDest < destY + destHeight && jDest < clipBottom; jDest++) {
+			for (int iDest = startX; iDest < destX + destWidth && iDest < clipRight; iDest++) {
 				float iSrc = (iDest - destX) / (float)cx + srcX;
 				float jSrc = (jDest - destY) / (float)cy + srcY;
 				
-				DrawPixel(sampleTexture(bitmap, iSrc, jSrc), iDest, jDest);
+				CIDR_STATS_ADD(textureSamples, 1);
+				drawTexelUnclipped(bitmap, RGBtoUINT(sampleTexture(bitmap, iSrc, jSrc, lod)), iDest, jDest);
 				
 #if 0
 				int fooX = 0;
@@ -1064,7 +816,46 @@ void cdr::Renderer::DrawBitmap(const Bitmap& bitmap, float destX, float destY, i
 		}
 	}
 }
-cdr::RGBA cdr::Renderer::sampleTexture(const cdr::Bitmap& bitmap, float xSrc, float ySrc) const {
+template <typename Format>
+void cdr::Renderer::drawFormatBitmap(const FormatBitmap<Format>& bitmap, int x, int y) {
+	Rectangle visible {clipRectangle(Rectangle{x, y, bitmap.GetWidth(), bitmap.GetHeight()})};
+	addDamage(visible);
+	constexpr int chunkSize {256};
+	uint32_t colors[chunkSize];
+	for (int row = visible.y; row < visible.y + visible.height; row++) {
+		const typename Format::Pixel* source {bitmap.GetData() + size_t(row - y) * bitmap.GetWidth() + (visible.x - x)};
+		for (int i = 0; i < visible.width; i += chunkSize) {
+			int count {std::min(chunkSize, visible.width - i)};
+			ConvertPixels<Format, RGBA8888>(source + i, colors, count);
+			drawSpan(colors, visible.x + i, row, count);
+		}
+	}
+}
+void cdr::Renderer::DrawBitmap(const MonochromeBitmap& bitmap, int x, int y) {
+	CIDR_STATS_SCOPE(Bitmap);
+	drawFormatBitmap(bitmap, x, y);
+}
+void cdr::Renderer::DrawBitmap(const RGB24Bitmap& bitmap, int x, int y) {
+	CIDR_STATS_SCOPE(Bitmap);
+	drawFormatBitmap(bitmap, x, y);
+}
+void cdr::Renderer::DrawBitmap(const MaskBitmap& mask, const RGBA& color, int x, int y) {
+	CIDR_STATS_SCOPE(Bitmap);
+	drawCoverageMask(mask.GetData(), mask.GetWidth(), mask.GetHeight(), RGBtoUINT(color), x, y);
+}
+void cdr::Renderer::DrawBitmap(const MonochromeBitmap& mask, const RGBA& color, int x, int y) {
+	CIDR_STATS_SCOPE(Bitmap);
+	drawCoverageMask(mask.GetData(), mask.GetWidth(), mask.GetHeight(), RGBtoUINT(color), x, y);
+}
+void cdr::Renderer::drawCoverageMask(const uint8_t* coverage, int maskWidth, int maskHeight, uint32_t color, int x, int y) {
+	Rectangle visible {clipRectangle(Rectangle{x, y, maskWidth, maskHeight})};
+	addDamage(visible);
+	// NOTE: only one byte per pixel is read from the mask, the colors are built by drawCoverageSpan
+	for (int row = visible.y; row < visible.y + visible.height; row++) {
+		drawCoverageSpan(color, coverage + size_t(row - y) * maskWidth + (visible.x - x), visible.x, row, visible.width);
+	}
+}
+cdr::RGBA cdr::Renderer::sampleTexture(const BitmapView& bitmap, float xSrc, float ySrc) const {
 	int fooX = 0;
 	int fooY = 0;
 	
@@ -1077,7 +868,7 @@ cdr::RGBA cdr::Renderer::sampleTexture(const cdr::Bitmap& bitmap, float xSrc, fl
 			fooY = (int)((ySrc + 0.000001) / bitmap.GetHeight()) % 2 + (ySrc < 0 ? 1 : 0);
 		}
 		else if(OutOfBoundsType == OutOfBoundsType::ClampToBorder) {
-			return ClampToBorderColor;
+			return RGBA{getBorderColor(bitmap)};
 		}
 	} 
 	else if (this->ScaleType == ScaleType::Nearest) {
@@ -1088,7 +879,7 @@ cdr::RGBA cdr::Renderer::sampleTexture(const cdr::Bitmap& bitmap, float xSrc, fl
 	if(this->ScaleType == ScaleType::Nearest) {
 		return bitmap.GetPixel(fooX ? std::ceil(x) : x, fooY ? std::ceil(y) : y);
 	} else { 
-		// TODO: cheßck if downscaling works properly
+		// NOTE: scaling down a lot aliases here, ScaleType::Trilinear uses the mip chain for that
 		
 		// NOTE: subtract 0.5 in order to put the point in the centre of the pixel
 		if(fooX) x += 0.5;
@@ -1096,26 +887,7 @@ cdr::RGBA cdr::Renderer::sampleTexture(const cdr::Bitmap& bitmap, float xSrc, fl
 		if(fooY) y += 0.5;
 		else 	 y -= 0.5;
 		
-		if(x < 0) x = 0;
-		if(x >= bitmap.GetWidth()) x = bitmap.GetWidth() - 1;
-		if(y < 0) y = 0;
-		if(y >= bitmap.GetHeight()) y = bitmap.GetHeight() - 1;
-
-		float iSrcFraction = x - int(x);
-		float jSrcFraction = y - int(y);
-		
-		uint32_t colorTL = bitmap.GetRawPixel(x, y);
-		uint32_t colorBL = bitmap.GetRawPixel(x, (y+1 >= bitmap.GetHeight() ? y : y + 1));
-		uint32_t colorTR = bitmap.GetRawPixel((x+1 >= bitmap.GetWidth() ? x : x + 1), y);
-		uint32_t colorBR = bitmap.GetRawPixel((x+1 >= bitmap.GetWidth() ? x : x + 1), (y+1 >= bitmap.GetHeight() ? y : y + 1));
-		
-		return RGBA(
-			(getR(colorTL) * (1 - iSrcFraction) + getR(colorTR) * iSrcFraction) * (1 - jSrcFraction) + (getR(colorBL) * (1 - iSrcFraction) + getR(colorBR) * iSrcFraction) * jSrcFraction, 
-			(getG(colorTL) * (1 - iSrcFraction) + getG(colorTR) * iSrcFraction) * (1 - jSrcFraction) + (getG(colorBL) * (1 - iSrcFraction) + getG(colorBR) * iSrcFraction) * jSrcFraction, 
-			(getB(colorTL) * (1 - iSrcFraction) + getB(colorTR) * iSrcFraction) * (1 - jSrcFraction) + (getB(colorBL) * (1 - iSrcFraction) + getB(colorBR) * iSrcFraction) * jSrcFraction,
-			(getA(colorTL) * (1 - iSrcFraction) + getA(colorTR) * iSrcFraction) * (1 - jSrcFraction) + (getA(colorBL) * (1 - iSrcFraction) + getA(colorBR) * iSrcFraction) * jSrcFraction
-		);
-		
+		return sampleBilinear(bitmap.GetData(), bitmap.GetWidth(), bitmap.GetHeight(), bitmap.GetStride(), x, y, useLinearLight);
 		
 		// uint8_t ct_r = getR(colorTL) * (1 - iSrcFraction) + getR(colorTR) * iSrcFraction;
 		// uint8_t ct_g = getG(colorTL) * (1 - iSrcFraction) + getG(colorTR) * iSrcFraction;
@@ -1140,12 +912,77 @@ cdr::RGBA cdr::Renderer::sampleTexture(const cdr::Bitmap& bitmap, float xSrc, fl
 		// return c;
 	}
 }
-uint32_t cdr::Renderer::sampleTextureRaw(const cdr::Bitmap& bitmap, float xSrc, float ySrc) const {
+cdr::RGBA cdr::Renderer::sampleTexture(const BitmapView& bitmap, float xSrc, float ySrc, float lod) const {
+	if (this->ScaleType != ScaleType::Trilinear || lod <= 0 || !bitmap.HasMipmaps()) {
+		return sampleTexture(bitmap, xSrc, ySrc);
+	}
+	
+	float x {xSrc};
+	float y {ySrc};
+	if (!clampCoords(x, y, bitmap.GetWidth(), bitmap.GetHeight()) && OutOfBoundsType == OutOfBoundsType::ClampToBorder) {
+		return RGBA{getBorderColor(bitmap)};
+	}
+	
+	lod = std::min(lod, static_cast<float>(bitmap.GetMipLevelCount() - 1));
+	int level {static_cast<int>(lod)};
+	float t {lod - level};
+	// NOTE: the coordinates are in texels of level 0, subtract 0.5 in order to put the point in the centre of the texel
+	auto sampleLevel = [&](int level) {
+		float scaleX {bitmap.GetMipWidth(level) / static_cast<float>(bitmap.GetWidth())};
+		float scaleY {bitmap.GetMipHeight(level) / static_cast<float>(bitmap.GetHeight())};
+		return sampleBilinear(bitmap.GetMipData(level), bitmap.GetMipWidth(level), bitmap.GetMipHeight(level), bitmap.GetMipStride(level), x * scaleX - 0.5f, y * scaleY - 0.5f, useLinearLight);
+	};
+	RGBA c0 {sampleLevel(level)};
+	if (t == 0 || level + 1 >= bitmap.GetMipLevelCount()) return c0;
+	RGBA c1 {sampleLevel(level + 1)};
+	if (useLinearLight) return mixLinear(c0, c1, t);
+	return RGBA(
+		c0.r * (1 - t) + c1.r * t,
+		c0.g * (1 - t) + c1.g * t,
+		c0.b * (1 - t) + c1.b * t,
+		c0.a * (1 - t) + c1.a * t
+	);
+}
+cdr::RGBA cdr::Renderer::sampleBilinear(const uint32_t* data, int width, int height, int stride, float x, float y, bool linear) {
+	if(x < 0) x = 0;
+	if(x >= width) x = width - 1;
+	if(y < 0) y = 0;
+	if(y >= height) y = height - 1;
+
+	float iSrcFraction = x - int(x);
+	float jSrcFraction = y - int(y);
+	
+	int x0 = x;
+	int y0 = y;
+	int x1 = x0 + 1 >= width ? x0 : x0 + 1;
+	int y1 = y0 + 1 >= height ? y0 : y0 + 1;
+	uint32_t colorTL = data[x0 + y0 * stride];
+	uint32_t colorBL = data[x0 + y1 * stride];
+	uint32_t colorTR = data[x1 + y0 * stride];
+	uint32_t colorBR = data[x1 + y1 * stride];
+	
+	if (linear) {
+		const SRGBTables& tables {GetSRGBTables()};
+		auto channel = [&](int shift) {
+			auto at = [&](uint32_t color) { return static_cast<float>(tables.toLinear[(color >> shift) & 0xff]); };
+			return encodeLinear(tables, (at(colorTL) * (1 - iSrcFraction) + at(colorTR) * iSrcFraction) * (1 - jSrcFraction) + (at(colorBL) * (1 - iSrcFraction) + at(colorBR) * iSrcFraction) * jSrcFraction);
+		};
+		return RGBA(channel(24), channel(16), channel(8),
+			(getA(colorTL) * (1 - iSrcFraction) + getA(colorTR) * iSrcFraction) * (1 - jSrcFraction) + (getA(colorBL) * (1 - iSrcFraction) + getA(colorBR) * iSrcFraction) * jSrcFraction);
+	}
+	return RGBA(
+		(getR(colorTL) * (1 - iSrcFraction) + getR(colorTR) * iSrcFraction) * (1 - jSrcFraction) + (getR(colorBL) * (1 - iSrcFraction) + getR(colorBR) * iSrcFraction) * jSrcFraction, 
+		(getG(colorTL) * (1 - iSrcFraction) + getG(colorTR) * iSrcFraction) * (1 - jSrcFraction) + (getG(colorBL) * (1 - iSrcFraction) + getG(colorBR) * iSrcFraction) * jSrcFraction, 
+		(getB(colorTL) * (1 - iSrcFraction) + getB(colorTR) * iSrcFraction) * (1 - jSrcFraction) + (getB(colorBL) * (1 - iSrcFraction) + getB(colorBR) * iSrcFraction) * jSrcFraction,
+		(getA(colorTL) * (1 - iSrcFraction) + getA(colorTR) * iSrcFraction) * (1 - jSrcFraction) + (getA(colorBL) * (1 - iSrcFraction) + getA(colorBR) * iSrcFraction) * jSrcFraction
+	);
+}
+uint32_t cdr::Renderer::sampleTextureRaw(const BitmapView& bitmap, float xSrc, float ySrc) const {
 	if(xSrc >= 0 && ySrc >= 0 && xSrc < bitmap.GetWidth() && ySrc < bitmap.GetHeight()) {
 		return bitmap.GetRawPixel(xSrc, ySrc);
 	}  else {
 		if(OutOfBoundsType == OutOfBoundsType::ClampToBorder) {
-			return RGBtoUINT(ClampToBorderColor);
+			return getBorderColor(bitmap);
 		}
 		
 		int x (xSrc);
@@ -1163,11 +1000,10 @@ uint32_t cdr::Renderer::sampleTextureRaw(const cdr::Bitmap& bitmap, float xSrc,
 }
 
 void cdr::Renderer::DrawGlyph(uint8_t glyph, int x, int y, const TextStyle& ts) {
+	CIDR_STATS_SCOPE(Text);
 	int fontWidth = ts.font->GetFontWidth();
 	int fontHeight = ts.font->GetFontHeight();
 	
-	int letterX = glyph % (ts.font->GetFontSheetWidth() / fontWidth);
-	int letterY = glyph / (ts.font->GetFontSheetHeight() / fontHeight);
 	if (x >= 0 && y >= 0) {
 		switch (ts.ta) {
 			case TextAlignment::TL: break; // NOTE: this is Default
@@ -1185,26 +1021,9 @@ void cdr::Renderer::DrawGlyph(uint8_t glyph, int x, int y, const TextStyle& ts)
 									y -= fontHeight*ts.size; break;
 		}
 	}
-	for (int i = 0; i < fontWidth * ts.size; i++) {
-		for (int j = 0; j < fontHeight * ts.size; j++) {
-			const RGB& letterPixel = ts.font->GetPixel(letterX * fontWidth + i / ts.size, letterY * fontHeight + j / ts.size);
-			int subX{static_cast<int>(x + i)};
-			int subY{static_cast<int>(y + j)};
-			
-			if (subX >= GetWidth() || subY >= GetHeight() || subX < 0 || subY < 0) continue;
-			
-			if (letterPixel == RGB::Black && ts.bColor != RGBA::Transparent && GetPixel(subX, subY) != ts.shadowColor) {
-				DrawPixel(ts.bColor, subX, subY);
-			} else if(letterPixel == RGB::White) {
-				DrawPixel(ts.fColor, subX, subY);
-				int sx = i/ts.size + ts.shadowOffsetX;
-				int sy = j/ts.size + ts.shadowOffsetY;
-				if (sx < 0 || sy < 0 || sx >= fontWidth || sy >= fontHeight || ts.font->GetPixel(letterX * fontWidth + sx, letterY * fontHeight + sy) == RGB::Black) {
-					DrawPixel(ts.shadowColor, subX + ts.shadowOffsetX*ts.size, subY + ts.shadowOffsetY*ts.size);
-				}
-			}
-		}
-	}
+	TextStyle unkerned {ts};
+	unkerned.useKerning = false;
+	drawGlyphMask(glyphCache->GetFace(unkerned)->GetGlyph(glyph), x, y, ts, false);
 }
 void cdr::Renderer::DrawText(const std::string_view text, const TextStyle& ts) {
 	DrawText(text, globalX * ts.font->GetFontWidth(), globalY * ts.font->GetFontHeight(), ts);
@@ -1228,6 +1047,7 @@ void cdr::Renderer::DrawText(const std::string_view text, const TextStyle& ts) {
 	}
 }
 void cdr::Renderer::DrawText(const std::string_view text, int x, int y, const TextStyle& ts) {
+	CIDR_STATS_SCOPE(Text);
 	int fontSizeWidth = ts.font->GetFontWidth();
 	int fontSizeHeight = ts.font->GetFontHeight();
 	int charsRows = ts.font->GetFontSheetWidth() / fontSizeWidth;
@@ -1279,13 +1099,12 @@ void cdr::Renderer::DrawText(const std::string_view text, int x, int y, const Te
 		}
 	}
 	
+	const std::shared_ptr<const GlyphCache::Face> face {glyphCache->GetFace(ts)};
 	int caretCol{};
 	int newLineCount{};
 	for (int letterIndex = 0; (unsigned)letterIndex < text.size(); letterIndex++) {
 		const unsigned char& letter = text[letterIndex];
 				
-		int letterX = letter % charsCols;
-		int letterY = letter / charsRows;
 		if (letter == '\n') {
 			newLineCount++;
 			caretCol = 0;
@@ -1295,42 +1114,101 @@ void cdr::Renderer::DrawText(const std::string_view text, int x, int y, const Te
 			FillRectangle(ts.bColor, x + caretCol * ts.size, y + newLineCount * fontSizeHeight, fontSizeWidth * tab, fontSizeHeight);
 			caretCol += tab * fontSizeWidth;
 		} else {
-			int start = 0;
-			int end = fontSizeWidth;
-			if (ts.useKerning) {
-				start = std::min(ts.font->GetLeftKernel(letterX, letterY), ts.font->GetRightKernel(letterX, letterY));
-				end   = std::max(ts.font->GetLeftKernel(letterX, letterY), ts.font->GetRightKernel(letterX, letterY));
+			const GlyphCache::Glyph& glyph {face->GetGlyph(letter)};
+			drawGlyphMask(glyph, x + caretCol * ts.size, y + newLineCount * fontSizeHeight, ts, true);
+			caretCol += glyph.advance;
+		}
+	}
+}
+
+void cdr::Renderer::drawGlyphMask(const GlyphCache::Glyph& glyph, float x, int y, const TextStyle& ts, bool textRules) {
+	// NOTE: textRules are the rules DrawText uses: pixels outside of the kerning are background
+	// and a shadow is not drawn on top of the foreground color.
+	// The passes are drawn in the order background, shadow, foreground, so the foreground
+	// ends up on top of the shadow and the shadow on top of the background like before
+	const uint8_t backgroundBits = textRules ? (GlyphCache::Black | GlyphCache::OutsideKerning) : GlyphCache::Black;
+	auto isForeground = [&](uint8_t bits) {
+		return (bits & GlyphCache::White) && !(textRules && (bits & (GlyphCache::Black | GlyphCache::OutsideKerning)));
+	};
+	// NOTE: the columns are converted like the float positions they used to be
+	auto columnX = [&](int column) { return static_cast<int>(x + column); };
+	const int width {GetWidth()};
+	const int height {GetHeight()};
+
+	// NOTE: the rows and columns of the mask that are inside of the clip, found once for the whole glyph
+	const int rowBegin {std::max(0, clip.y - y)};
+	const int rowEnd {std::min(glyph.height, clip.y + clip.height - y)};
+	int columnBegin {0};
+	while (columnBegin < glyph.width && columnX(columnBegin) < clip.x) columnBegin++;
+	int columnEnd {columnBegin};
+	while (columnEnd < glyph.width && columnX(columnEnd) < clip.x + clip.width) columnEnd++;
+	if (trackDamage && glyph.width > 0 && glyph.height > 0) {
+		addDamage(columnX(0), y, columnX(glyph.width - 1), y + glyph.height - 1, 0);
+		// NOTE: the shadow is drawn pixel by pixel, its box is added up front so it's a single rectangle
+		float shadowX {ts.shadowOffsetX * ts.size};
+		float shadowY {ts.shadowOffsetY * ts.size};
+		addDamage(columnX(0) + shadowX, y + shadowY, columnX(glyph.width - 1) + shadowX, y + glyph.height - 1 + shadowY, 1);
+	}
+
+	if (ts.bColor != RGBA::Transparent) {
+		const uint32_t background {RGBtoUINT(ts.bColor)};
+		const uint32_t shadow {toCanvas(RGBtoUINT(ts.shadowColor))};
+		for (int j = rowBegin; j < rowEnd; j++) {
+			int py {y + j};
+			const uint8_t* row {glyph.mask.data() + j * glyph.width};
+			for (int i = columnBegin; i < columnEnd; i++) {
+				if (!(row[i] & backgroundBits)) continue;
+				int px {columnX(i)};
+				if (pixels[getIndex(px, py)] != shadow) {
+					drawPixelUnclipped(background, px, py);
+				}
 			}
-			for (int i = start; i < end * ts.size; i++) {
-				for (int j = 0; j < fontSizeHeight * ts.size; j++) {
-					const RGB& letterPixel = ts.font->GetPixel(letterX * fontSizeWidth + i / ts.size, letterY * fontSizeHeight + j / ts.size);
-					
-					int subX = x + caretCol * ts.size + (i - start);
-					int subY = y + newLineCount * fontSizeHeight + j;
-					
-					if(subX >= GetWidth() || subY >= GetHeight() || 
-					subX < 0 || subY < 0)
-					continue;
-					
-					if(ts.bColor != RGBA::Transparent && (letterPixel == RGB::Black || i < 0 || i >= ts.font->GetRightKernel(letterX, letterY) * ts.size) && GetPixel(subX, subY) != ts.shadowColor) {
-						DrawPixel(ts.bColor, subX, subY);
-					} else if(letterPixel == RGB::White && !(letterPixel == RGB::Black || i < 0 || i >= ts.font->GetRightKernel(letterX, letterY) * ts.size)) {
-						DrawPixel(ts.fColor, subX, subY);
-						int sx = i/ts.size + ts.shadowOffsetX;
-						int sy = j/ts.size + ts.shadowOffsetY;
-						if((sx < 0 || sy < 0 || sx >= fontSizeWidth || sy >= fontSizeHeight || ts.font->GetPixel(letterX * fontSizeWidth + sx, letterY * fontSizeHeight + sy) == RGB::Black)
-							&& GetPixel(subX + ts.shadowOffsetX*ts.size, subY + ts.shadowOffsetY*ts.size) != ts.fColor) { // HACK: checks if color of pixel is foreground color
-							DrawPixel(ts.shadowColor, subX + ts.shadowOffsetX*ts.size, subY + ts.shadowOffsetY*ts.size);
-						}
-					}
+		}
+	}
+
+	const float shadowX {ts.shadowOffsetX * ts.size};
+	const float shadowY {ts.shadowOffsetY * ts.size};
+	// NOTE: a shadow can fall into the clip from a glyph pixel outside of it, so it is the only pass that walks the whole glyph
+	auto drawShadow = [&]() {
+		for (int j = 0; j < glyph.height; j++) {
+			int py {y + j};
+			if (py < 0 || py >= height) continue;
+			const uint8_t* row {glyph.mask.data() + j * glyph.width};
+			for (int i = 0; i < glyph.width; i++) {
+				int px {columnX(i)};
+				if (px < 0 || px >= width || !isForeground(row[i]) || !(row[i] & GlyphCache::Shadow)) continue;
+				int sx {static_cast<int>(px + shadowX)};
+				int sy {static_cast<int>(py + shadowY)};
+				// NOTE: the pixel is only read inside of the clip, a CommandList draws the tiles around it at the same time
+				if (!isInClip(sx, sy)) continue;
+				if (!textRules || GetPixel(sx, sy) != ts.fColor) { // HACK: checks if color of pixel is foreground color
+					DrawPixel(ts.shadowColor, sx, sy);
 				}
 			}
-			if (ts.useKerning)
-				caretCol += end - start;
-			else 
-				caretCol += fontSizeWidth;
+		}
+	};
+	// NOTE: without the text rules the shadow isn't kept off the foreground. It used to be drawn
+	// pixel by pixel column by column, so a shadow pointing to the left (or up) covered the foreground
+	const bool shadowOnTop {!textRules && (ts.shadowOffsetX < 0 || (ts.shadowOffsetX == 0 && ts.shadowOffsetY < 0))};
+	if (!shadowOnTop) drawShadow();
+
+	// the foreground is drawn in runs
+	const uint32_t foreground {RGBtoUINT(ts.fColor)};
+	for (int j = rowBegin; j < rowEnd; j++) {
+		int py {y + j};
+		const uint8_t* row {glyph.mask.data() + j * glyph.width};
+		for (int i = 0; i < glyph.width; i++) {
+			if (!isForeground(row[i])) continue;
+			int runStart {i};
+			while (i + 1 < glyph.width && isForeground(row[i + 1])) i++;
+			int startX {std::max(columnX(runStart), clip.x)};
+			int endX {std::min(columnX(i), clip.x + clip.width - 1)};
+			if (startX <= endX) {
+				drawScanLine(foreground, startX, endX, py);
+			}
 		}
 	}
+	if (shadowOnTop) drawShadow();
 }
 
 /* UTILILTY FUNCTIONS */
@@ -1428,7 +1306,7 @@ bool cdr::Renderer::clampCoords(int& x, int& y, int width, int height) const {
 }
 
 #if 0
-void cdr::Renderer::DrawTriangle(const Bitmap& texture, FPoint tp1, FPoint tp2, FPoint tp3, FPoint p1, FPoint p2, FPoint p3) {
+void cdr::Renderer::DrawTriangle(const BitmapView& texture, FPoint tp1, FPoint tp2, FPoint tp3, FPoint p1, FPoint p2, FPoint p3) {
 	// sort top most point
 	if(p1.y > p2.y) {
 		std::swap(p1, p2);
@@ -8,20 +8,47 @@
 #define CIDR_RENDERER_HPP
 
 #include <cmath>
+#include <algorithm>
 #include <string_view>
+#include <type_traits>
+#include <vector>
 #include "color.hpp"
 #include "point.hpp"
 #include "bitmap.hpp"
+#include "formatBitmap.hpp"
 #include "rectangle.hpp"
 #include "font.hpp"
+#include "frameArena.hpp"
+#include "glyphCache.hpp"
+#include "renderStats.hpp"
+#include "damageRegion.hpp"
+#include "canvasClip.hpp"
 
 namespace cdr {
+
+class CommandList;
+class Renderer;
+class CoverageRasterizer;
+
+// NOTE: besides plain function pointers, FillRectangle, FillCircle, FillEllipse and FillTriangle accept any callable as shader:
+// pixel shader: RGBA (or uint32_t) shader(const Renderer& renderer, int x, int y)
+// span shader:  void shader(const Renderer& renderer, int x0, int x1, int y, uint32_t* out)
+//               writes the pixels x0 <= x < x1 of row y to out[0] ... out[x1 - x0 - 1]
+template <typename Shader>
+constexpr bool isPixelShader = std::is_invocable_v<const Shader&, const Renderer&, int, int>;
+template <typename Shader>
+constexpr bool isSpanShader = std::is_invocable_v<const Shader&, const Renderer&, int, int, int, uint32_t*>;
 	
-class Renderer {
+class Renderer : public CanvasClip {
+	friend class CommandList;
+
 public:
+	// NOTE: Trilinear samples the two closest mip levels bilinearly and blends them, when the bitmap is
+	// scaled down. It needs bitmap.GenerateMipmaps(), without mipmaps it is the same as Linear
 	enum class ScaleType {
 		Nearest,
 		Linear,
+		Trilinear,
 	} ScaleType = ScaleType::Nearest;
 	
 	enum class OutOfBoundsType {
@@ -33,7 +60,9 @@ public:
 	RGBA ClampToBorderColor {};
 
 	/* CONSTRUCTOR - DESTRUCTOR */
-	Renderer(uint32_t* pixels, int width, int height);
+	// NOTE: stride is the number of pixels from the start of one row to the start of the next one, for buffers
+	// with padded rows (e.g. the pitch of SDL_LockTexture divided by 4), 0 means the rows are tightly packed
+	Renderer(uint32_t* pixels, int width, int height, int stride = 0);
 	
 	/* CLEAR FUNCTIONS */ 
 	void Clear();
@@ -49,15 +78,33 @@ public:
 	void DrawCircle(const RGBA& color, const Point& centreLocation, int radius, bool AA = false);
 	void FillCircle(const RGBA& color, const Point& centreLocation, int radius, bool AA = false);
 	void FillCircle(RGBA (*shader)(const Renderer& renderer, int x, int y), const Point& centreLocation, int radius, bool AA = false);
+	// NOTE: axis aligned ellipses covering radiusX * 2 + 1 by radiusY * 2 + 1 pixels, a circle is the same as an ellipse with equal radii
+	void DrawEllipse(const RGBA& color, const Point& centreLocation, int radiusX, int radiusY, bool AA = false);
+	void FillEllipse(const RGBA& color, const Point& centreLocation, int radiusX, int radiusY, bool AA = false);
+	void FillEllipse(RGBA (*shader)(const Renderer& renderer, int x, int y), const Point& centreLocation, int radiusX, int radiusY, bool AA = false);
 	void DrawTriangle(const RGBA& color, const Point& p1, const Point& p2, const Point& p3, bool AA = false, bool GC = false);
-	void FillTriangle(const RGBA& color, Point p1, Point p2, Point p3);
+	// NOTE: anti aliased triangles, polygons and rounded rectangles get the exact area each pixel is covered by (see CoverageRasterizer)
+	void FillTriangle(const RGBA& color, Point p1, Point p2, Point p3, bool AA = false);
 	void FillTriangle(RGBA color1, RGBA color2, RGBA color3, Point p1, Point p2, Point p3);
 	void FillTriangle(RGBA (*shader)(const Renderer& renderer, int x, int y), Point p1, Point p2, Point p3);
-	void DrawBitmap(const Bitmap& bitmap, float destX, float destY, int destWidth, int destHeight, float srcX, float srcY, int srcWidth, int srcHeight);
+	// NOTE: the polygon is closed and may be concave or intersect itself (non-zero fill rule). Without anti aliasing
+	// every pixel covered at least half is drawn
+	void FillPolygon(const RGBA& color, const FPoint* points, int count, bool AA = false);
+	// NOTE: covers the same pixels as FillRectangle with circular corners, the radius is clamped to half of the smaller side
+	void FillRoundedRectangle(const RGBA& color, Rectangle rectangle, int radius, bool AA = false);
+	void DrawBitmap(const BitmapView& bitmap, float destX, float destY, int destWidth, int destHeight, float srcX, float srcY, int srcWidth, int srcHeight);
 	void DrawGlyph(uint8_t glyph, int x, int y, const TextStyle& ts);
 	void DrawText(const std::string_view text, const TextStyle& ts);
 	void DrawText(const std::string_view text, int x, int y, const TextStyle& ts);
-	void DrawTriangle(const Bitmap& texture, FPoint tp1, FPoint tp2, FPoint tp3, FPoint p1, FPoint p2, FPoint p3);
+	void DrawTriangle(const BitmapView& texture, FPoint tp1, FPoint tp2, FPoint tp3, FPoint p1, FPoint p2, FPoint p3);
+	// NOTE: grey and RGB24 bitmaps are drawn unscaled with their top left corner at x, y, converted to RGBA
+	// a few pixels at a time and with the same rules as DrawPixel. Draw ToBitmap() to scale them
+	void DrawBitmap(const MonochromeBitmap& bitmap, int x, int y);
+	void DrawBitmap(const RGB24Bitmap& bitmap, int x, int y);
+	// NOTE: the mask is the coverage of the color (a grey bitmap is used the same way): every pixel is blended
+	// with the alpha of the color times the coverage, even if alpha blending is disabled, like anti aliased edges
+	void DrawBitmap(const MaskBitmap& mask, const RGBA& color, int x, int y);
+	void DrawBitmap(const MonochromeBitmap& mask, const RGBA& color, int x, int y);
 	
 	/* DRAWING FUNCTION OVERLOADS */
 		   void DrawPixel(const RGBA& color, int x, int y);
@@ -68,12 +115,21 @@ public:
 	inline void DrawCircle(const RGBA& color, int centreX, int centreY, int radius, bool AA = false) { DrawCircle(color, Point{centreX,centreY}, radius, AA); }
 	inline void FillCircle(const RGBA& color, int centreX, int centreY, int radius, bool AA = false) { FillCircle(color, Point{centreX,centreY}, radius, AA); }
 	inline void FillCircle(RGBA (*shader)(const Renderer& renderer, int x, int y), int centreX, int centreY, int radius, bool AA = false) { FillCircle(shader, Point{centreX,centreY}, radius, AA); }
+	inline void DrawEllipse(const RGBA& color, int centreX, int centreY, int radiusX, int radiusY, bool AA = false) { DrawEllipse(color, Point{centreX, centreY}, radiusX, radiusY, AA); }
+	inline void FillEllipse(const RGBA& color, int centreX, int centreY, int radiusX, int radiusY, bool AA = false) { FillEllipse(color, Point{centreX, centreY}, radiusX, radiusY, AA); }
+	inline void FillEllipse(RGBA (*shader)(const Renderer& renderer, int x, int y), int centreX, int centreY, int radiusX, int radiusY, bool AA = false) { FillEllipse(shader, Point{centreX, centreY}, radiusX, radiusY, AA); }
 	inline void DrawTriangle(const RGBA& color, int x1, int y1, int x2, int y2, int x3, int y3, bool AA = false, bool GC = false) { DrawTriangle(color, Point{x1, y1}, Point{x2, y2}, Point{x3, y3}, AA, GC ); }
-	inline void DrawTriangle(const Bitmap& texture, float tx1, float ty1, float tx2, float ty2, float tx3, float ty3, float x1, float y1, float x2, float y2, float x3, float y3) { DrawTriangle(texture, FPoint{tx1, ty1}, FPoint{tx2, ty2}, FPoint{tx3, ty3}, FPoint{x1, y1}, FPoint{x2, y2}, FPoint{x3, y3}); }
-	inline void FillTriangle(const RGBA& color, int x1, int y1, int x2, int y2, int x3, int y3) { FillTriangle(color, Point{x1, y1}, Point{x2, y2}, Point{x3, y3} ); }
+	inline void DrawTriangle(const BitmapView& texture, float tx1, float ty1, float tx2, float ty2, float tx3, float ty3, float x1, float y1, float x2, float y2, float x3, float y3) { DrawTriangle(texture, FPoint{tx1, ty1}, FPoint{tx2, ty2}, FPoint{tx3, ty3}, FPoint{x1, y1}, FPoint{x2, y2}, FPoint{x3, y3}); }
+	inline void FillTriangle(const RGBA& color, int x1, int y1, int x2, int y2, int x3, int y3, bool AA = false) { FillTriangle(color, Point{x1, y1}, Point{x2, y2}, Point{x3, y3}, AA); }
 	inline void FillTriangle(RGBA color1, RGBA color2, RGBA color3, int x1, int y1, int x2, int y2, int x3, int y3) { FillTriangle(color1, color2, color3, Point{x1, y1}, Point{x2, y2}, Point{x3, y3}); }
 	inline void FillTriangle(RGBA (*shader)(const Renderer& renderer, int x, int y), int x1, int y1, int x2, int y2, int x3, int y3) { FillTriangle(shader, Point{x1, y1}, Point{x2, y2}, Point{x3, y3} ); }
-	inline void DrawBitmap(const Bitmap& bitmap, FPoint destLocation, int destWidth, int destHeight, FPoint srcLocation, int srcWidth, int srcHeight) { DrawBitmap(bitmap, destLocation.x, destLocation.y, destWidth, destHeight, srcLocation.x, srcLocation.y, srcWidth, srcHeight); }
+	inline void FillPolygon(const RGBA& color, const std::vector<FPoint>& points, bool AA = false) { FillPolygon(color, points.data(), static_cast<int>(points.size()), AA); }
+	inline void FillRoundedRectangle(const RGBA& color, int x, int y, int width, int height, int radius, bool AA = false) { FillRoundedRectangle(color, Rectangle{x, y, width, height}, radius, AA); }
+	inline void DrawBitmap(const BitmapView& bitmap, FPoint destLocation, int destWidth, int destHeight, FPoint srcLocation, int srcWidth, int srcHeight) { DrawBitmap(bitmap, destLocation.x, destLocation.y, destWidth, destHeight, srcLocation.x, srcLocation.y, srcWidth, srcHeight); }
+	inline void DrawBitmap(const MonochromeBitmap& bitmap, const Point& p) { DrawBitmap(bitmap, p.x, p.y); }
+	inline void DrawBitmap(const RGB24Bitmap& bitmap, const Point& p) { DrawBitmap(bitmap, p.x, p.y); }
+	inline void DrawBitmap(const MaskBitmap& mask, const RGBA& color, const Point& p) { DrawBitmap(mask, color, p.x, p.y); }
+	inline void DrawBitmap(const MonochromeBitmap& mask, const RGBA& color, const Point& p) { DrawBitmap(mask, color, p.x, p.y); }
 	inline void DrawGlyph(uint8_t glyph, int x, int y) { DrawGlyph(glyph, x, y, textStyle); }
 	inline void DrawText(const std::string_view text) { DrawText(text, textStyle); };
 	inline void DrawText(const std::string_view text, int x, int y) { DrawText(text, x, y, textStyle); };
@@ -84,10 +140,14 @@ public:
 	inline void FillRectangle(uint32_t color, Rectangle rectangle) { FillRectangle(RGBA{color}, rectangle); }
 	inline void DrawCircle(uint32_t color, const Point& centreLocation, int radius, bool AA = false) { DrawCircle(RGBA{color}, centreLocation, radius, AA); }
 	inline void FillCircle(uint32_t color, const Point& centreLocation, int radius, bool AA = false) { FillCircle(RGBA{color}, centreLocation, radius, AA); }
+	inline void DrawEllipse(uint32_t color, const Point& centreLocation, int radiusX, int radiusY, bool AA = false) { DrawEllipse(RGBA{color}, centreLocation, radiusX, radiusY, AA); }
+	inline void FillEllipse(uint32_t color, const Point& centreLocation, int radiusX, int radiusY, bool AA = false) { FillEllipse(RGBA{color}, centreLocation, radiusX, radiusY, AA); }
 	inline void DrawTriangle(uint32_t color, const Point& p1, const Point& p2, const Point& p3, bool AA = false, bool GC = false) { DrawTriangle(RGBA{color}, p1, p2, p3, AA, GC ); }
-	inline void FillTriangle(uint32_t color, const Point& p1, Point p2, Point p3) { FillTriangle(RGBA{color}, p1, p2, p3 ); }
+	inline void FillTriangle(uint32_t color, const Point& p1, Point p2, Point p3, bool AA = false) { FillTriangle(RGBA{color}, p1, p2, p3, AA); }
 	inline void FillTriangle(uint32_t color1, uint32_t color2, uint32_t color3, Point p1, Point p2, Point p3) { FillTriangle(RGBA{color1}, RGBA{color2}, RGBA{color3}, p1, p2, p3); }
-	inline void DrawBitmap(const Bitmap& bitmap, FRectangle destRect, FRectangle srcRect) { DrawBitmap(bitmap, destRect.x, destRect.y, destRect.width, destRect.height, srcRect.x, srcRect.y, srcRect.width, srcRect.height); }
+	inline void FillPolygon(uint32_t color, const FPoint* points, int count, bool AA = false) { FillPolygon(RGBA{color}, points, count, AA); }
+	inline void FillRoundedRectangle(uint32_t color, Rectangle rectangle, int radius, bool AA = false) { FillRoundedRectangle(RGBA{color}, rectangle, radius, AA); }
+	inline void DrawBitmap(const BitmapView& bitmap, FRectangle destRect, FRectangle srcRect) { DrawBitmap(bitmap, destRect.x, destRect.y, destRect.width, destRect.height, srcRect.x, srcRect.y, srcRect.width, srcRect.height); }
 	inline void DrawGlyph(uint8_t glyph, Point p, const TextStyle& ts) { DrawGlyph(glyph, p.x, p.y, ts); };
 
 	inline void DrawPixel(uint32_t color, int x, int y);
@@ -96,11 +156,43 @@ public:
 	inline void FillRectangle(uint32_t color, int x, int y, int width, int height) { FillRectangle(RGBA{color}, Rectangle{x, y, width, height}); }
 	inline void DrawCircle(uint32_t color, int centreX, int centreY, int radius, bool AA = false) { DrawCircle(RGBA{color}, Point{centreX,centreY}, radius, AA); }
 	inline void FillCircle(uint32_t color, int centreX, int centreY, int radius, bool AA = false) { FillCircle(RGBA{color}, Point{centreX,centreY}, radius, AA); }
+	inline void DrawEllipse(uint32_t color, int centreX, int centreY, int radiusX, int radiusY, bool AA = false) { DrawEllipse(RGBA{color}, Point{centreX, centreY}, radiusX, radiusY, AA); }
+	inline void FillEllipse(uint32_t color, int centreX, int centreY, int radiusX, int radiusY, bool AA = false) { FillEllipse(RGBA{color}, Point{centreX, centreY}, radiusX, radiusY, AA); }
 	inline void DrawTriangle(uint32_t color, int x1, int y1, int x2, int y2, int x3, int y3, bool AA = false, bool GC = false) { DrawTriangle(RGBA{color}, Point{x1, y1}, Point{x2, y2}, Point{x3, y3}, AA, GC ); }
-	inline void FillTriangle(uint32_t color, int x1, int y1, int x2, int y2, int x3, int y3) { FillTriangle(RGBA{color}, Point{x1, y1}, Point{x2, y2}, Point{x3, y3} ); }
+	inline void FillTriangle(uint32_t color, int x1, int y1, int x2, int y2, int x3, int y3, bool AA = false) { FillTriangle(RGBA{color}, Point{x1, y1}, Point{x2, y2}, Point{x3, y3}, AA); }
 	inline void FillTriangle(uint32_t color1, uint32_t color2, uint32_t color3, int x1, int y1, int x2, int y2, int x3, int y3) { FillTriangle(RGBA{color1}, RGBA{color2}, RGBA{color3}, Point{x1, y1}, Point{x2, y2}, Point{x3, y3}); }
+	inline void FillRoundedRectangle(uint32_t color, int x, int y, int width, int height, int radius, bool AA = false) { FillRoundedRectangle(RGBA{color}, Rectangle{x, y, width, height}, radius, AA); }
 	inline void DrawGlyph(uint8_t glyph, Point p) { DrawGlyph(glyph, p.x, p.y, textStyle); };
 	
+	/* SHADER OVERLOADS */
+	// NOTE: the callable is called directly (and can be inlined), the renderer only makes one indirect call per row.
+	// The shaded pixels are drawn with the same rules as DrawPixel (blended with alpha blending) for every shape
+	template <typename Shader, std::enable_if_t<isPixelShader<Shader>, int> = 0>
+	inline void FillRectangle(const Shader& shader, Rectangle rectangle) { fillRectangle(&shadePixels<Shader>, &shader, rectangle); }
+	template <typename Shader, std::enable_if_t<isSpanShader<Shader>, int> = 0>
+	inline void FillRectangle(const Shader& shader, Rectangle rectangle) { fillRectangle(&shadeSpan<Shader>, &shader, rectangle); }
+	template <typename Shader, std::enable_if_t<isPixelShader<Shader>, int> = 0>
+	inline void FillCircle(const Shader& shader, const Point& centreLocation, int radius, bool AA = false) { fillEllipse(&shadePixels<Shader>, &shader, centreLocation, radius, radius, AA); }
+	template <typename Shader, std::enable_if_t<isSpanShader<Shader>, int> = 0>
+	inline void FillCircle(const Shader& shader, const Point& centreLocation, int radius, bool AA = false) { fillEllipse(&shadeSpan<Shader>, &shader, centreLocation, radius, radius, AA); }
+	template <typename Shader, std::enable_if_t<isPixelShader<Shader>, int> = 0>
+	inline void FillEllipse(const Shader& shader, const Point& centreLocation, int radiusX, int radiusY, bool AA = false) { fillEllipse(&shadePixels<Shader>, &shader, centreLocation, radiusX, radiusY, AA); }
+	template <typename Shader, std::enable_if_t<isSpanShader<Shader>, int> = 0>
+	inline void FillEllipse(const Shader& shader, const Point& centreLocation, int radiusX, int radiusY, bool AA = false) { fillEllipse(&shadeSpan<Shader>, &shader, centreLocation, radiusX, radiusY, AA); }
+	template <typename Shader, std::enable_if_t<isPixelShader<Shader>, int> = 0>
+	inline void FillTriangle(const Shader& shader, Point p1, Point p2, Point p3) { fillTriangle(&shadePixels<Shader>, &shader, p1, p2, p3); }
+	template <typename Shader, std::enable_if_t<isSpanShader<Shader>, int> = 0>
+	inline void FillTriangle(const Shader& shader, Point p1, Point p2, Point p3) { fillTriangle(&shadeSpan<Shader>, &shader, p1, p2, p3); }
+	
+	template <typename Shader, std::enable_if_t<isPixelShader<Shader> || isSpanShader<Shader>, int> = 0>
+	inline void FillRectangle(const Shader& shader, int x, int y, int width, int height) { FillRectangle(shader, Rectangle{x, y, width, height}); }
+	template <typename Shader, std::enable_if_t<isPixelShader<Shader> || isSpanShader<Shader>, int> = 0>
+	inline void FillCircle(const Shader& shader, int centreX, int centreY, int radius, bool AA = false) { FillCircle(shader, Point{centreX, centreY}, radius, AA); }
+	template <typename Shader, std::enable_if_t<isPixelShader<Shader> || isSpanShader<Shader>, int> = 0>
+	inline void FillEllipse(const Shader& shader, int centreX, int centreY, int radiusX, int radiusY, bool AA = false) { FillEllipse(shader, Point{centreX, centreY}, radiusX, radiusY, AA); }
+	template <typename Shader, std::enable_if_t<isPixelShader<Shader> || isSpanShader<Shader>, int> = 0>
+	inline void FillTriangle(const Shader& shader, int x1, int y1, int x2, int y2, int x3, int y3) { FillTriangle(shader, Point{x1, y1}, Point{x2, y2}, Point{x3, y3}); }
+	
 	/* GETTERS */
 	inline uint32_t* GetData() const {
 		return pixels;
@@ -111,6 +203,10 @@ public:
 	inline int GetHeight() const {
 		return height;
 	}
+	// pixels from the start of one row to the start of the next one
+	inline int GetStride() const {
+		return stride;
+	}
 	inline cdr::RGBA GetPixel(const Point& p) const {
 		if(p.x < 0 || p.y < 0 || p.x >= GetWidth() || p.y >= GetHeight()) return cdr::RGBA{};
 		return cdr::RGBA{pixels[getIndex(p)]};
@@ -119,10 +215,24 @@ public:
 		if(x < 0 || y < 0 || x >= GetWidth() || y >= GetHeight()) return cdr::RGBA{};
 		return cdr::RGBA{pixels[getIndex(x, y)]};
 	}
+	// NOTE: scratch memory used by the shader fills, call Reset on it once per frame.
+	// Shaders and other code drawing into this renderer can allocate from it as well
+	inline FrameArena& GetFrameArena() {
+		return frameArena;
+	}
 	inline uint32_t GetPixelRaw(int x, int y) const {
 		if(x < 0 || y < 0 || x >= GetWidth() || y >= GetHeight()) return -1; // NOTE: returning -1 on unsinged return type so value will be 0xffffff
 		return pixels[getIndex(x, y)];
 	}
+	// NOTE: everything counted since the last ResetStats, always 0 unless compiled with CIDR_STATS and EnableStats was called
+	inline const RenderStats& GetStats() const {
+		return stats;
+	}
+	// NOTE: the rectangles drawn to since the last ResetDamage, empty unless EnableDamageTracking was called.
+	// Every primitive adds its bounds (intersected with the clip), so the region can be a bit larger than the changed pixels
+	inline const DamageRegion& GetDamage() const {
+		return damage;
+	}
 	
 	/* SETTERS */
 	inline void SetTextStyle(const TextStyle& ts) { textStyle = ts; }
@@ -135,34 +245,137 @@ public:
 	inline void SetTextShadowColor(const RGBA& color) { textStyle.shadowColor = color; }
 	inline void SetTextShadowOffsetX(int offset) { textStyle.shadowOffsetX = offset; }
 	inline void SetTextShadowOffsetY(int offset) { textStyle.shadowOffsetY = offset; }
+	// NOTE: the cache has to outlive the renderer, by default every renderer shares GlyphCache::Default()
+	inline void SetGlyphCache(GlyphCache& cache) { glyphCache = &cache; }
 	
 	/* Toggles */
 	inline void EnableAlphaBlending() { useAlphaBlending = true; }
-	inline void DisableAlphaBlending() { useAlphaBlending = true; }
+	inline void DisableAlphaBlending() { useAlphaBlending = false; }
+	// NOTE: blends, anti aliased edges and bilinear/trilinear samples are mixed in linear light
+	// (the canvas is treated as sRGB), costs a few table lookups per pixel
+	inline void EnableLinearLight() { useLinearLight = true; }
+	inline void DisableLinearLight() { useLinearLight = false; }
+	// NOTE: the canvas holds premultiplied pixels, blending costs one multiply per channel and keeps the alpha
+	// of the canvas (source over) instead of making it opaque. Colors, shader results and straight bitmaps are
+	// premultiplied when they are drawn, GetPixel returns the premultiplied pixel. Linear light is not used then
+	inline void EnablePremultipliedAlpha() { usePremultipliedAlpha = true; }
+	inline void DisablePremultipliedAlpha() { usePremultipliedAlpha = false; }
+	// NOTE: collecting stats needs the library to be compiled with CIDR_STATS, otherwise these do nothing
+	inline void EnableStats() { collectStats = true; }
+	inline void DisableStats() { collectStats = false; }
+	inline void ResetStats() { stats.Reset(); }
+	inline void EnableDamageTracking() { trackDamage = true; }
+	inline void DisableDamageTracking() { trackDamage = false; }
+	inline void ResetDamage() { damage.Reset(); }
+	// NOTE: for code that writes into GetData() itself (like the filters), adds the part of the rectangle inside of the clip
+	inline void AddDamage(const Rectangle& rectangle) { addDamage(rectangle); }
 	
 private:
 	uint32_t* pixels {nullptr};
 	int width {0};
 	int height {0};
-	bool useAlphaBlending;
+	int stride {0};
+	bool useAlphaBlending {false};
+	bool useLinearLight {false};
+	bool usePremultipliedAlpha {false};
 	// NOTE: text rendering related member variables
 	int globalX;
 	int globalY;
 	TextStyle textStyle {DefaultTextStyle};
+	// NOTE: copies of the renderer get their own empty arena
+	FrameArena frameArena {};
+	GlyphCache* glyphCache {&GlyphCache::Default()};
+	bool collectStats {false};
+	RenderStats stats {};
+	// NOTE: how many primitives are being drawn right now, primitives drawn by other primitives aren't counted
+	int statsDepth {0};
+	bool trackDamage {false};
+	DamageRegion damage {};
 	
 private:
+	// counts the call and measures the time of the primitive it was created in
+	class StatsScope;
+	// takes the canvas and every setting of the other renderer, but keeps its own arena, clip stack, damage and stats
+	// so the command list can reuse a renderer every frame without touching the heap
+	void copySettings(const Renderer& other);
 	/* UTILITY FUNCTIONS */
 	inline int getIndex(const Point& p) const {
-		return p.x + p.y * width;
+		return p.x + p.y * stride;
 	}
 	inline int getIndex(int x, int y) const {
-		return x + y * width;
+		return x + y * stride;
+	}
+	// adds the part of the rectangle inside of the clip to the damage region
+	inline void addDamage(const Rectangle& rectangle) {
+		if (!trackDamage) return;
+		damage.Add(clipRectangle(rectangle));
 	}
+	// same for the box from min to max (inclusive) grown by padding on every side
+	inline void addDamage(float minX, float minY, float maxX, float maxY, int padding) {
+		if (!trackDamage) return;
+		int left {static_cast<int>(std::floor(std::max(minX, -1e9f))) - padding};
+		int top {static_cast<int>(std::floor(std::max(minY, -1e9f))) - padding};
+		int right {static_cast<int>(std::ceil(std::min(maxX, 1e9f))) + padding};
+		int bottom {static_cast<int>(std::ceil(std::min(maxY, 1e9f))) + padding};
+		addDamage(Rectangle{left, top, right - left + 1, bottom - top + 1});
+	}
+	// shades the pixels x0 <= x < x1 of row y into out
+	using SpanShadeFunction = void (*)(const void* shader, const Renderer& renderer, int x0, int x1, int y, uint32_t* out);
+	template <typename Shader>
+	static void shadePixels(const void* shader, const Renderer& renderer, int x0, int x1, int y, uint32_t* out) {
+		const Shader& pixelShader = *static_cast<const Shader*>(shader);
+		for (int x = x0; x < x1; x++) {
+			out[x - x0] = shaderResultToUINT(pixelShader(renderer, x, y));
+		}
+	}
+	template <typename Shader>
+	static void shadeSpan(const void* shader, const Renderer& renderer, int x0, int x1, int y, uint32_t* out) {
+		(*static_cast<const Shader*>(shader))(renderer, x0, x1, y, out);
+	}
+	static inline uint32_t shaderResultToUINT(const RGBA& color) { return RGBtoUINT(color); }
+	static inline uint32_t shaderResultToUINT(uint32_t color) { return color; }
+	void fillRectangle(SpanShadeFunction shade, const void* shader, Rectangle rectangle);
+	void fillEllipse(SpanShadeFunction shade, const void* shader, const Point& centreLocation, int radiusX, int radiusY, bool AA);
+	void fillTriangle(SpanShadeFunction shade, const void* shader, Point p1, Point p2, Point p3);
+	// FillPolygon without counting it, the anti aliased triangles are drawn with it
+	void fillPolygon(uint32_t color, const FPoint* points, int count, bool AA);
+	// draws the shape accumulated by the coverage rasterizer
+	void fillCoverage(const CoverageRasterizer& shape, uint32_t color, bool AA);
+	// same as DrawPixel, for pixels that are known to be inside of the clip
+	void drawPixelUnclipped(uint32_t color, int x, int y);
+	// same as drawPixelUnclipped for a color that already is in the alpha mode of the canvas
+	void writePixelUnclipped(uint32_t color, int x, int y);
+	// draws a texel of the bitmap, converted to the alpha mode of the canvas if they differ
+	void drawTexelUnclipped(const BitmapView& bitmap, uint32_t texel, int x, int y);
+	// the color converted to the alpha mode of the canvas
+	uint32_t toCanvas(uint32_t color) const;
+	// ClampToBorderColor in the alpha mode of the bitmap
+	uint32_t getBorderColor(const BitmapView& bitmap) const;
+	// the blend picked by EnableLinearLight/DisableLinearLight
+	uint32_t blendPixel(uint32_t dst, uint32_t src) const;
+	void blendSpan(uint32_t* dst, int count, uint32_t color) const;
+	void blendSpan(uint32_t* dst, const uint32_t* colors, int count) const;
+	// blends count pixels inside of the clip with the alpha of the color scaled by their coverage (0 - 255), e.g. anti aliased edges
+	void drawCoverageSpan(uint32_t color, const uint8_t* coverage, int x, int y, int count);
+	// same with one shaded color per pixel
+	void drawCoverageSpan(const uint32_t* colors, const uint8_t* coverage, int x, int y, int count);
+	// draws count colors starting at x, y with the same rules as DrawPixel
+	void drawSpan(const uint32_t* colors, int x, int y, int count);
+	// the part of drawSpan after clipping, colors already are in the alpha mode of the canvas
+	void writeSpan(const uint32_t* colors, uint32_t* dst, int count);
 	void drawScanLine(uint32_t color, int startX, int endX, int y);
-	void drawScanLine(const RGBA& color1, const RGBA& color2, int startX, int endX, int y);
+	// the unscaled rows of a bitmap in another format, converted to RGBA in chunks
+	template <typename Format>
+	void drawFormatBitmap(const FormatBitmap<Format>& bitmap, int x, int y);
+	// blends color with the alpha scaled by a coverage mask of width * height bytes, with its top left corner at x, y
+	void drawCoverageMask(const uint8_t* coverage, int maskWidth, int maskHeight, uint32_t color, int x, int y);
+	void drawGlyphMask(const GlyphCache::Glyph& glyph, float x, int y, const TextStyle& ts, bool textRules);
 	bool clampCoords(float& x, float& y, int width, int height) const;
-	RGBA sampleTexture(const cdr::Bitmap& b, float x, float y) const;
-	uint32_t sampleTextureRaw(const cdr::Bitmap& b, float x, float y) const;
+	RGBA sampleTexture(const BitmapView& b, float x, float y) const;
+	// NOTE: lod is log2 of how many texels of level 0 one pixel covers
+	RGBA sampleTexture(const BitmapView& b, float x, float y, float lod) const;
+	static RGBA sampleBilinear(const uint32_t* data, int width, int height, int stride, float x, float y, bool linear);
+	uint32_t sampleTextureRaw(const BitmapView& b, float x, float y) const;
 	bool clampCoords(int& x, int& y, int width, int height) const;
 };
 
@@ -187,20 +400,6 @@ inline RGB alphaBlendColor(uint32_t color1, uint32_t color2, float alpha) {
 		static_cast<uint8_t>(getB(color2) * (alpha / 255.f) + getB(color1) * (1 - alpha / 255.f))
 	};
 }
-inline RGB alphaBlendColorGammaCorrected(const cdr::RGB& color1, const cdr::RGB& color2, float alpha, float gamma = 2.2) {
-	return cdr::RGB { 
-		static_cast<uint8_t>(std::pow(std::pow(color2.r, gamma) * (alpha / 255.f) + std::pow(color1.r, gamma) * (1 - alpha / 255.f), 1.f / gamma)),
-		static_cast<uint8_t>(std::pow(std::pow(color2.g, gamma) * (alpha / 255.f) + std::pow(color1.g, gamma) * (1 - alpha / 255.f), 1.f / gamma)),
-		static_cast<uint8_t>(std::pow(std::pow(color2.b, gamma) * (alpha / 255.f) + std::pow(color1.b, gamma) * (1 - alpha / 255.f), 1.f / gamma))
-	};
-}
-inline RGB alphaBlendColorGammaCorrected(uint32_t color1, uint32_t color2, float alpha, float gamma = 2.2) {
-	return cdr::RGB { 
-		static_cast<uint8_t>(std::pow(std::pow(getR(color2), gamma) * (alpha / 255.f) + std::pow(getR(color1), gamma) * (1 - alpha / 255.f), 1.f / gamma)),
-		static_cast<uint8_t>(std::pow(std::pow(getG(color2), gamma) * (alpha / 255.f) + std::pow(getG(color1), gamma) * (1 - alpha / 255.f), 1.f / gamma)),
-		static_cast<uint8_t>(std::pow(std::pow(getB(color2), gamma) * (alpha / 255.f) + std::pow(getB(color1), gamma) * (1 - alpha / 255.f), 1.f / gamma))
-	};
-}
 // uses color2's alpha value
 inline RGBA alphaBlendColor(const cdr::RGBA& color1, const cdr::RGBA& color2) {
 	return cdr::RGBA {
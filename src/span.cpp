@@ -0,0 +1,559 @@
+/********************************
+ * Project: Cidr				*
+ * File: span.cpp				*
+ * Date: 17.10.2026				*
+ ********************************/
+
+#include "span.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CIDR_SPAN_X86
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define CIDR_SPAN_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+using BlendColorKernel = void (*)(uint32_t* dst, int count, uint32_t color);
+using BlendSpanKernel = void (*)(uint32_t* dst, const uint32_t* src, int count);
+using PackBytesKernel = void (*)(uint32_t* dst, const uint8_t* src, int count);
+
+struct SpanKernels {
+	BlendColorKernel blendColor;
+	BlendSpanKernel blendSpan;
+	BlendColorKernel blendColorLinear;
+	BlendSpanKernel blendSpanLinear;
+	BlendColorKernel blendColorPremultiplied;
+	BlendSpanKernel blendSpanPremultiplied;
+	PackBytesKernel packRGBA;
+	PackBytesKernel packRGB;
+	const char* name;
+};
+
+/* SCALAR */
+
+void blendColorScalar(uint32_t* dst, int count, uint32_t color) {
+	for (int i = 0; i < count; i++) {
+		dst[i] = cdr::BlendPixel(dst[i], color);
+	}
+}
+void blendSpanScalar(uint32_t* dst, const uint32_t* src, int count) {
+	for (int i = 0; i < count; i++) {
+		dst[i] = cdr::BlendPixel(dst[i], src[i]);
+	}
+}
+void blendColorLinearScalar(uint32_t* dst, int count, uint32_t color) {
+	for (int i = 0; i < count; i++) {
+		dst[i] = cdr::BlendPixelLinear(dst[i], color);
+	}
+}
+void blendSpanLinearScalar(uint32_t* dst, const uint32_t* src, int count) {
+	for (int i = 0; i < count; i++) {
+		dst[i] = cdr::BlendPixelLinear(dst[i], src[i]);
+	}
+}
+void blendColorPremultipliedScalar(uint32_t* dst, int count, uint32_t color) {
+	for (int i = 0; i < count; i++) {
+		dst[i] = cdr::BlendPixelPremultiplied(dst[i], color);
+	}
+}
+void blendSpanPremultipliedScalar(uint32_t* dst, const uint32_t* src, int count) {
+	for (int i = 0; i < count; i++) {
+		dst[i] = cdr::BlendPixelPremultiplied(dst[i], src[i]);
+	}
+}
+void packRGBAScalar(uint32_t* dst, const uint8_t* src, int count) {
+	for (int i = 0; i < count; i++, src += 4) {
+		dst[i] = uint32_t(src[0]) << 24 | uint32_t(src[1]) << 16 | uint32_t(src[2]) << 8 | src[3];
+	}
+}
+void packRGBScalar(uint32_t* dst, const uint8_t* src, int count) {
+	for (int i = 0; i < count; i++, src += 3) {
+		dst[i] = uint32_t(src[0]) << 24 | uint32_t(src[1]) << 16 | uint32_t(src[2]) << 8 | 0xff;
+	}
+}
+
+#ifdef CIDR_SPAN_X86
+// NOTE: pixels are unpacked to 16 bits per channel, in memory a pixel is A, B, G, R (little endian)
+// so the alpha of every pixel lands in lane 0 and 4 of the 8 lanes.
+// Every product fits into 16 bits because t <= 255 - srcA, so no wider math is needed
+
+/* SSE2 */
+
+__attribute__((target("sse2")))
+inline __m128i div255SSE2(__m128i x) {
+	x = _mm_add_epi16(x, _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+__attribute__((target("sse2")))
+inline __m128i broadcastAlphaSSE2(__m128i x) {
+	x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(0, 0, 0, 0));
+	return _mm_shufflehi_epi16(x, _MM_SHUFFLE(0, 0, 0, 0));
+}
+// blends two unpacked pixels, srcA holds the source alpha in every lane
+__attribute__((target("sse2")))
+inline __m128i blendSSE2(__m128i dst, __m128i src, __m128i srcA) {
+	__m128i t = div255SSE2(_mm_mullo_epi16(broadcastAlphaSSE2(dst), _mm_sub_epi16(_mm_set1_epi16(255), srcA)));
+	return div255SSE2(_mm_add_epi16(_mm_mullo_epi16(src, srcA), _mm_mullo_epi16(dst, t)));
+}
+
+// same for premultiplied pixels, the alpha lane is blended like the colors
+__attribute__((target("sse2")))
+inline __m128i blendPremultipliedSSE2(__m128i dst, __m128i src, __m128i srcA) {
+	return _mm_add_epi16(src, div255SSE2(_mm_mullo_epi16(dst, _mm_sub_epi16(_mm_set1_epi16(255), srcA))));
+}
+
+__attribute__((target("sse2")))
+void blendColorSSE2(uint32_t* dst, int count, uint32_t color) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i opaque = _mm_set1_epi32(0xff);
+	const __m128i src = _mm_unpacklo_epi8(_mm_set1_epi32(color), zero);
+	const __m128i srcA = broadcastAlphaSSE2(src);
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+		__m128i lo = blendSSE2(_mm_unpacklo_epi8(d, zero), src, srcA);
+		__m128i hi = blendSSE2(_mm_unpackhi_epi8(d, zero), src, srcA);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(_mm_packus_epi16(lo, hi), opaque));
+	}
+	blendColorScalar(dst + i, count - i, color);
+}
+__attribute__((target("sse2")))
+void blendSpanSSE2(uint32_t* dst, const uint32_t* src, int count) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i opaque = _mm_set1_epi32(0xff);
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+		__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		__m128i sLo = _mm_unpacklo_epi8(s, zero);
+		__m128i sHi = _mm_unpackhi_epi8(s, zero);
+		__m128i lo = blendSSE2(_mm_unpacklo_epi8(d, zero), sLo, broadcastAlphaSSE2(sLo));
+		__m128i hi = blendSSE2(_mm_unpackhi_epi8(d, zero), sHi, broadcastAlphaSSE2(sHi));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(_mm_packus_epi16(lo, hi), opaque));
+	}
+	blendSpanScalar(dst + i, src + i, count - i);
+}
+__attribute__((target("sse2")))
+void blendColorPremultipliedSSE2(uint32_t* dst, int count, uint32_t color) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i src = _mm_unpacklo_epi8(_mm_set1_epi32(color), zero);
+	const __m128i srcA = broadcastAlphaSSE2(src);
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+		__m128i lo = blendPremultipliedSSE2(_mm_unpacklo_epi8(d, zero), src, srcA);
+		__m128i hi = blendPremultipliedSSE2(_mm_unpackhi_epi8(d, zero), src, srcA);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+	}
+	blendColorPremultipliedScalar(dst + i, count - i, color);
+}
+__attribute__((target("sse2")))
+void blendSpanPremultipliedSSE2(uint32_t* dst, const uint32_t* src, int count) {
+	const __m128i zero = _mm_setzero_si128();
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+		__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		__m128i sLo = _mm_unpacklo_epi8(s, zero);
+		__m128i sHi = _mm_unpackhi_epi8(s, zero);
+		__m128i lo = blendPremultipliedSSE2(_mm_unpacklo_epi8(d, zero), sLo, broadcastAlphaSSE2(sLo));
+		__m128i hi = blendPremultipliedSSE2(_mm_unpackhi_epi8(d, zero), sHi, broadcastAlphaSSE2(sHi));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+	}
+	blendSpanPremultipliedScalar(dst + i, src + i, count - i);
+}
+
+/* SSE2 PACK */
+// NOTE: the bytes R, G, B, A of a pixel are the packed pixel with its bytes reversed
+
+__attribute__((target("sse2")))
+void packRGBASSE2(uint32_t* dst, const uint8_t* src, int count) {
+	const __m128i low = _mm_set1_epi16(0x00ff);
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+		// swap the bytes of every 16 bit half, then the halves
+		x = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(x, 8), low), _mm_slli_epi16(x, 8));
+		x = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), x);
+	}
+	packRGBAScalar(dst + i, src + i * 4, count - i);
+}
+
+/* AVX2 */
+// NOTE: unpack and pack work inside of the two 128 bit halves, so the pixel order is preserved
+
+__attribute__((target("avx2")))
+inline __m256i div255AVX2(__m256i x) {
+	x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+	return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+__attribute__((target("avx2")))
+inline __m256i broadcastAlphaAVX2(__m256i x) {
+	x = _mm256_shufflelo_epi16(x, _MM_SHUFFLE(0, 0, 0, 0));
+	return _mm256_shufflehi_epi16(x, _MM_SHUFFLE(0, 0, 0, 0));
+}
+__attribute__((target("avx2")))
+inline __m256i blendAVX2(__m256i dst, __m256i src, __m256i srcA) {
+	__m256i t = div255AVX2(_mm256_mullo_epi16(broadcastAlphaAVX2(dst), _mm256_sub_epi16(_mm256_set1_epi16(255), srcA)));
+	return div255AVX2(_mm256_add_epi16(_mm256_mullo_epi16(src, srcA), _mm256_mullo_epi16(dst, t)));
+}
+
+__attribute__((target("avx2")))
+inline __m256i blendPremultipliedAVX2(__m256i dst, __m256i src, __m256i srcA) {
+	return _mm256_add_epi16(src, div255AVX2(_mm256_mullo_epi16(dst, _mm256_sub_epi16(_mm256_set1_epi16(255), srcA))));
+}
+
+__attribute__((target("avx2")))
+void blendColorAVX2(uint32_t* dst, int count, uint32_t color) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i opaque = _mm256_set1_epi32(0xff);
+	const __m256i src = _mm256_unpacklo_epi8(_mm256_set1_epi32(color), zero);
+	const __m256i srcA = broadcastAlphaAVX2(src);
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+		__m256i lo = blendAVX2(_mm256_unpacklo_epi8(d, zero), src, srcA);
+		__m256i hi = blendAVX2(_mm256_unpackhi_epi8(d, zero), src, srcA);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_or_si256(_mm256_packus_epi16(lo, hi), opaque));
+	}
+	blendColorSSE2(dst + i, count - i, color);
+}
+__attribute__((target("avx2")))
+void blendSpanAVX2(uint32_t* dst, const uint32_t* src, int count) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i opaque = _mm256_set1_epi32(0xff);
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+		__m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+		__m256i sLo = _mm256_unpacklo_epi8(s, zero);
+		__m256i sHi = _mm256_unpackhi_epi8(s, zero);
+		__m256i lo = blendAVX2(_mm256_unpacklo_epi8(d, zero), sLo, broadcastAlphaAVX2(sLo));
+		__m256i hi = blendAVX2(_mm256_unpackhi_epi8(d, zero), sHi, broadcastAlphaAVX2(sHi));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_or_si256(_mm256_packus_epi16(lo, hi), opaque));
+	}
+	blendSpanSSE2(dst + i, src + i, count - i);
+}
+__attribute__((target("avx2")))
+void blendColorPremultipliedAVX2(uint32_t* dst, int count, uint32_t color) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i src = _mm256_unpacklo_epi8(_mm256_set1_epi32(color), zero);
+	const __m256i srcA = broadcastAlphaAVX2(src);
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+		__m256i lo = blendPremultipliedAVX2(_mm256_unpacklo_epi8(d, zero), src, srcA);
+		__m256i hi = blendPremultipliedAVX2(_mm256_unpackhi_epi8(d, zero), src, srcA);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(lo, hi));
+	}
+	blendColorPremultipliedSSE2(dst + i, count - i, color);
+}
+__attribute__((target("avx2")))
+void blendSpanPremultipliedAVX2(uint32_t* dst, const uint32_t* src, int count) {
+	const __m256i zero = _mm256_setzero_si256();
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+		__m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+		__m256i sLo = _mm256_unpacklo_epi8(s, zero);
+		__m256i sHi = _mm256_unpackhi_epi8(s, zero);
+		__m256i lo = blendPremultipliedAVX2(_mm256_unpacklo_epi8(d, zero), sLo, broadcastAlphaAVX2(sLo));
+		__m256i hi = blendPremultipliedAVX2(_mm256_unpackhi_epi8(d, zero), sHi, broadcastAlphaAVX2(sHi));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(lo, hi));
+	}
+	blendSpanPremultipliedSSE2(dst + i, src + i, count - i);
+}
+
+/* AVX2 PACK */
+
+__attribute__((target("avx2")))
+void packRGBAAVX2(uint32_t* dst, const uint8_t* src, int count) {
+	const __m256i reverse = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+		3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_shuffle_epi8(x, reverse));
+	}
+	packRGBAScalar(dst + i, src + i * 4, count - i);
+}
+// NOTE: 8 pixels are 24 bytes, the permute moves the second 12 into the upper half so the shuffle
+// (which can't cross halves) finds 4 pixels in each. 32 bytes are loaded, so the last pixels are scalar
+__attribute__((target("avx2")))
+void packRGBAVX2(uint32_t* dst, const uint8_t* src, int count) {
+	const __m256i spread = _mm256_setr_epi32(0, 1, 2, 0, 3, 4, 5, 0);
+	const __m256i reverse = _mm256_setr_epi8(-1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9,
+		-1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9);
+	const __m256i alpha = _mm256_set1_epi32(0xff);
+	int i = 0;
+	for (; i + 11 <= count; i += 8) {
+		__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 3));
+		x = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(x, spread), reverse);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_or_si256(x, alpha));
+	}
+	packRGBScalar(dst + i, src + i * 3, count - i);
+}
+
+/* AVX2 LINEAR */
+// NOTE: one pixel per 32 bit lane, the table lookups are gathers. The gathers read 4 bytes
+// at every index, the tables are padded for that and the unused bytes are masked away
+
+__attribute__((target("avx2")))
+inline __m256i scaleAlphaAVX2(__m256i x) {
+	x = _mm256_and_si256(x, _mm256_set1_epi32(0xff));
+	return _mm256_add_epi32(x, _mm256_srli_epi32(x, 7));
+}
+__attribute__((target("avx2")))
+inline __m256i toLinearAVX2(__m256i x, int shift, const cdr::SRGBTables& tables) {
+	__m256i index = _mm256_and_si256(_mm256_srli_epi32(x, shift), _mm256_set1_epi32(0xff));
+	__m256i linear = _mm256_i32gather_epi32(reinterpret_cast<const int*>(tables.toLinear), index, 2);
+	return _mm256_and_si256(linear, _mm256_set1_epi32(0xffff));
+}
+// blends 8 pixels, srcLinear holds the already decoded red, green and blue of the source
+__attribute__((target("avx2")))
+inline __m256i blendLinearAVX2(__m256i dst, const __m256i srcLinear[3], __m256i srcA, const cdr::SRGBTables& tables) {
+	__m256i t = _mm256_srli_epi32(_mm256_mullo_epi32(scaleAlphaAVX2(dst), _mm256_sub_epi32(_mm256_set1_epi32(256), srcA)), 8);
+	__m256i out = _mm256_set1_epi32(0xff);
+	for (int c = 0; c < 3; c++) {
+		int shift {24 - c * 8};
+		__m256i linear = _mm256_add_epi32(_mm256_mullo_epi32(srcLinear[c], srcA), _mm256_mullo_epi32(toLinearAVX2(dst, shift, tables), t));
+		__m256i index = _mm256_srli_epi32(linear, 12);
+		__m256i encoded = _mm256_i32gather_epi32(reinterpret_cast<const int*>(tables.toSRGB), index, 1);
+		out = _mm256_or_si256(out, _mm256_slli_epi32(_mm256_and_si256(encoded, _mm256_set1_epi32(0xff)), shift));
+	}
+	return out;
+}
+
+__attribute__((target("avx2")))
+void blendColorLinearAVX2(uint32_t* dst, int count, uint32_t color) {
+	const cdr::SRGBTables& tables {cdr::GetSRGBTables()};
+	const __m256i srcA = scaleAlphaAVX2(_mm256_set1_epi32(color));
+	const __m256i srcLinear[3] {
+		_mm256_set1_epi32(tables.toLinear[color >> 24]),
+		_mm256_set1_epi32(tables.toLinear[(color >> 16) & 0xff]),
+		_mm256_set1_epi32(tables.toLinear[(color >> 8) & 0xff]),
+	};
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), blendLinearAVX2(d, srcLinear, srcA, tables));
+	}
+	blendColorLinearScalar(dst + i, count - i, color);
+}
+__attribute__((target("avx2")))
+void blendSpanLinearAVX2(uint32_t* dst, const uint32_t* src, int count) {
+	const cdr::SRGBTables& tables {cdr::GetSRGBTables()};
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+		__m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+		const __m256i srcLinear[3] {toLinearAVX2(s, 24, tables), toLinearAVX2(s, 16, tables), toLinearAVX2(s, 8, tables)};
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), blendLinearAVX2(d, srcLinear, scaleAlphaAVX2(s), tables));
+	}
+	blendSpanLinearScalar(dst + i, src + i, count - i);
+}
+#endif
+
+#ifdef CIDR_SPAN_NEON
+/* NEON */
+// NOTE: vld4 splits 8 pixels into planes, plane 0 is the alpha (A, B, G, R in memory)
+
+inline uint8x8_t div255NEON(uint16x8_t x) {
+	x = vaddq_u16(x, vdupq_n_u16(128));
+	return vmovn_u16(vshrq_n_u16(vaddq_u16(x, vshrq_n_u16(x, 8)), 8));
+}
+inline uint8x8x4_t blendNEON(uint8x8x4_t d, uint8x8x4_t s) {
+	uint16x8_t sa = vmovl_u8(s.val[0]);
+	uint16x8_t t = vmovl_u8(div255NEON(vmulq_u16(vmovl_u8(d.val[0]), vsubq_u16(vdupq_n_u16(255), sa))));
+	uint8x8x4_t out;
+	out.val[0] = vdup_n_u8(0xff);
+	for (int c = 1; c < 4; c++) {
+		out.val[c] = div255NEON(vaddq_u16(vmulq_u16(vmovl_u8(s.val[c]), sa), vmulq_u16(vmovl_u8(d.val[c]), t)));
+	}
+	return out;
+}
+
+inline uint8x8x4_t blendPremultipliedNEON(uint8x8x4_t d, uint8x8x4_t s) {
+	uint16x8_t t = vsubq_u16(vdupq_n_u16(255), vmovl_u8(s.val[0]));
+	uint8x8x4_t out;
+	for (int c = 0; c < 4; c++) {
+		out.val[c] = vqmovn_u16(vaddq_u16(vmovl_u8(s.val[c]), vmovl_u8(div255NEON(vmulq_u16(vmovl_u8(d.val[c]), t)))));
+	}
+	return out;
+}
+
+void blendColorNEON(uint32_t* dst, int count, uint32_t color) {
+	uint8x8x4_t s;
+	s.val[0] = vdup_n_u8(color & 0xff);
+	s.val[1] = vdup_n_u8((color >> 8) & 0xff);
+	s.val[2] = vdup_n_u8((color >> 16) & 0xff);
+	s.val[3] = vdup_n_u8(color >> 24);
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		uint8_t* d = reinterpret_cast<uint8_t*>(dst + i);
+		vst4_u8(d, blendNEON(vld4_u8(d), s));
+	}
+	blendColorScalar(dst + i, count - i, color);
+}
+void blendSpanNEON(uint32_t* dst, const uint32_t* src, int count) {
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		uint8_t* d = reinterpret_cast<uint8_t*>(dst + i);
+		vst4_u8(d, blendNEON(vld4_u8(d), vld4_u8(reinterpret_cast<const uint8_t*>(src + i))));
+	}
+	blendSpanScalar(dst + i, src + i, count - i);
+}
+void blendColorPremultipliedNEON(uint32_t* dst, int count, uint32_t color) {
+	uint8x8x4_t s;
+	s.val[0] = vdup_n_u8(color & 0xff);
+	s.val[1] = vdup_n_u8((color >> 8) & 0xff);
+	s.val[2] = vdup_n_u8((color >> 16) & 0xff);
+	s.val[3] = vdup_n_u8(color >> 24);
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		uint8_t* d = reinterpret_cast<uint8_t*>(dst + i);
+		vst4_u8(d, blendPremultipliedNEON(vld4_u8(d), s));
+	}
+	blendColorPremultipliedScalar(dst + i, count - i, color);
+}
+void blendSpanPremultipliedNEON(uint32_t* dst, const uint32_t* src, int count) {
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		uint8_t* d = reinterpret_cast<uint8_t*>(dst + i);
+		vst4_u8(d, blendPremultipliedNEON(vld4_u8(d), vld4_u8(reinterpret_cast<const uint8_t*>(src + i))));
+	}
+	blendSpanPremultipliedScalar(dst + i, src + i, count - i);
+}
+void packRGBANEON(uint32_t* dst, const uint8_t* src, int count) {
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		uint8x8x4_t s = vld4_u8(src + i * 4);
+		uint8x8x4_t out;
+		out.val[0] = s.val[3];
+		out.val[1] = s.val[2];
+		out.val[2] = s.val[1];
+		out.val[3] = s.val[0];
+		vst4_u8(reinterpret_cast<uint8_t*>(dst + i), out);
+	}
+	packRGBAScalar(dst + i, src + i * 4, count - i);
+}
+void packRGBNEON(uint32_t* dst, const uint8_t* src, int count) {
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		uint8x8x3_t s = vld3_u8(src + i * 3);
+		uint8x8x4_t out;
+		out.val[0] = vdup_n_u8(0xff);
+		out.val[1] = s.val[2];
+		out.val[2] = s.val[1];
+		out.val[3] = s.val[0];
+		vst4_u8(reinterpret_cast<uint8_t*>(dst + i), out);
+	}
+	packRGBScalar(dst + i, src + i * 3, count - i);
+}
+#endif
+
+SpanKernels selectKernels() {
+#ifdef CIDR_SPAN_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		return SpanKernels{blendColorAVX2, blendSpanAVX2, blendColorLinearAVX2, blendSpanLinearAVX2,
+			blendColorPremultipliedAVX2, blendSpanPremultipliedAVX2, packRGBAAVX2, packRGBAVX2, "avx2"};
+	}
+	// NOTE: SSE2 and NEON have no gathers, the table lookups of the linear kernels stay scalar
+	if (__builtin_cpu_supports("sse2")) {
+		return SpanKernels{blendColorSSE2, blendSpanSSE2, blendColorLinearScalar, blendSpanLinearScalar,
+			blendColorPremultipliedSSE2, blendSpanPremultipliedSSE2, packRGBASSE2, packRGBScalar, "sse2"};
+	}
+#elif defined(CIDR_SPAN_NEON)
+	return SpanKernels{blendColorNEON, blendSpanNEON, blendColorLinearScalar, blendSpanLinearScalar,
+		blendColorPremultipliedNEON, blendSpanPremultipliedNEON, packRGBANEON, packRGBNEON, "neon"};
+#endif
+	return SpanKernels{blendColorScalar, blendSpanScalar, blendColorLinearScalar, blendSpanLinearScalar,
+		blendColorPremultipliedScalar, blendSpanPremultipliedScalar, packRGBAScalar, packRGBScalar, "scalar"};
+}
+
+const SpanKernels& kernels() {
+	static const SpanKernels selected {selectKernels()};
+	return selected;
+}
+
+}
+
+void cdr::BlendSpan(uint32_t* dst, int count, uint32_t color) {
+	if (count <= 0) return;
+	// NOTE: an opaque source replaces the destination completely
+	if ((color & 0xff) == 0xff) {
+		std::fill_n(dst, count, color);
+		return;
+	}
+	kernels().blendColor(dst, count, color);
+}
+void cdr::BlendSpan(uint32_t* dst, const uint32_t* src, int count) {
+	if (count <= 0) return;
+	kernels().blendSpan(dst, src, count);
+}
+
+void cdr::BlendSpanLinear(uint32_t* dst, int count, uint32_t color) {
+	if (count <= 0) return;
+	if ((color & 0xff) == 0xff) {
+		std::fill_n(dst, count, color);
+		return;
+	}
+	kernels().blendColorLinear(dst, count, color);
+}
+void cdr::BlendSpanLinear(uint32_t* dst, const uint32_t* src, int count) {
+	if (count <= 0) return;
+	kernels().blendSpanLinear(dst, src, count);
+}
+
+void cdr::BlendSpanPremultiplied(uint32_t* dst, int count, uint32_t color) {
+	if (count <= 0) return;
+	if ((color & 0xff) == 0xff) {
+		std::fill_n(dst, count, color);
+		return;
+	}
+	// NOTE: a premultiplied pixel with an alpha of 0 adds nothing
+	if (color == 0) return;
+	kernels().blendColorPremultiplied(dst, count, color);
+}
+void cdr::BlendSpanPremultiplied(uint32_t* dst, const uint32_t* src, int count) {
+	if (count <= 0) return;
+	kernels().blendSpanPremultiplied(dst, src, count);
+}
+
+void cdr::PremultiplySpan(uint32_t* dst, const uint32_t* src, int count) {
+	for (int i = 0; i < count; i++) {
+		dst[i] = PremultiplyPixel(src[i]);
+	}
+}
+void cdr::UnpremultiplySpan(uint32_t* dst, const uint32_t* src, int count) {
+	for (int i = 0; i < count; i++) {
+		dst[i] = UnpremultiplyPixel(src[i]);
+	}
+}
+
+void cdr::PackBytesSpan(uint32_t* dst, const uint8_t* src, int count, int components) {
+	if (count <= 0) return;
+	switch (components) {
+		case 4: kernels().packRGBA(dst, src, count); break;
+		case 3: kernels().packRGB(dst, src, count); break;
+		case 2:
+			for (int i = 0; i < count; i++, src += 2) {
+				dst[i] = src[0] * 0x01010100u | src[1];
+			}
+			break;
+		default:
+			for (int i = 0; i < count; i++, src++) {
+				dst[i] = src[0] * 0x01010100u | 0xff;
+			}
+			break;
+	}
+}
+
+const char* cdr::GetSpanBackendName() {
+	return kernels().name;
+}
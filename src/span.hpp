@@ -0,0 +1,112 @@
+/********************************
+ * Project: Cidr				*
+ * File: span.hpp				*
+ * Date: 17.10.2026				*
+ ********************************/
+
+#ifndef CIDR_SPAN_HPP
+#define CIDR_SPAN_HPP
+
+#include <cstdint>
+#include <algorithm>
+#include "srgb.hpp"
+
+// NOTE: Row kernels used by the renderer for everything that writes horizontal runs of pixels.
+// Blending is source over with integer fixed point math, the source alpha is used as coverage
+// and the result is always opaque (same as alphaBlendColor(uint32_t, uint32_t)):
+//   out = src * srcA + dst * dstA * (1 - srcA)
+// The *Linear variants blend in linear light, see BlendPixelLinear.
+// The *Premultiplied variants expect premultiplied pixels on both sides, see BlendPixelPremultiplied.
+// The SSE2/AVX2 versions are picked at runtime depending on the cpu, NEON is used when compiled for it.
+namespace cdr {
+
+// x / 255 rounded, exact for every x in [0, 65535]
+inline uint32_t div255(uint32_t x) {
+	x += 128;
+	return (x + (x >> 8)) >> 8;
+}
+
+// blends a single pixel, the reference for all span kernels
+inline uint32_t BlendPixel(uint32_t dst, uint32_t src) {
+	uint32_t sa = src & 0xff;
+	uint32_t t = div255((dst & 0xff) * (255 - sa));
+	uint32_t r = div255((src >> 24) * sa + (dst >> 24) * t);
+	uint32_t g = div255(((src >> 16) & 0xff) * sa + ((dst >> 16) & 0xff) * t);
+	uint32_t b = div255(((src >> 8) & 0xff) * sa + ((dst >> 8) & 0xff) * t);
+	return (r << 24) | (g << 16) | (b << 8) | 0xff;
+}
+
+// same as BlendPixel but in linear light: the colors are decoded from sRGB, blended and encoded again.
+// The alphas are scaled to 0 - 256 so every division is a shift, which keeps the AVX2 gather
+// kernel bit exact with this one
+inline uint32_t BlendPixelLinear(uint32_t dst, uint32_t src) {
+	const SRGBTables& tables {GetSRGBTables()};
+	uint32_t sa = src & 0xff;
+	sa += sa >> 7;
+	uint32_t da = dst & 0xff;
+	da += da >> 7;
+	uint32_t t = (da * (256 - sa)) >> 8;
+	auto channel = [&](int shift) {
+		uint32_t linear = (tables.toLinear[(src >> shift) & 0xff] * sa + tables.toLinear[(dst >> shift) & 0xff] * t) >> 8;
+		return uint32_t(tables.toSRGB[linear >> 4]) << shift;
+	};
+	return channel(24) | channel(16) | channel(8) | 0xff;
+}
+
+// straight alpha to premultiplied alpha and back, the alpha itself stays the same
+inline uint32_t PremultiplyPixel(uint32_t color) {
+	uint32_t a = color & 0xff;
+	uint32_t r = div255((color >> 24) * a);
+	uint32_t g = div255(((color >> 16) & 0xff) * a);
+	uint32_t b = div255(((color >> 8) & 0xff) * a);
+	return (r << 24) | (g << 16) | (b << 8) | a;
+}
+inline uint32_t UnpremultiplyPixel(uint32_t color) {
+	uint32_t a = color & 0xff;
+	if (a == 0) return 0;
+	auto channel = [&](int shift) {
+		return std::min<uint32_t>(255, (((color >> shift) & 0xff) * 255 + a / 2) / a) << shift;
+	};
+	return channel(24) | channel(16) | channel(8) | a;
+}
+
+// source over for premultiplied pixels, one multiply per channel:
+//   out = src + dst * (1 - srcA)
+// unlike BlendPixel the alpha is composited the same way instead of being set to opaque.
+// Channels larger than the alpha (not a valid premultiplied pixel) saturate at 255 like the SIMD kernels
+inline uint32_t BlendPixelPremultiplied(uint32_t dst, uint32_t src) {
+	uint32_t t = 255 - (src & 0xff);
+	uint32_t out = 0;
+	for (int shift = 0; shift < 32; shift += 8) {
+		out |= std::min<uint32_t>(255, ((src >> shift) & 0xff) + div255(((dst >> shift) & 0xff) * t)) << shift;
+	}
+	return out;
+}
+
+// writes color into count pixels
+inline void FillSpan(uint32_t* dst, int count, uint32_t color) {
+	if (count > 0) std::fill_n(dst, count, color);
+}
+// blends color on top of count pixels
+void BlendSpan(uint32_t* dst, int count, uint32_t color);
+// blends count source pixels on top of count destination pixels
+void BlendSpan(uint32_t* dst, const uint32_t* src, int count);
+// linear light versions of BlendSpan
+void BlendSpanLinear(uint32_t* dst, int count, uint32_t color);
+void BlendSpanLinear(uint32_t* dst, const uint32_t* src, int count);
+// premultiplied versions of BlendSpan
+void BlendSpanPremultiplied(uint32_t* dst, int count, uint32_t color);
+void BlendSpanPremultiplied(uint32_t* dst, const uint32_t* src, int count);
+// converts count pixels, dst and src may be the same
+void PremultiplySpan(uint32_t* dst, const uint32_t* src, int count);
+void UnpremultiplySpan(uint32_t* dst, const uint32_t* src, int count);
+// converts count pixels stored as bytes like in image files (components 1: grey, 2: grey and alpha,
+// 3: R, G, B and 4: R, G, B, A) to packed pixels, missing alphas are opaque
+void PackBytesSpan(uint32_t* dst, const uint8_t* src, int count, int components);
+
+// name of the kernels picked for this cpu ("avx2", "sse2", "neon" or "scalar")
+const char* GetSpanBackendName();
+
+}
+
+#endif
@@ -0,0 +1,50 @@
+/********************************
+ * Project: Cidr				*
+ * File: srgb.cpp				*
+ * Date: 18.10.2026				*
+ ********************************/
+
+#include "srgb.hpp"
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+double decode(double value) {
+	return value <= 0.04045 ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4);
+}
+double encode(double value) {
+	return value <= 0.0031308 ? value * 12.92 : 1.055 * std::pow(value, 1.0 / 2.4) - 0.055;
+}
+
+cdr::SRGBTables createTables() {
+	cdr::SRGBTables tables {};
+	for (int i = 0; i < 4096; i++) {
+		// NOTE: every entry covers 16 linear values, the center of the range is encoded
+		double linear {(i * 16 + 7.5) / 65535.0};
+		tables.toSRGB[i] = static_cast<uint8_t>(std::lround(encode(linear) * 255.0));
+	}
+	for (int i = 0; i < 256; i++) {
+		long linear {std::lround(decode(i / 255.0) * 65535.0)};
+		tables.toLinear[i] = static_cast<uint16_t>(linear);
+		// NOTE: the dark end of the curve is steep, if the exact value lands in a neighbouring
+		// range, move it to the middle of the closest range that encodes back to i
+		if (tables.toSRGB[linear >> 4] != i) {
+			int best {-1};
+			for (int j = 0; j < 4096; j++) {
+				if (tables.toSRGB[j] == i && (best < 0 || std::abs(j - (linear >> 4)) < std::abs(best - (linear >> 4)))) {
+					best = j;
+				}
+			}
+			if (best >= 0) tables.toLinear[i] = static_cast<uint16_t>(best * 16 + 8);
+		}
+	}
+	return tables;
+}
+
+}
+
+const cdr::SRGBTables& cdr::GetSRGBTables() {
+	static const SRGBTables tables {createTables()};
+	return tables;
+}
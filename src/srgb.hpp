@@ -0,0 +1,35 @@
+/********************************
+ * Project: Cidr				*
+ * File: srgb.hpp				*
+ * Date: 18.10.2026				*
+ ********************************/
+
+#ifndef CIDR_SRGB_HPP
+#define CIDR_SRGB_HPP
+
+#include <cstdint>
+
+namespace cdr {
+
+// NOTE: Lookup tables for the exact sRGB transfer function (no gamma 2.2 approximation).
+// Linear light values are 16 bit, 0 is black and 65535 is white.
+// Encoding looks up the top 12 bits of a linear value, every 8 bit sRGB value survives
+// a round trip through both tables unchanged.
+struct SRGBTables {
+	// NOTE: both tables have some padding at the end so SIMD gathers can read 4 bytes at the last entry
+	uint16_t toLinear[256 + 2];
+	uint8_t toSRGB[4096 + 4];
+};
+
+const SRGBTables& GetSRGBTables();
+
+inline uint16_t SRGBToLinear(uint8_t value) {
+	return GetSRGBTables().toLinear[value];
+}
+inline uint8_t LinearToSRGB(uint16_t value) {
+	return GetSRGBTables().toSRGB[value >> 4];
+}
+
+}
+
+#endif
@@ -0,0 +1,92 @@
+/********************************
+ * Project: Cidr				*
+ * File: threadPool.cpp			*
+ * Date: 17.10.2026				*
+ ********************************/
+
+#include "threadPool.hpp"
+#include <algorithm>
+
+cdr::ThreadPool::ThreadPool(int threadCount) {
+	if (threadCount <= 0) {
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+	// NOTE: the calling thread is the last "worker"
+	for (int i = 0; i < threadCount - 1; i++) {
+		workers.emplace_back(&ThreadPool::workerLoop, this);
+	}
+}
+cdr::ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock{mutex};
+		stopping = true;
+	}
+	wakeCondition.notify_all();
+	for (auto& worker : workers) {
+		worker.join();
+	}
+}
+
+void cdr::ThreadPool::ParallelFor(int count, const std::function<void(int)>& job) {
+	if (count <= 0) return;
+
+	std::lock_guard<std::mutex> submitLock{submitMutex};
+	if (workers.empty() || count == 1) {
+		for (int i = 0; i < count; i++) {
+			job(i);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock{mutex};
+		this->job = &job;
+		this->jobCount = count;
+		this->nextIndex = 0;
+		this->busyWorkers = static_cast<int>(workers.size());
+		this->exception = nullptr;
+		this->generation++;
+	}
+	wakeCondition.notify_all();
+
+	runJobs();
+
+	std::unique_lock<std::mutex> lock{mutex};
+	doneCondition.wait(lock, [this]() { return busyWorkers == 0; });
+	this->job = nullptr;
+	if (exception) {
+		std::exception_ptr e = exception;
+		exception = nullptr;
+		std::rethrow_exception(e);
+	}
+}
+
+void cdr::ThreadPool::runJobs() {
+	for (int i = nextIndex++; i < jobCount; i = nextIndex++) {
+		try {
+			(*job)(i);
+		} catch (...) {
+			std::lock_guard<std::mutex> lock{mutex};
+			if (!exception) exception = std::current_exception();
+		}
+	}
+}
+
+void cdr::ThreadPool::workerLoop() {
+	uint64_t seenGeneration = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock{mutex};
+			wakeCondition.wait(lock, [&]() { return stopping || generation != seenGeneration; });
+			if (stopping) return;
+			seenGeneration = generation;
+		}
+
+		runJobs();
+
+		std::lock_guard<std::mutex> lock{mutex};
+		if (--busyWorkers == 0) {
+			doneCondition.notify_one();
+		}
+	}
+}
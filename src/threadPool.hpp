@@ -0,0 +1,64 @@
+/********************************
+ * Project: Cidr				*
+ * File: threadPool.hpp			*
+ * Date: 17.10.2026				*
+ ********************************/
+
+#ifndef CIDR_THREAD_POOL_HPP
+#define CIDR_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cdr {
+
+// NOTE: A small fixed size pool of worker threads. The calling thread always
+// takes part in the work, so a pool with a thread count of 1 has no workers
+// and simply runs everything inline.
+class ThreadPool {
+public:
+	/* CONSTRUCTOR - DESTRUCTOR */
+	// threadCount <= 0 uses std::thread::hardware_concurrency()
+	explicit ThreadPool(int threadCount = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool& other) = delete;
+	ThreadPool& operator=(const ThreadPool& other) = delete;
+
+	// Calls job(i) for every i in [0, count) spread over all threads and blocks until every call returned.
+	// The first exception thrown by a job is rethrown on the calling thread.
+	// NOTE: must not be called from inside a job of the same pool
+	void ParallelFor(int count, const std::function<void(int)>& job);
+
+	/* GETTERS */
+	inline int GetThreadCount() const { return static_cast<int>(workers.size()) + 1; }
+
+private:
+	std::vector<std::thread> workers;
+	// NOTE: serializes ParallelFor calls coming from different threads
+	std::mutex submitMutex;
+	std::mutex mutex;
+	std::condition_variable wakeCondition;
+	std::condition_variable doneCondition;
+	const std::function<void(int)>* job{nullptr};
+	int jobCount{0};
+	std::atomic<int> nextIndex{0};
+	int busyWorkers{0};
+	uint64_t generation{0};
+	bool stopping{false};
+	std::exception_ptr exception;
+
+private:
+	void workerLoop();
+	void runJobs();
+};
+
+}
+
+#endif